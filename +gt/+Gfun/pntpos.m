@@ -1,4 +1,4 @@
-function [gsol, gstat] = pntpos(gobs, gnav, gopt)
+function [gsol, gstat, msg] = pntpos(gobs, gnav, gopt, nthread)
 % pntpos: Call pntpos() in RTKLIB
 % -------------------------------------------------------------
 % Compute receiver position, velocity, clock bias by single-point
@@ -8,15 +8,19 @@ function [gsol, gstat] = pntpos(gobs, gnav, gopt)
 %
 % Usage: ------------------------------------------------------
 %   [gsol, gstat] = gt.Gfun.pntpos(gobs, gnav, gopt)
+%   [gsol, gstat, msg] = gt.Gfun.pntpos(gobs, gnav, gopt, nthread)
 %
 % Input: ------------------------------------------------------
 %   gobs : 1x1, gt.Gobs, GNSS observation object
 %   gnav : 1x1, gt.Gnav, GNSS navigation data object
 %   gopt : 1x1, gt.Gopt, RTKLIB process option object
+%  [nthread]: 1x1, Number of threads for epoch loop (optional)
+%             Default: [] (OpenMP default)
 %
 % Output: ------------------------------------------------------
 %   gsol : 1x1, gt.Gsol, GNSS solution object
 %   gstat: 1x1, gt.Gstat, GNSS solution status object
+%   msg  : Mx1, cell array of no-solution messages of epochs
 %
 % Author: ------------------------------------------------------
 %    Taro Suzuki
@@ -25,7 +29,12 @@ arguments
     gobs gt.Gobs
     gnav gt.Gnav
     gopt gt.Gopt
+    nthread {mustBeScalarOrEmpty, mustBeInteger, mustBePositive} = []
+end
+if nargout > 2
+    [sol, stat, msg] = rtklib.pntpos(gobs.struct, gnav.getNavHandle(), gopt.struct, nthread);
+else
+    [sol, stat] = rtklib.pntpos(gobs.struct, gnav.getNavHandle(), gopt.struct, nthread);
 end
-[sol, stat] = rtklib.pntpos(gobs.struct, gnav.struct, gopt.struct);
 gsol = gt.Gsol(sol);
 gstat = gt.Gstat(stat);
\ No newline at end of file
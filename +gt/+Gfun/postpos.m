@@ -0,0 +1,44 @@
+function [gsol, gstat] = postpos(gobsr, gnav, gopt, gobsb, soltype)
+% postpos: Call postpos() in RTKLIB
+% -------------------------------------------------------------
+% Compute rover position by post-processing positioning with
+% forward, backward or combined (forward+backward) solution.
+%
+% Call rtklib.postpos. Input is the gt objects.
+%
+% Usage: ------------------------------------------------------
+%   [gsol, gstat] = gt.Gfun.postpos(gobsr, gnav, gopt)
+%   [gsol, gstat] = gt.Gfun.postpos(gobsr, gnav, gopt, gobsb, soltype)
+%
+% Input: ------------------------------------------------------
+%   gobsr: 1x1, gt.Gobs, GNSS observation object for rover
+%   gnav : 1x1, gt.Gnav, GNSS navigation data object
+%   gopt : 1x1, gt.Gopt, RTKLIB process option object
+%  [gobsb] : 1x1, gt.Gobs, RTKLIB observation object for base
+%  [soltype]: 1x1, Solution type (default: "combined")
+%             "forward", "backward" or "combined"
+%
+% Output: ------------------------------------------------------
+%   gsol : 1x1, gt.Gsol, GNSS solution object
+%   gstat: 1x1, gt.Gstat, GNSS solution status object
+%
+% Author: ------------------------------------------------------
+%    Taro Suzuki
+%
+arguments
+    gobsr gt.Gobs
+    gnav  gt.Gnav
+    gopt  gt.Gopt
+    gobsb gt.Gobs = gt.Gobs()
+    soltype = "combined"
+end
+if gobsr.n~=gobsb.n
+    gobsb = gobsb.sameTime(gobsr);
+end
+if gobsb.n==0
+    [sol, stat] = rtklib.postpos(gobsr.struct, gnav.getNavHandle(), gopt.struct, [], char(soltype));
+else
+    [sol, stat] = rtklib.postpos(gobsr.struct, gnav.getNavHandle(), gopt.struct, gobsb.struct, char(soltype));
+end
+gsol = gt.Gsol(sol);
+gstat = gt.Gstat(stat);
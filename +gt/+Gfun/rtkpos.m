@@ -1,4 +1,4 @@
-function [grtk, gsol, gstat] = rtkpos(grtk, gobsr, gnav, gopt, gobsb)
+function [grtk, gsol, gstat] = rtkpos(grtk, gobsr, gnav, gopt, gobsb, outmode)
 % rtkpos: Call rtkpos() in RTKLIB
 % -------------------------------------------------------------
 % Compute receiver position, velocity, clock bias by single-point
@@ -15,6 +15,8 @@ function [grtk, gsol, gstat] = rtkpos(grtk, gobsr, gnav, gopt, gobsb)
 %   gnav : 1x1, gt.Gnav, GNSS navigation data object
 %   gopt : 1x1, gt.Gopt, RTKLIB process option object
 %  [gobsb] : 1x1, gt.Gobs, RTKLIB observation object for base
+%  [outmode]: 1x1, Output epochs of gt.Grtk (default: "final")
+%             "final", N (every N-th epoch), "all" or "pv" (pos/vel only)
 %
 % Output: ------------------------------------------------------
 %   grtk : 1x1, gt.Grtk, RTK control object
@@ -30,14 +32,15 @@ arguments
     gnav  gt.Gnav
     gopt  gt.Gopt
     gobsb gt.Gobs = gt.Gobs()
+    outmode = "final"
 end
 if gobsr.n~=gobsb.n
     gobsb = gobsb.sameTime(gobsr);
 end
 if gobsb.n==0
-    [rtk, sol, stat] = rtklib.rtkpos(grtk.struct, gobsr.struct, gnav.struct, gopt.struct);
+    [rtk, sol, stat] = rtklib.rtkpos(grtk.struct, gobsr.struct, gnav.getNavHandle(), gopt.struct, [], outmode);
 else
-    [rtk, sol, stat] = rtklib.rtkpos(grtk.struct, gobsr.struct, gnav.struct, gopt.struct, gobsb.struct);
+    [rtk, sol, stat] = rtklib.rtkpos(grtk.struct, gobsr.struct, gnav.getNavHandle(), gopt.struct, gobsb.struct, outmode);
 end
 grtk = gt.Grtk(rtk);
 gsol = gt.Gsol(sol);
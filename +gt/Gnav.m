@@ -10,10 +10,10 @@ classdef Gnav < handle
     %   navstr    : 1x1, RTKLIB navigation struct
     % ---------------------------------------------------------------------
     % Gnav Properties:
-    %   eph       : Nx1, GPS/QZS/GAL/BDS/IRN ephemeris struct array:
-    %   geph      : NGx1, GLONASS ephemeris struct array
-    %   peph      : NEx1, Precise ephemeris struct array (from .sp3 file)
-    %   pclk      : NCx1, Precise clock struct array (from .clk file)
+    %   eph       : 1x1, GPS/QZS/GAL/BDS/IRN ephemeris columnar struct (Nx1 fields)
+    %   geph      : 1x1, GLONASS ephemeris columnar struct (NGx1 fields)
+    %   peph      : 1x1, Precise ephemeris columnar struct (from .sp3 file)
+    %   pclk      : 1x1, Precise clock columnar struct (from .clk file)
     %   erp       : 1x1, Earth rotation parameter struct (from .erp file)
     %   pcv       : (MAXSAT)x1, Satellite antenna PCV struct array (from .erp file)
     %   dcb       : (MAXSAT)x3, satellite DCB (0:P1-P2, 1:P1-C1, 2:P2-C2) (m)
@@ -33,6 +33,8 @@ classdef Gnav < handle
     %   outNav(file);            Output RINEX navigation file
     %   gnav = copy();           Copy object
     %   navstr = struct();       Convert to navigation struct
+    %   navh = getNavHandle();   Get resident navigation data handle
+    %   freeNavHandle();         Free resident navigation data handle
     %   [tgd, vtgd] = getTGD(sat); Get TGD value for specified satellite
     %   help();                  Show help
     % ---------------------------------------------------------------------
@@ -49,6 +51,9 @@ classdef Gnav < handle
         utc  % UTC time parameters
         ion  % Ionosphere model parameter
     end
+    properties(Access=private, Transient)
+        navh = []; % Resident navigation data handle (not saved to MAT-file)
+    end
     methods
         %% constructor
         function obj = Gnav(varargin)
@@ -64,29 +69,21 @@ classdef Gnav < handle
         function setNavFile(obj, file)
             % setNavFile: Set navigation data from RINEX file
             % -------------------------------------------------------------
+            % Expanded files are read in parallel and merged once.
             %
             % Usage: ------------------------------------------------------
             %   obj.setNavFile(file)
             %
             % Input: ------------------------------------------------------
-            %   file : 1x1, RINEX navigation file
+            %   file : 1x1, RINEX navigation file (wild-card * is expanded)
             %
             arguments
                 obj gt.Gnav
                 file (1,:) char
             end
-            paths = rtklib.expath(obj.absPath(file));
-            for path = paths
-                try
-                    if ~exist('navstr','var')
-                        navstr = rtklib.readrnxnav(obj.absPath(path{:}));
-                    else
-                        navstr = rtklib.readrnxnav(obj.absPath(path{:}), navstr);
-                    end
-                catch
-                end
-            end
-            if ~exist('navstr','var')
+            try
+                navstr = rtklib.readrnxnavs(obj.absPath(file), "column");
+            catch
                 error('Wrong RINEX navigation file: %s',obj.absPath(file));
             end
 
@@ -97,7 +94,8 @@ classdef Gnav < handle
             % setNavStruct: Set navigation data from navigation struct
             % -------------------------------------------------------------
             % The navigation struct is the output of the RTKLIB wrapper
-            % function.
+            % function. Ephemeris struct arrays are stored as columnar
+            % structs.
             %
             % Usage: ------------------------------------------------------
             %   obj.setNavStruct(navstr)
@@ -109,10 +107,10 @@ classdef Gnav < handle
                 obj gt.Gnav
                 navstr (1,1) struct
             end
-            obj.eph = navstr.eph;
-            obj.geph = navstr.geph;
-            obj.peph = navstr.peph;
-            obj.pclk = navstr.pclk;
+            obj.eph = obj.toColumn(navstr.eph, {});
+            obj.geph = obj.toColumn(navstr.geph, {});
+            obj.peph = obj.toColumn(navstr.peph, {'pos','std','vel','vst','cov','vco'});
+            obj.pclk = obj.toColumn(navstr.pclk, {});
             obj.erp = navstr.erp;
             obj.pcv = navstr.pcvs;
             obj.utc.gps = navstr.utc_gps;
@@ -147,7 +145,7 @@ classdef Gnav < handle
                 obj gt.Gnav
                 file (1,:) char
             end
-            navstr = rtklib.readsp3(obj.absPath(file), obj.struct());
+            navstr = rtklib.readsp3(obj.absPath(file), obj.struct(), "column");
             obj.setNavStruct(navstr);
         end
         %% readCLK
@@ -165,7 +163,7 @@ classdef Gnav < handle
                 obj gt.Gnav
                 file (1,:) char
             end
-            navstr = rtklib.readrnxc(obj.absPath(file), obj.struct());
+            navstr = rtklib.readrnxc(obj.absPath(file), obj.struct(), "column");
             obj.setNavStruct(navstr);
         end
         %% readERP
@@ -203,7 +201,7 @@ classdef Gnav < handle
                 file (1,:) char
                 gtime gt.Gtime
             end
-            navstr = rtklib.readsap(obj.absPath(file), gtime.ep(1,:), obj.struct());
+            navstr = rtklib.readsap(obj.absPath(file), gtime.ep(1,:), obj.struct(), "column");
             obj.setNavStruct(navstr);
         end
         %% readDCB
@@ -222,7 +220,7 @@ classdef Gnav < handle
                 obj gt.Gnav
                 file (1,:) char
             end
-            navstr = rtklib.readdcb(obj.absPath(file), obj.struct());
+            navstr = rtklib.readdcb(obj.absPath(file), obj.struct(), "column");
             obj.setNavStruct(navstr);
         end
         %% outNav
@@ -296,6 +294,90 @@ classdef Gnav < handle
             navstr.ion_cmp = obj.ion.cmp;
             navstr.ion_irn = obj.ion.irn;
         end
+        %% getNavHandle
+        function navh = getNavHandle(obj)
+            % getNavHandle: Get resident navigation data handle
+            % -------------------------------------------------------------
+            % Navigation data is loaded to MEX memory at the first call
+            % and the handle is reused until a navigation data property
+            % is changed (including direct assignment). The handle can be
+            % passed to the RTKLIB wrapper functions instead of the
+            % navigation struct.
+            %
+            % Usage: ------------------------------------------------------
+            %   navh = obj.getNavHandle()
+            %
+            % Output: -----------------------------------------------------
+            %   navh : 1x1, Navigation data handle (for interface to RTKLIB)
+            %
+            arguments
+                obj gt.Gnav
+            end
+            if isempty(obj.navh)
+                obj.navh = rtklib.navload(obj.struct());
+            end
+            navh = obj.navh;
+        end
+        %% freeNavHandle
+        function freeNavHandle(obj)
+            % freeNavHandle: Free resident navigation data handle
+            % -------------------------------------------------------------
+            % Resident navigation data is freed automatically when the
+            % navigation data properties are changed.
+            %
+            % Usage: ------------------------------------------------------
+            %   obj.freeNavHandle()
+            %
+            arguments
+                obj gt.Gnav
+            end
+            if ~isempty(obj.navh)
+                rtklib.navfree(obj.navh);
+                obj.navh = [];
+            end
+        end
+        %% set methods (resident navigation data is no longer valid)
+        function set.eph(obj, eph)
+            obj.eph = eph;
+            obj.freeNavHandle();
+        end
+        function set.geph(obj, geph)
+            obj.geph = geph;
+            obj.freeNavHandle();
+        end
+        function set.peph(obj, peph)
+            obj.peph = peph;
+            obj.freeNavHandle();
+        end
+        function set.pclk(obj, pclk)
+            obj.pclk = pclk;
+            obj.freeNavHandle();
+        end
+        function set.erp(obj, erp)
+            obj.erp = erp;
+            obj.freeNavHandle();
+        end
+        function set.pcv(obj, pcv)
+            obj.pcv = pcv;
+            obj.freeNavHandle();
+        end
+        function set.dcb(obj, dcb)
+            obj.dcb = dcb;
+            obj.freeNavHandle();
+        end
+        function set.utc(obj, utc)
+            obj.utc = utc;
+            obj.freeNavHandle();
+        end
+        function set.ion(obj, ion)
+            obj.ion = ion;
+            obj.freeNavHandle();
+        end
+        %% delete
+        function delete(obj)
+            % delete: Destructor, free resident navigation data
+            obj.freeNavHandle();
+        end
         %% getTGD
         function [tgd, vtgd] = getTGD(obj, sat)
             % getTGD: Get TGD value for specified satellite
@@ -317,14 +399,13 @@ classdef Gnav < handle
             end
             nsat = length(sat);
             sys = rtklib.satsys(sat);
-            t = struct2table(obj.eph);
 
             % ToDo: support code type input
             tgd = zeros(1, nsat);
             for i=1:nsat
                 if sys(i)==gt.C.SYS_GPS||sys(i)==gt.C.SYS_QZS||sys(i)==gt.C.SYS_GAL||sys(i)==gt.C.SYS_CMP
-                    idx = find(t.sat==sat(i), 1);
-                    if ~isempty(idx); tgd(i) = gt.C.CLIGHT*t.tgd(idx,1); end
+                    idx = find(obj.eph.sat==sat(i), 1);
+                    if ~isempty(idx); tgd(i) = gt.C.CLIGHT*obj.eph.tgd(idx,1); end
                 end
             end
             ERR_CBIAS = 0.3; % code bias error std (m)
@@ -351,8 +432,28 @@ classdef Gnav < handle
                 error('Directory does not exist: %s',dirname);
             end
         end
+        %% Convert ephemeris struct array to columnar struct
+        function col = toColumn(~, ephs, fields3)
+            % fields3: fields of ?x? matrix per record (?x?xN field)
+            %          other fields are 1x? per record (Nx? field)
+            if isscalar(ephs)
+                col = ephs; % columnar struct (or single record)
+                return;
+            end
+            col = struct();
+            for f = fieldnames(ephs)'
+                if ismember(f{:}, fields3)
+                    col.(f{:}) = cat(3, ephs.(f{:}));
+                else
+                    col.(f{:}) = cat(1, ephs.(f{:}));
+                end
+            end
+        end
         %% Eliminate duplicated ephemeris
         function eliminateDuplicate(obj)
+            if isempty(obj.eph.sat)
+                return;
+            end
             % GPS
             teph = struct2table(obj.eph);
             uniquesat = unique(teph.sat);
@@ -370,7 +471,9 @@ classdef Gnav < handle
                 end
                 % ToDo: check other systems
             end
-            obj.eph(idxeliminate) = [];
+            idxkeep = true(size(obj.eph.sat));
+            idxkeep(idxeliminate) = false;
+            obj.eph = structfun(@(x) x(idxkeep,:), obj.eph, "UniformOutput", false);
         end
     end
 end
\ No newline at end of file
@@ -4,8 +4,14 @@ classdef Gobs < handle
     % Gobs Declaration:
     % gobs = Gobs();  Create empty gt.Gobs object
     %
-    % gobs = Gobs(file);  Create gt.Gobs object from RINEX file
+    % gobs = Gobs(file, [freq], [obstype], [ts], [te], [tint]);
+    %                       Create gt.Gobs object from RINEX file
     %   file      : 1x1, RINEX observation file
+    %  [freq]     : 1xN, Frequencies to read {"L1","L2",...} (optional)
+    %  [obstype]  : 1x1, Observables to read, e.g. "PL" (optional)
+    %  [ts]       : 1x1, gt.Gtime, Start time to read (optional)
+    %  [te]       : 1x1, gt.Gtime, End time to read (optional)
+    %  [tint]     : 1x1, Time interval to read (s) (optional)
     %
     % gobs = Gobs(obsstr);  Create gt.Gobs object from observation struct
     %   obsstr    : 1x1, RTKLIB observation struct
@@ -42,7 +48,7 @@ classdef Gobs < handle
     %  (Lif)      : 1x1, Ionosphere-free linear combination struct
     % ---------------------------------------------------------------------
     % Gobs Methods:
-    %   setObsFile(file);              Set observation from RINEX file
+    %   setObsFile(file, [freq], [obstype]); Set observation from RINEX file
     %   setObsStruct(obsstr);          Set observation from observation struct
     %   setFrequency();                Set carrier frequency and wavelength
     %   setFrequencyFromNav(nav);      Set carrier frequency and wavelength from navigation
@@ -117,6 +123,8 @@ classdef Gobs < handle
                 obj.nsat = 0;
             elseif nargin==1 && (ischar(varargin{1}) || isStringScalar(varargin{1}))
                 obj.setObsFile(char(varargin{1})); % file
+            elseif nargin<=8 && (ischar(varargin{1}) || isStringScalar(varargin{1}))
+                obj.setObsFile(char(varargin{1}), varargin{2:end}); % file, freq, obstype, ...
             elseif nargin==1 && isstruct(varargin{1})
                 obj.setObsStruct(varargin{1}); % obs struct
             else
@@ -124,22 +132,54 @@ classdef Gobs < handle
             end
         end
         %% setObsFile
-        function setObsFile(obj, file)
+        function setObsFile(obj, file, freq, obstype, ts, te, tint, navsys, exsats)
             % setObsFile: Set observation from RINEX file
             % -------------------------------------------------------------
+            % Only the selected frequencies and observables are read, if
+            % freq and obstype are specified. The time span, systems and
+            % satellites are selected in the reader instead of
+            % selectTimeSpan/selectSat after reading the whole file.
             %
             % Usage: ------------------------------------------------------
-            %   obj.setObsFile(file)
+            %   obj.setObsFile(file, [freq], [obstype], [ts], [te], [tint], [navsys], [exsats])
             %
             % Input: ------------------------------------------------------
-            %   file : 1x1, RINEX observation file
+            %   file    : 1x1, RINEX observation file
+            %  [freq]   : 1xN, Frequencies to read (optional)
+            %             e.g. ["L1","L5"] Default: all frequencies
+            %  [obstype]: 1x1, Observables to read (optional)
+            %             e.g. "PL" Default: all observables ("PLDSI")
+            %  [ts]     : 1x1, gt.Gtime, Start time (optional)
+            %             Default: no limit
+            %  [te]     : 1x1, gt.Gtime, End time (optional)
+            %             Default: no limit
+            %  [tint]   : 1x1, Time interval (s) (optional)
+            %             Default: 0 (all epochs)
+            %  [navsys] : 1xN, gt.C.SYS, Navigation systems (optional)
+            %             Default: all systems
+            %  [exsats] : 1xM, Excluded satellite numbers (optional)
+            %             Default: no excluded satellite
             %
             arguments
                 obj gt.Gobs
                 file (1,:) char
-            end
+                freq string = string.empty
+                obstype (1,:) char = ''
+                ts gt.Gtime = gt.Gtime.empty
+                te gt.Gtime = gt.Gtime.empty
+                tint (1,1) double = 0
+                navsys gt.C.SYS = gt.C.SYS.empty
+                exsats {mustBeInteger} = []
+            end
+            tsep = [];
+            teep = [];
+            sysmask = [];
+            if ~isempty(ts); tsep = ts.ep(1,:); end
+            if ~isempty(te); teep = te.ep(1,:); end
+            if ~isempty(navsys); sysmask = sum(unique(double(navsys))); end
             try
-                [obs, basepos, fcn] = rtklib.readrnxobs(obj.absPath(file));
+                [obs, basepos, fcn] = rtklib.readrnxobs(obj.absPath(file), cellstr(freq), obstype, ...
+                    tsep, teep, tint, sysmask, double(exsats));
             catch
                 error('Wrong RINEX observation file: %s',file);
             end
@@ -240,7 +280,7 @@ classdef Gobs < handle
             end
             if ~isstruct(nav)
                 if isa(nav, 'gt.Gnav')
-                    nav = nav.struct();
+                    nav = nav.getNavHandle();
                 else
                     error('Input must be nav struct of gt.Gnav');
                 end
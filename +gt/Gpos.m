@@ -46,8 +46,8 @@ classdef Gpos < handle
     %   llhdms = llhDMS([idx]);         Convert latitude and longitude to degree,minute,second format
     %   latdms = latDMS([idx]);         Convert latitude to degree,minute,second format
     %   londms = lonDMS([idx]);         Convert longitude to degree,minute,second format
-    %   gh = geoid([idx]);              Compute geoid height
-    %   oh = orthometric([idx]);        Compute orthometric height
+    %   gh = geoid([idx], [model, file]); Compute geoid height
+    %   oh = orthometric([idx], [model, file]); Compute orthometric height
     %   lat = lat([idx]);               Get latitude
     %   lon = lon([idx]);               Get longitude
     %   h = h([idx]);                   Get ellipsoidal height
@@ -784,18 +784,22 @@ classdef Gpos < handle
             londms = rtklib.deg2dms(obj.lon(idx));
         end
         %% geoid
-        function gh = geoid(obj, idx)
+        function gh = geoid(obj, idx, model, file)
             % geoid: Compute geoid height
             % -------------------------------------------------------------
             % RTKLIB internal Geoid model (EGM96 1°x1°) is used to compute
-            % geoid height.
+            % geoid height. External geoid model file can be specified,
+            % which is memory-mapped once and reused in later calls.
             %
             % Usage: ------------------------------------------------------
-            %   gh = obj.geoid([idx])
+            %   gh = obj.geoid([idx], [model, file])
             %
             % Input: ------------------------------------------------------
             %  [idx]: Logical or numeric index to select (optional)
             %         Default: idx = 1:obj.n
+            %  [model]: 1x1, Geoid model type (see rtklib.geoidh) (optional)
+            %         Default: model = 0 (RTKLIB internal model)
+            %  [file]: Geoid model file path (optional)
             %
             % Output: -----------------------------------------------------
             %   gh : Mx1, Geoid height (m)
@@ -803,6 +807,8 @@ classdef Gpos < handle
             arguments
                 obj gt.Gpos
                 idx {mustBeInteger, mustBeVector} = 1:obj.n
+                model (1,1) {mustBeInteger} = 0
+                file (1,:) char = ''
             end
             if isempty(obj.llh)
                 error('llh must be set to a value');
@@ -810,22 +816,29 @@ classdef Gpos < handle
             gpos = obj.select(idx);
             gh = NaN(gpos.n, 1);
             idx = ~any(isnan(gpos.llh(:,1:2)),2);
-            gh_ = rtklib.geoidh(gpos.llh(idx,1), gpos.llh(idx,2));
+            if model == 0
+                gh_ = rtklib.geoidh(gpos.llh(idx,1), gpos.llh(idx,2));
+            else
+                gh_ = rtklib.geoidh(gpos.llh(idx,1), gpos.llh(idx,2), model, file);
+            end
             gh(idx) = gh_;
         end
         %% orthometric
-        function oh = orthometric(obj, idx)
+        function oh = orthometric(obj, idx, model, file)
             % orthometric: Compute orthometric height
             % -------------------------------------------------------------
             % RTKLIB internal Geoid model (EGM96 1°x1°) is used to compute
-            % geoid height.
+            % geoid height. External geoid model file can be specified.
             %
             % Usage: ------------------------------------------------------
-            %   oh = obj.orthometric([idx])
+            %   oh = obj.orthometric([idx], [model, file])
             %
             % Input: ------------------------------------------------------
             %  [idx]: Logical or numeric index to select (optional)
             %         Default: idx = 1:obj.n
+            %  [model]: 1x1, Geoid model type (see rtklib.geoidh) (optional)
+            %         Default: model = 0 (RTKLIB internal model)
+            %  [file]: Geoid model file path (optional)
             %
             % Output: -----------------------------------------------------
             %   oh : Mx1, Orthometric height (m)
@@ -833,11 +846,13 @@ classdef Gpos < handle
             arguments
                 obj gt.Gpos
                 idx {mustBeInteger, mustBeVector} = 1:obj.n
+                model (1,1) {mustBeInteger} = 0
+                file (1,:) char = ''
             end
             if isempty(obj.llh)
                 error('llh must be set to a value');
             end
-            oh = obj.llh(idx,3) - obj.geoid(idx);
+            oh = obj.llh(idx,3) - obj.geoid(idx, model, file);
         end
         %% lat
         function lat = lat(obj, idx)
@@ -5,11 +5,12 @@ classdef Grtk < handle
     % grtk = Grtk(file);  Create gt.Grtk object from config file
     %   file   : 1x1, RTKLIB configuration file (???.conf)
     %
-    % grtk = Grtk(gopt);  Create gt.Grtk object from gt.Gopt object
+    % grtk = Grtk(gopt, [format]);  Create gt.Grtk object from gt.Gopt object
     %   gopt   : 1x1, gt.Gopt object
+    %  [format]: 1x1, Format of RTK control struct, "full" or "compact"
     %
     % grtk = Grtk(rtkstr);  Create gt.Grtk object from RTK control struct
-    %   rtkstr : 1x1, RTK control struct
+    %   rtkstr : 1x1, RTK control struct (full or compact)
     % ---------------------------------------------------------------------
     % Grtk Properties:
     %   n      : 1x1, Number of epochs
@@ -24,12 +25,22 @@ classdef Grtk < handle
     %   tt     : (obj.n)x1, Time difference between current and previous (s)
     %   rb     : (obj.n)x6, Base position/velocity (ECEF) (m|m/s)
     %   errmsg : (obj.n)x1, Error message
+    %   compact: 1x1, Convert to compact RTK control struct (active states only)
+    %
+    %   States of compact RTK control struct are kept as active states and
+    %   packed covariance, x/P/xa/Pa are expanded to full states when they
+    %   are referred
+    %
+    %   nx/na are of last epoch. Epochs except last one of "pv" output mode
+    %   of rtkpos have position/velocity states only (others are zero in x
+    %   and P is position/velocity block)
     % ---------------------------------------------------------------------
     % Grtk Methods:
     %   setRtkFile(file);     Set RTK data from config file
     %   setRtkStruct(rtkstr); Set RTK data from RTK control struct
     %   grtk = copy();        Copy object
     %   rtkstr = struct();    Convert from gt.Grtk object to struct
+    %   setCompact(compact);  Set format of RTK control struct
     %   help();               Show help
     % ---------------------------------------------------------------------
     % Author: Taro Suzuki
@@ -39,14 +50,20 @@ classdef Grtk < handle
         time   % Time, gt.Gtime object
         nx     % Number of float states
         na     % Number of fixed states
-        x      % Float states
-        P      % Float covariance
-        xa     % Fixed states
-        Pa     % Fixed covariance
         nfix   % Number of continuous fixes of ambiguity
         tt     % Time difference between current and previous (s)
         rb     % Base position/velocity (ECEF) (m|m/s)
         errmsg % Error message
+        compact = false % Convert to compact RTK control struct
+    end
+    properties (Dependent)
+        x      % Float states
+        P      % Float covariance
+        xa     % Fixed states
+        Pa     % Fixed covariance
+    end
+    properties (Access=private)
+        st     % States of epochs (compact: ix/x/P/ia/xa/Pa, full: x/P/xa/Pa)
     end
     methods
         %% constructor
@@ -57,6 +74,8 @@ classdef Grtk < handle
                 obj.setRtkStruct(varargin{1}); % opt struct
             elseif nargin==1 && isa(varargin{1},"gt.Gopt") % 
                 obj.setRtkObject(varargin{1}); % gt.Gopt
+            elseif nargin==2 && isa(varargin{1},"gt.Gopt")
+                obj.setRtkObject(varargin{1}, varargin{2}); % gt.Gopt, format
             else
                 error('Wrong input arguments');
             end
@@ -89,25 +108,24 @@ classdef Grtk < handle
             %   obj.setRtkStruct(rtkstr)
             %
             % Input: ------------------------------------------------------
-            %   rtkstr: 1x1, RTK control struct
+            %   rtkstr: 1x1, RTK control struct (full or compact)
             %
             arguments
                 obj gt.Grtk
                 rtkstr (:,1) struct
             end
-            trtk = struct2table(rtkstr, 'AsArray', true);
+            obj.compact = isfield(rtkstr, 'ix');
             obj.n = size(rtkstr,1);
-            obj.time = gt.Gtime(trtk.ep);
-            obj.nx = trtk.nx(1);
-            obj.na = trtk.na(1);
-            obj.x = trtk.x;
-            obj.P = trtk.P;
-            obj.xa = trtk.xa;
-            obj.Pa = trtk.Pa;
-            obj.nfix = trtk.nfix;
-            obj.tt = trtk.tt;
-            obj.rb = trtk.rb;
-            obj.errmsg = trtk.errmsg;
+            obj.time = gt.Gtime(vertcat(rtkstr.ep));
+            obj.nx = rtkstr(end).nx;
+            obj.na = rtkstr(end).na;
+            obj.nfix = vertcat(rtkstr.nfix);
+            obj.tt = vertcat(rtkstr.tt);
+            obj.rb = vertcat(rtkstr.rb);
+            obj.errmsg = {rtkstr.errmsg}';
+
+            % states are kept as input (compact states are not expanded)
+            obj.st = rmfield(rtkstr, {'ep','rb','nx','na','tt','nfix','errmsg'});
         end
         %% setRtkObject
         function setRtkObject(obj, gopt)
@@ -115,16 +133,19 @@ classdef Grtk < handle
             % -------------------------------------------------------------
             %
             % Usage: ------------------------------------------------------
-            %   obj.setRtkObject(gopt)
+            %   obj.setRtkObject(gopt, [format])
             %
             % Input: ------------------------------------------------------
             %   gopt: 1x1, gt.Gobj object
+            %  [format]: 1x1, Format of RTK control struct (default: "full")
+            %            "full" or "compact"
             %
             arguments
                 obj gt.Grtk
                 gopt gt.Gopt
+                format {mustBeMember(format,["full","compact"])} = "full"
             end
-            rtkstr = rtklib.rtkinit(gopt.struct);
+            rtkstr = rtklib.rtkinit(gopt.struct, char(format));
             obj.setRtkStruct(rtkstr);
         end
         %% copy
@@ -145,6 +166,26 @@ classdef Grtk < handle
             end
             grtk = gt.Grtk(obj.struct());
         end
+        %% setCompact
+        function setCompact(obj, compact)
+            % setCompact: Set format of RTK control struct
+            % -------------------------------------------------------------
+            % Compact RTK control struct has active states (non-zero state
+            % or covariance) only, and rtklib.rtkpos outputs compact struct
+            % if input struct is compact.
+            %
+            % Usage: ------------------------------------------------------
+            %   obj.setCompact(compact)
+            %
+            % Input: ------------------------------------------------------
+            %   compact: 1x1, Convert to compact RTK control struct
+            %
+            arguments
+                obj gt.Grtk
+                compact (1,1) logical
+            end
+            obj.compact = compact;
+        end
         %% struct
         function rtkstr = struct(obj)
             % setRtkStruct: Convert from gt.Grtk object to struct
@@ -159,17 +200,53 @@ classdef Grtk < handle
             arguments
                 obj gt.Grtk
             end
-            rtkstr.ep = obj.time.ep(obj.n,:);
-            rtkstr.rb = obj.rb(obj.n,:);
-            rtkstr.nx = obj.nx;
-            rtkstr.na = obj.na;
-            rtkstr.tt = obj.tt(obj.n);
-            rtkstr.x = obj.x(obj.n,:);
-            rtkstr.P = obj.P{obj.n};
-            rtkstr.xa = obj.xa(obj.n,:);
-            rtkstr.Pa = obj.Pa{obj.n};
-            rtkstr.nfix = obj.nfix(obj.n);
-            rtkstr.errmsg = obj.errmsg{obj.n};
+            % states of last epoch are converted only if format differs
+            s = obj.st(obj.n);
+            if obj.compact && ~isfield(s, 'ix')
+                [s.ix, s.x, s.P] = obj.compactState(s.x, s.P);
+                [s.ia, s.xa, s.Pa] = obj.compactState(s.xa, s.Pa);
+            elseif ~obj.compact && isfield(s, 'ix')
+                [s.x, s.P] = obj.fullState(obj.nx, s.ix, s.x, s.P);
+                [s.xa, s.Pa] = obj.fullState(obj.na, s.ia, s.xa, s.Pa);
+            end
+            if obj.compact
+                rtkstr = struct('ep', obj.time.ep(obj.n,:), ...
+                    'rb', obj.rb(obj.n,:), 'nx', obj.nx, 'na', obj.na, ...
+                    'tt', obj.tt(obj.n), 'ix', s.ix, 'x', s.x, 'P', s.P, ...
+                    'ia', s.ia, 'xa', s.xa, 'Pa', s.Pa, ...
+                    'nfix', obj.nfix(obj.n), 'errmsg', obj.errmsg{obj.n});
+            else
+                rtkstr = struct('ep', obj.time.ep(obj.n,:), ...
+                    'rb', obj.rb(obj.n,:), 'nx', obj.nx, 'na', obj.na, ...
+                    'tt', obj.tt(obj.n), 'x', s.x, 'P', s.P, ...
+                    'xa', s.xa, 'Pa', s.Pa, ...
+                    'nfix', obj.nfix(obj.n), 'errmsg', obj.errmsg{obj.n});
+            end
+        end
+        %% get/set full states (expanded from compact states)
+        function x = get.x(obj)
+            x = obj.getStates('ix', 'x', obj.nx);
+        end
+        function P = get.P(obj)
+            P = obj.getCovariances('ix', 'P', obj.nx);
+        end
+        function xa = get.xa(obj)
+            xa = obj.getStates('ia', 'xa', obj.na);
+        end
+        function Pa = get.Pa(obj)
+            Pa = obj.getCovariances('ia', 'Pa', obj.na);
+        end
+        function set.x(obj, x)
+            obj.setStates('x', num2cell(x, 2));
+        end
+        function set.P(obj, P)
+            obj.setStates('P', P);
+        end
+        function set.xa(obj, xa)
+            obj.setStates('xa', num2cell(xa, 2));
+        end
+        function set.Pa(obj, Pa)
+            obj.setStates('Pa', Pa);
         end
         %% help
         function help(~)
@@ -179,6 +256,64 @@ classdef Grtk < handle
     end
     %% Private functions
     methods(Access=private)
+        %% Full states of epochs (nx: number of states)
+        function x = getStates(obj, fi, fx, nx)
+            x = zeros(obj.n, nx);
+            for i = 1:obj.n
+                if isfield(obj.st, fi)
+                    x(i,obj.st(i).(fi)) = obj.st(i).(fx);
+                else
+                    % leading states only for epochs of "pv" output mode
+                    x(i,1:numel(obj.st(i).(fx))) = obj.st(i).(fx);
+                end
+            end
+        end
+        %% Full covariances of epochs (nx: number of states)
+        function P = getCovariances(obj, fi, fP, nx)
+            P = cell(obj.n, 1);
+            for i = 1:obj.n
+                if isfield(obj.st, fi)
+                    P{i} = obj.fullCov(nx, obj.st(i).(fi), obj.st(i).(fP));
+                else
+                    P{i} = obj.st(i).(fP);
+                end
+            end
+        end
+        %% Set full states of epochs (compact states are expanded)
+        function setStates(obj, f, v)
+            if isfield(obj.st, 'ix')
+                for i = 1:obj.n
+                    s = obj.st(i);
+                    [x, P] = obj.fullState(obj.nx, s.ix, s.x, s.P);
+                    [xa, Pa] = obj.fullState(obj.na, s.ia, s.xa, s.Pa);
+                    st(i,1) = struct('x', x, 'P', P, 'xa', xa, 'Pa', Pa); %#ok<AGROW>
+                end
+                obj.st = st;
+            end
+            [obj.st.(f)] = v{:};
+        end
+        %% Expand active states and packed covariance
+        function [x, P] = fullState(obj, n, ix, xc, Pc)
+            x = zeros(1,n);
+            x(ix) = xc;
+            P = obj.fullCov(n, ix, Pc);
+        end
+        %% Expand packed covariance of active states
+        function P = fullCov(~, n, ix, Pc)
+            m = length(ix);
+            Pm = zeros(m);
+            Pm(tril(true(m))) = Pc;
+            Pm = Pm+tril(Pm,-1)';
+            P = zeros(n);
+            P(ix,ix) = Pm;
+        end
+        %% Active states and packed covariance
+        function [ix, xc, Pc] = compactState(~, x, P)
+            ix = find(x~=0 | any(P~=0,2)');
+            xc = x(ix);
+            Pm = P(ix,ix);
+            Pc = Pm(tril(true(length(ix))))';
+        end
         %% Convert from relative path to absolute path
         function apath = absPath(~, rpath)
             if isstring(rpath)
@@ -169,7 +169,7 @@ classdef Gsat < handle
                 end
             end
             [obj.x,obj.y,obj.z,obj.vx,obj.vy,obj.vz,obj.dts,obj.ddts,obj.var,obj.svh] ...
-                = rtklib.satposs(obsstr, gnav.struct, ephopt);
+                = rtklib.satposs(obsstr, gnav.getNavHandle(), ephopt);
             
             % mask unhealthy satellite
             idx = obj.svh~=0;
@@ -224,7 +224,7 @@ classdef Gsat < handle
                 ephopt = double(ephopt);
             end
             [obj.x,obj.y,obj.z,obj.vx,obj.vy,obj.vz,obj.dts,obj.ddts,obj.var,obj.svh] ...
-                = rtklib.satpos(gtime.ep, sat, gnav.struct, ephopt);
+                = rtklib.satpos(gtime.ep, sat, gnav.getNavHandle(), ephopt);
             obj.n = gtime.n;
             obj.nsat = length(sat);
             obj.sat = sat;
@@ -256,20 +256,22 @@ classdef Gsat < handle
             end
             obj.pos = gpos;
 
-            % ex,ey,ez,rng,az,el
-            [obj.rng, obj.ex, obj.ey, obj.ez] ...
-                = rtklib.geodist(obj.x, obj.y, obj.z, gpos.xyz);
-            [obj.az, obj.el] = rtklib.satazel(gpos.llh, obj.ex, obj.ey, obj.ez);
-
-            % trop,iono
-            obj.trp = rtklib.tropmodel(obj.obs.time.ep,gpos.llh,obj.az,obj.el);
+            % frequencies of observations
             if ~isfield(obj.obs.L1,"freq")
                 obj.obs.setFrequencyFromNav(obj.nav);
             end
-            for f = obj.FTYPE
-                if ~isempty(obj.obs.(f))
-                    obj.("ion"+f) = rtklib.ionmodel(obj.obs.time.ep,obj.nav.ion.gps,gpos.llh,obj.az,obj.el,obj.obs.(f).freq);
-                end
+            ftype = obj.FTYPE(arrayfun(@(f) ~isempty(obj.obs.(f)), obj.FTYPE));
+            freq = zeros(length(ftype), obj.nsat);
+            for i = 1:length(ftype)
+                freq(i,:) = obj.obs.(ftype(i)).freq;
+            end
+
+            % rng,ex,ey,ez,az,el,trop,iono (computed at once)
+            [obj.rng, obj.ex, obj.ey, obj.ez, obj.az, obj.el, obj.trp, ion] ...
+                = rtklib.rcvgeom(obj.obs.time.ep, obj.x, obj.y, obj.z, ...
+                gpos.xyz, obj.nav.ion.gps, freq);
+            for i = 1:length(ftype)
+                obj.("ion"+ftype(i)) = ion(:,:,i);
             end
         end
         %% setRcvVel
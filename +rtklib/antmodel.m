@@ -1,5 +1,5 @@
 % ANTMODEL Compute receiver antenna offset by antenna phase center parameters
-%  dant = ANTMODEL(pcv, del, az, el, opt, freqidx)
+%  dant = ANTMODEL(pcv, del, az, el, opt, freqidx, nthread)
 %
 % Inputs: 
 %    pcv     : 1x1, PCV struct
@@ -10,6 +10,7 @@
 %    el      : MxN, satellite elevation (deg)
 %    opt     : 1x1, option (0:only offset, 1:offset+pcv)
 %    freqidx : 1x1, frequency index
+%   [nthread]: 1x1, number of threads for epoch loop (optional)
 %
 % Outputs:
 %    dant    : MxN, range offsets for specified frequency (m)
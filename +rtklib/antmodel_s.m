@@ -1,14 +1,16 @@
 % ANTMODEL_S Compute satellite antenna offset by antenna phase center parameters
-%  dant = ANTMODEL_S(pcvs, sat, nadir, freqidx)
+%  dant = ANTMODEL_S(pcvs, sat, nadir, freqidx, nthread)
 %
 % Inputs: 
 %    pcvs    : MAXSATx1, array of PCV struct
 %    sat     : 1xN, satellite number defined in RTKLIB
 %    nadir   : MxN, nadir angle for satellite (deg)
 %    freqidx : 1x1, frequency index
+%   [nthread]: 1x1, number of threads for epoch loop (optional)
 %
 % Outputs:
 %    dant    : MxN, range offsets for specified frequency (m)
+%              (NaN: invalid satellite number)
 %
 % Notes:
 %            freq idx   0     1     2     3     4 
@@ -0,0 +1,39 @@
+% CORE Call RTKLIB wrappers in one resident mex file
+%  varargout = CORE(command, varargin)
+%
+% Inputs: 
+%    command : 1x1, command name
+%              wrapper commands (same arguments/outputs as rtklib.<command>):
+%                "navload", "navfree", "readrnxnav", "readrnxnavs",
+%                "readrnxobs", "satpos", "satposs", "peph2pos", "pntpos",
+%                "rtkpos", "pppos", "postpos", "geoidh", "tokyo2jgd",
+%                "jgd2tokyo", "searchpcv", "perfstats", "satcache"
+%              resident state commands:
+%                "readpcv"    : pcv = CORE("readpcv", file), PCV file is parsed once
+%                "geoid"      : CORE("geoid", model, file), open geoid model
+%                               used by CORE("geoidh", lat, lon) until closed
+%                "geoidclose" : CORE("geoidclose"), close geoid model
+%                "nthread"    : CORE("nthread", n), default number of threads
+%                               of satpos, satposs, peph2pos and pntpos
+%                "status"     : stat = CORE("status"), resident state
+%                "free"       : CORE("free"), free all resident state
+%                "unlock"     : CORE("unlock"), allow "clear" to unload core
+%    varargin: arguments of command
+%
+% Outputs:
+%    varargout: outputs of command
+%
+% Notes:
+%    core is locked in memory (mexLock) on the first call, so navigation
+%    data handles, geoid/datum models and PCV tables are kept between calls
+%    navigation data handles created by core are freed by "free" or when
+%    core is unloaded after "unlock" and "clear", the freed handles are
+%    invalidated and raise an error when they are used
+%    number of navigation data handles is limited only by the registry
+%    shared by all mex files (4096 resident objects)
+%    "nthread" sets the OpenMP default, whose thread team is reused by all
+%    parallel loops of core, status returns the number of threads set
+%    datum parameters of tokyo2jgd/jgd2tokyo are loaded once
+%     
+% Author: 
+%    Taro Suzuki
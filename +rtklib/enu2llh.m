@@ -9,5 +9,10 @@
 %    llh    : Mx3, geodetic position (deg, deg, m)
 %    E      : 3x3, ENU to ECEF transformation matrix
 %
+% Notes:
+%    geodetic position is computed by Bowring's method with fixed
+%    iterations (difference from ecef2pos of RTKLIB < 0.1 mm)
+%    NaN is returned for NaN input
+%
 % Author: 
 %    Taro Suzuki
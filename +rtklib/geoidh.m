@@ -1,6 +1,6 @@
 % GEOIDH Get geoid height from geoid model
 %  geoh = GEOIDH(lat, lon)
-%  geoh = GEOIDH(lat, lon, model, file)
+%  geoh = GEOIDH(lat, lon, model, file, [nthread])
 %
 % Inputs: 
 %    lat   : Mx1, Latitude(degree)
@@ -9,6 +9,7 @@
 %              0: EMBEDDED (default) 1: EGM96_M150, 
 %              2: EGM2008_M25, 3: EGM2008_M10, 4: GSI2000_M15
 %   [file] : 1x1, geoid model file path
+%   [nthread]: 1x1, number of threads (optional)
 %
 % Outputs:
 %    geoh  : Mx1, geoid height (m) (0.0:error)
@@ -20,6 +21,8 @@
 %    EGM2008_M25: Und_min2.5x2.5_egm2008_isw=82_WGS84_TideFree_SE: EGM2008 2.5x2.5"
 %    EGM2008_M10: Und_min1x1_egm2008_isw=82_WGS84_TideFree_SE    : EGM2008 1.0x1.0"
 %    GSI2000_M15: gsigeome_ver4 : GSI geoid 2000 1.0x1.5" (japanese area)
+%    geoid model file is memory-mapped at the first call and kept until
+%    "clear mex", so that later calls with the same file do not read it again
 %
 % Author: 
 %    Taro Suzuki
@@ -0,0 +1,12 @@
+% NAVFREE Free navigation data loaded by NAVLOAD
+%  NAVFREE(navh)
+%
+% Inputs: 
+%    navh  : 1x1, navigation data handle (uint64)
+%
+% Notes:
+%    navigation data handle must not be used after NAVFREE, freed or invalid
+%    handle raises an error
+%     
+% Author: 
+%    Taro Suzuki
@@ -0,0 +1,21 @@
+% NAVLOAD Load navigation data to resident memory
+%  navh = NAVLOAD(nav)
+%
+% Inputs: 
+%    nav   : 1x1, navigation data struct
+%
+% Outputs:
+%    navh  : 1x1, navigation data handle (uint64)
+%
+% Notes:
+%    navigation data handle can be used instead of navigation data struct
+%    in satpos, satposs, peph2pos, pntpos, rtkpos, ionocorr, tropcorr,
+%    sat2freq and satantoff to skip the struct conversion on each call
+%    ephemeris index for satpos, satposs, pntpos and rtkpos is built once
+%    when navigation data is loaded
+%    navigation data handle must be released by NAVFREE
+%    handle is an id of resident data shared by all mex files (not an
+%    address), it is valid until NAVFREE or MATLAB exits
+%     
+% Author: 
+%    Taro Suzuki
@@ -1,13 +1,16 @@
 % PEPH2POS Compute satellite position/clock with precise ephemeris/clock
 %  [x, y, z, vx, vy, vz, dts, ddts, var] = PEPH2POS(epoch, sat, nav, opt)
+%  [x, y, z, vx, vy, vz, dts, ddts, var] = PEPH2POS(epoch, sat, nav, opt, nthread)
 %
 % Inputs: 
 %    epoch : Mx6, calendar day/time in GPST
 %                {year, month, day, hour, minute, second}
 %    sat   : 1xN, satellite number defined in RTKLIB
-%    nav   : 1x1, navigation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
 %    opt   : 1x1, sat position option
 %                (0: center of mass, 1: antenna phase center)
+%   [nthread]: 1x1, number of threads for satellite loop (optional)
+%               Default: [] (OpenMP default, OMP_NUM_THREADS)
 %
 % Outputs:
 %    x     : MxN, satellite position X in ECEF coordinate (m)
@@ -23,6 +26,14 @@
 % Notes:
 %    clock includes relativistic correction but does not contain code bias
 %    if precise clocks are not set, clocks in sp3 are used instead
+%    epochs are sorted and interpolated in a batch per satellite, and
+%    satellites are computed in parallel by OpenMP, results (including
+%    velocity by finite difference) are identical to RTKLIB peph2pos,
+%    messages are output after the loop
+%    opt=1 is computed by single thread since satellite antenna offset of
+%    RTKLIB (sunmoonpos) is not thread-safe
+%    if satellite state cache is enabled (see SATCACHE) and nav is
+%    navigation data handle, cached states are not recomputed
 % 
 % Author: 
 %    Taro Suzuki
\ No newline at end of file
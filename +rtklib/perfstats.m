@@ -0,0 +1,28 @@
+% PERFSTATS Performance counters of wrappers
+%  stats = PERFSTATS()
+%  stats = PERFSTATS("reset")
+%
+% Inputs: 
+%    "reset": reset counters (counters before reset are returned)
+%
+% Outputs:
+%    stats  : 1x1, struct with a field for each wrapper called since load
+%             (e.g. stats.rtkpos, stats.pntpos, stats.satposs)
+%      .ncall : 1x1, number of calls
+%      .tin   : 1x1, time of input marshalling (mx to RTKLIB) (s)
+%      .tcomp : 1x1, time of RTKLIB computation (s)
+%      .tout  : 1x1, time of output marshalling (RTKLIB to mx) (s)
+%      .ttotal: 1x1, total time (s)
+%      .bytes : 1x1, bytes of temporary buffers allocated
+%      .peak  : 1x1, peak temporary buffer size in a call (bytes)
+%
+% Notes:
+%    counters are recorded by readrnxobs, readrnxnav, readrnxnavs, navload,
+%    satpos, satposs, peph2pos, pntpos and rtkpos, also called via core
+%    counters are shared by all mex files in MATLAB process, they are kept
+%    after "clear all" until they are reset by PERFSTATS("reset")
+%    temporary buffers are C buffers converted from input structs and
+%    buffers of outputs, navigation data handle is not copied
+%     
+% Author: 
+%    Taro Suzuki
@@ -1,16 +1,30 @@
 % PNTPOS Compute receiver position, velocity, clock bias by single-point positioning
 %  [sol, ssat] = PNTPOS(obs, nav, opt)
+%  [sol, ssat, msg] = PNTPOS(obs, nav, opt, nthread)
 %
 % Inputs: 
 %    obs   : 1x1, observation data struct
-%    nav   : 1x1, navigation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
 %    [opt] : 1x1, option struct
+%   [nthread]: 1x1, number of threads for epoch loop (optional)
+%               Default: [] (OpenMP default, OMP_NUM_THREADS)
 %
 % Outputs:
 %    sol   : 1x1, solution struct
 %    ssat  : 1x1, satellite status struct
+%    [msg] : Mx1, cell array of no-solution messages of epochs ('': solution)
+%               M: number of epochs {obs.n}
 %
 % Notes:
+%    broadcast ephemeris is selected by per-satellite index sorted by toe
+%    (same ephemeris as RTKLIB seleph/selgeph)
+%    blocks of 64 epochs are computed in parallel by OpenMP, then epochs at
+%    the start of each block are recomputed in order from the previous
+%    solution (initial position of estimation) until the solution is the
+%    same, so that results are identical to single thread (nthread=1)
+%    if msg is not requested, no-solution messages are output after the loop
+%    if trace is enabled (opt.trace>0) or precise or SSR ephemeris is used
+%    (opt.sateph), single thread is used
 % 
 % Author: 
-%    Taro Suzuki
\ No newline at end of file
+%    Taro Suzuki
@@ -0,0 +1,33 @@
+% POSTPOS Post-processing positioning (forward/backward/combined solution)
+%  [sol, stat] = POSTPOS(obs, nav, opt)
+%  [sol, stat] = POSTPOS(obs, nav, opt, obsb)
+%  [sol, stat] = POSTPOS(obs, nav, opt, obsb, soltype)
+%
+% Inputs: 
+%    obs   : 1x1, observation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
+%    opt   : 1x1, option struct
+%    [obsb]: 1x1, observation data struct for base station ([]: no base)
+%    [soltype]: 1x1, solution type (default: "combined")
+%            "forward" or 0 : forward filter
+%            "backward" or 1: backward filter
+%            "combined" or 2: forward and backward filters combined
+%
+% Outputs:
+%    sol   : 1x1, solution struct (epochs with solution only)
+%    stat  : 1x1, satellite status struct (same epochs as sol)
+%
+% Notes:
+%    forward and backward filters of "combined" are run concurrently on
+%    two threads by OpenMP in DGPS/RTK modes (opt.mode<=5) with broadcast
+%    ephemeris, without tide correction (opt.tidecorr=0) and trace,
+%    otherwise they are run in order by single thread
+%    solutions are combined by the same rules as RTKLIB postpos (better
+%    solution status or smoothed solution)
+%    satellite status of combined epoch is the status of forward filter
+%    size of rover and base observations must be same
+%    broadcast ephemeris is selected by per-satellite index sorted by toe
+%    (same ephemeris as RTKLIB seleph/selgeph)
+% 
+% Author: 
+%    Taro Suzuki
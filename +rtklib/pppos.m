@@ -0,0 +1,48 @@
+% PPPOS Compute rover position by precise point positioning (PPP session)
+%  ppp = PPPOS("open", opt)
+%  ppp = PPPOS("open", opt, rtk)
+%  [sol, stat] = PPPOS(ppp, obs, nav)
+%  [sol, stat, rtk] = PPPOS(ppp, obs, nav, outmode)
+%  [sol, stat, rtk, msg] = PPPOS(ppp, obs, nav, outmode)
+%  rtk = PPPOS("state", ppp)
+%  rtk = PPPOS("state", ppp, format)
+%  PPPOS("close", ppp)
+%
+% Inputs: 
+%    ppp   : 1x1, PPP session handle (uint64)
+%    opt   : 1x1, option struct (PPP positioning mode)
+%    [rtk] : 1x1, initial rtk control struct (e.g. output of "state")
+%    [format]: 1x1, format of rtk struct, "full" or "compact" (see RTKINIT)
+%    obs   : 1x1, observation data struct (next batch of epochs)
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
+%    [outmode]: 1x1, output mode of rtk struct (default: "final")
+%            "final": final epoch only
+%            N      : every N-th epoch and final epoch
+%            "all"  : all epochs (same as N=1)
+%            "pv"   : all epochs, position/velocity states and covariance only
+%                     (final epoch with full states)
+%
+% Outputs:
+%    ppp   : 1x1, PPP session handle (uint64)
+%    sol   : 1x1, solution struct
+%    stat  : 1x1, satellite status struct
+%    rtk   : Mx1, rtk control struct (M: number of output epochs)
+%    msg   : Nx1, error messages of epochs without solution (cell array,
+%            empty for epochs with solution)
+%
+% Notes:
+%    rtk control struct of session is kept in memory between calls, so
+%    observation data can be processed in batches without converting
+%    filter states from/to rtk struct
+%    rtk struct is output only if it is requested
+%    rtk struct is output as compact struct if session is opened with
+%    compact rtk struct (see RTKINIT)
+%    epochs without solution have solution status 0 (none) in sol
+%    session must be closed by "close" to free memory, sessions are also
+%    freed when pppos is cleared (or by "free" of rtklib.core) and their
+%    handles become invalid
+%    trace file pppos.trace is shared by sessions with trace, it is closed
+%    when the last of them is closed
+% 
+% Author: 
+%    Taro Suzuki
@@ -0,0 +1,34 @@
+% RCVGEOM Compute receiver-satellite geometry and atmospheric delays
+%  [rng, ex, ey, ez, az, el, trp, ion] = RCVGEOM(epoch, rsx, rsy, rsz, rr, ionprm, freq, nthread)
+%
+% Inputs: 
+%    epoch  : Mx6 or 1x6, calendar day/time in GPST
+%               {year, month, day, hour, minute, second}
+%    rsx    : MxN or 1xN, satellite ECEF position X (m)
+%               M: number of epochs
+%               N: number of satellites
+%    rsy    : MxN or 1xN, satellite ECEF position Y (m)
+%    rsz    : MxN or 1xN, satellite ECEF position Z (m)
+%    rr     : Mx3 or 1x3, receiver ECEF position (m)
+%    ionprm : 1x8, ionosphere model parameters {a0,a1,a2,a3,b0,b1,b2,b3}
+%    freq   : FxN, carrier frequency (Hz)
+%               F: number of frequencies
+%   [nthread]: 1x1, number of threads for epoch loop (optional)
+%
+% Outputs:
+%    rng    : MxN, geometric distance (m) (-1: error/no satellite position)
+%    ex     : MxN, line-of-sight vector X
+%    ey     : MxN, line-of-sight vector Y
+%    ez     : MxN, line-of-sight vector Z
+%    az     : MxN, satellite azimuth (deg)
+%    el     : MxN, satellite elevation (deg)
+%    trp    : MxN, tropospheric delay by saastamoinen model (m)
+%    ion    : MxNxF, ionospheric delay by klobuchar model (m)
+%
+%  Notes:
+%    Same results as geodist, satazel, tropmodel and ionmodel in one call
+%    Frequency compensation is applied to ionospheric delay
+%    Outputs are NaN for NaN receiver position
+% 
+% Author: 
+%    Taro Suzuki
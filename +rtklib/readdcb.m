@@ -1,10 +1,13 @@
 % READDCB Read differential code bias (DCB) parameters
 %  nav = READDCB(file)
 %  nav = READDCB(file, nav)
+%  nav = READDCB(file, nav, fmt)
 %
 % Inputs: 
 %    file : 1x1, DCB file path
 %    nav  : 1x1, navigation data struct
+%    fmt  : 1x1, ephemeris format of output nav (optional)
+%           {"struct" (default): struct array, "column": columnar struct}
 %
 % Outputs:
 %    nav  : 1x1, navigation data struct
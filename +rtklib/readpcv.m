@@ -11,6 +11,7 @@
 %    file with the extension .atx or .ATX is recognized as antex
 %    file except for antex is recognized ngs antenna parameters
 %    only support non-azimuth-dependent parameters
+%    parsed parameters are kept until "clear mex" (re-read if file is modified)
 %
 % Author: 
 %    Taro Suzuki
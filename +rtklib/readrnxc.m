@@ -1,10 +1,13 @@
 % READRNXC Read RINEX clock files
 %  nav = READRNXC(file)
 %  nav = READRNXC(file, nav)
+%  nav = READRNXC(file, nav, fmt)
 %
 % Inputs: 
 %    file  : 1x1, file name
 %    nav   : 1x1, navigation data struct
+%    fmt   : 1x1, ephemeris format of output nav (optional)
+%            {"struct" (default): struct array, "column": columnar struct}
 %
 % Outputs:
 %    nav   : 1x1, navigation data struct
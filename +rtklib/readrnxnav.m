@@ -1,13 +1,22 @@
 % READRNXNAV Read RINEX navigation file
 %  nav = READRNXNAV(file)
 %  nav = READRNXNAV(file, nav)
+%  nav = READRNXNAV(file, fmt)
+%  nav = READRNXNAV(file, nav, fmt)
 %
 % Inputs: 
 %    file  : 1x1, file name {???.nav}
 %    nav   : 1x1, navigation data struct
+%    fmt   : 1x1, ephemeris format of output nav (optional)
+%            {"struct" (default): struct array, "column": columnar struct}
 %
 % Outputs:
 %    nav   : 1x1, navigation data struct
+%
+% Notes:
+%    columnar struct has one Nx1 vector per field of eph/geph (Nx6 matrix
+%    for epochs, Nx3/Nx4 for vectors) instead of Nx1 struct array
+%    input nav of all functions can be either format
 %     
 % Author: 
 %    Taro Suzuki
@@ -0,0 +1,27 @@
+% READRNXNAVS Read multiple RINEX navigation files
+%  nav = READRNXNAVS(files)
+%  nav = READRNXNAVS(files, fmt)
+%  nav = READRNXNAVS(files, fmt, nthread)
+%  [nav, stat] = READRNXNAVS(___)
+%
+% Inputs: 
+%    files  : 1xN, file names {???.nav} (cell array or char, wild-card * is expanded)
+%   [fmt]   : 1x1, output format (optional)
+%             {"struct" (default): nav struct with struct array,
+%              "column": nav struct with columnar struct,
+%              "handle": navigation data handle (see NAVLOAD)}
+%   [nthread]: 1x1, number of worker threads (optional)
+%             Default: number of processors
+%
+% Outputs:
+%    nav   : 1x1, navigation data struct or handle
+%    stat  : 1xM, read status of each expanded file (1:ok, 0:error)
+%
+% Notes:
+%    each file is read on worker threads and merged navigation data is
+%    sorted and duplicated ephemerides are removed once
+%    files with read error are skipped, error if no file can be read
+%    navigation data handle must be released by NAVFREE
+%     
+% Author: 
+%    Taro Suzuki
@@ -1,11 +1,41 @@
 % READRNXOBS Read RINEX observation file
 %  obs = READRNXOBS(file)
+%  obs = READRNXOBS(file, freq)
+%  obs = READRNXOBS(file, freq, obstype)
+%  obs = READRNXOBS(file, freq, obstype, ts, te, tint, navsys, exsats, opt)
 %
 % Inputs: 
-%    file : 1x1, file name {???.obs}
+%    file    : 1x1, file name {???.obs}
+%   [freq]   : 1xN, cell array of frequencies to read {'L1','L2','L5','L6','L7','L8','L9'}
+%              (optional) Default: [] (all frequencies)
+%   [obstype]: 1x1, observables to read, combination of 'P','L','D','S','I' (e.g. 'PL')
+%              (optional) Default: [] (all observables)
+%   [ts]     : 1x6, start time in calendar day/time (GPST) {y,m,d,h,m,s}
+%              (optional) Default: [] (no limit)
+%   [te]     : 1x6, end time in calendar day/time (GPST) {y,m,d,h,m,s}
+%              (optional) Default: [] (no limit)
+%   [tint]   : 1x1, time interval (s)
+%              (optional) Default: [] (all epochs)
+%   [navsys] : 1x1, navigation system mask (e.g. 1+8: GPS+Galileo)
+%              (optional) Default: [] (all systems)
+%   [exsats] : 1xM, excluded satellite numbers
+%              (optional) Default: [] (no excluded satellite)
+%   [opt]    : 1x1, RINEX options of RTKLIB (e.g. '-GL1C -GL2W')
+%              (optional) Default: [] (no option)
 %
 % Outputs:
 %    obs  : 1x1, observation data struct
+%
+% Notes:
+%    frequency structs contain only the selected observables
+%    parsed data can be cached in binary format, the cache is used while
+%    path, size and modified time of the file are unchanged and checksum
+%    of the cache is valid (the cache is read without parsing, but data is
+%    copied into the output arrays)
+%    cache is disabled by default, it is enabled by environment variable
+%    MATRTKLIB_CACHE (cache directory or "on": tempdir)
+%    ts/te/tint/navsys/exsats are applied to the cache without parsing the
+%    file again, opt always parses the file and bypasses the cache
 %     
 % Author: 
 %    Taro Suzuki
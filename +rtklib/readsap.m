@@ -1,11 +1,14 @@
 % READSAP Read satellite antenna parameters
 %  nav = READSAP(file, epoch)
 %  nav = READSAP(file, epoch, nav)
+%  nav = READSAP(file, epoch, nav, fmt)
 %
 % Inputs: 
 %    file  : 1x1, antenna parameter file (ANTEX format)
 %    epoch : 1x6, time {year, month, day, hour, minute, second}
 %    nav   : 1x1, navigation data struct
+%    fmt   : 1x1, ephemeris format of output nav (optional)
+%            {"struct" (default): struct array, "column": columnar struct}
 %
 % Outputs:
 %    nav   : 1x1, navigation data struct
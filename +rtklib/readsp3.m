@@ -1,10 +1,13 @@
 % READSP3 Read SP3 file
 %  nav = READSP3(file)
 %  nav = READSP3(file, nav)
+%  nav = READSP3(file, nav, fmt)
 %
 % Inputs: 
 %    file : 1x1, sp3-c precise ephemeris file (wind-card * is expanded)
 %    nav  : 1x1, navigation data struct
+%    fmt  : 1x1, ephemeris format of output nav (optional)
+%           {"struct" (default): struct array, "column": columnar struct}
 %
 % Outputs:
 %    nav  : 1x1, navigation data struct
@@ -1,11 +1,23 @@
 % RTKINIT Initialize RTK control struct
 %  rtk = RTKINIT(opt)
+%  rtk = RTKINIT(opt, format)
 %
 % Inputs: 
 %    opt : 1x1, option struct
+%    [format]: 1x1, format of rtk struct (default: "full")
+%            "full"   : x (1xNX), P (NXxNX), xa (1xNA), Pa (NAxNA)
+%            "compact": active states only (non-zero state or covariance)
+%                       ix/ia: 1xM, indexes of active states
+%                       x/xa : 1xM, active states
+%                       P/Pa : 1x(M*(M+1)/2), lower triangle of covariance
+%                              of active states packed by column
 %
 % Outputs:
 %    rtk : 1x1, rtk control struct
 %
+% Notes:
+%    compact rtk struct can be used as input of RTKPOS and PPPOS, RTKPOS
+%    outputs compact rtk struct if input rtk struct is compact
+%
 % Author: 
 %    Taro Suzuki
@@ -1,16 +1,34 @@
 % RTKPOS Compute rover position by precise positioning
-%  rtk = RTKPOS(rtk, obs, nav, opt)
-%  rtk = RTKPOS(rtk, obs, nav, opt, obsb)
+%  [rtk, sol, stat] = RTKPOS(rtk, obs, nav, opt)
+%  [rtk, sol, stat] = RTKPOS(rtk, obs, nav, opt, obsb)
+%  [rtk, sol, stat] = RTKPOS(rtk, obs, nav, opt, obsb, outmode)
 %
 % Inputs: 
 %    rtk   : 1x1, rtk control struct
 %    obs   : 1x1, observation data struct
-%    nav   : 1x1, navigation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
 %    opt   : 1x1, option struct
-%    [obsb]: 1x1, observation data struct for base station
+%    [obsb]: 1x1, observation data struct for base station ([]: no base)
+%    [outmode]: 1x1, output mode of rtk struct (default: "final")
+%            "final": final epoch only
+%            N      : every N-th epoch and final epoch
+%            "all"  : all epochs (same as N=1)
+%            "pv"   : all epochs, position/velocity states and covariance only
+%                     (final epoch with full states)
 %
 % Outputs:
-%    rtk   : 1x1, rtk control struct
+%    rtk   : Mx1, rtk control struct (M: number of output epochs)
+%    sol   : 1x1, solution struct
+%    stat  : 1x1, satellite status struct
+%
+% Notes:
+%    full state covariance (nx x nx) is output for "final"/N/"all" and for
+%    final epoch of "pv", so last element of output rtk struct can always
+%    be used as input of RTKPOS to continue processing
+%    rtk struct is output as compact struct if input rtk is compact
+%    (see RTKINIT), only active states are converted from/to rtk struct
+%    broadcast ephemeris is selected by per-satellite index sorted by toe
+%    (same ephemeris as RTKLIB seleph/selgeph)
 % 
 % Author: 
-%    Taro Suzuki
\ No newline at end of file
+%    Taro Suzuki
@@ -4,7 +4,7 @@
 % Inputs: 
 %    sat  : 1xN, satellite number defined in RTKLIB
 %    code : 1xN, obs code (CODE_???)
-%    nav  : 1x1, navigation data struct
+%    nav  : 1x1, navigation data struct or handle (see NAVLOAD)
 %
 % Outputs:
 %    freq : 1xN, carrier frequency (Hz) (0.0: error)
@@ -10,7 +10,7 @@
 %    rsy   : MxN, satellite position Y in ECEF (m)
 %    rsz   : MxN, satellite position Z in ECEF (m)
 %    sat   : 1xN, satellite number defined in RTKLIB
-%    nav   : 1x1, navigation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
 %
 % Outputs:
 %    dx    : MxN, satellite antenna phase center offset X in ECEF (m)
@@ -0,0 +1,41 @@
+% SATCACHE Control satellite state cache and output statistics
+%  stats = SATCACHE()
+%  stats = SATCACHE(command)
+%  stats = SATCACHE("on", budget)
+%
+% Inputs: 
+%    command: 1x1, command
+%               "on"   : enable cache (entries are allocated in budget)
+%               "off"  : disable cache and free entries
+%               "clear": remove entries and reset statistics
+%               "stats": output statistics only (default)
+%   [budget]: 1x1, memory budget of cache (MB) (optional)
+%               Default: 64
+%
+% Outputs:
+%    stats  : 1x1, statistics of cache (before command)
+%      .enable  : 1x1, cache enabled (1) or disabled (0)
+%      .budget  : 1x1, memory budget (bytes)
+%      .n       : 1x1, number of cached states
+%      .nmax    : 1x1, max number of cached states in budget
+%      .bytes   : 1x1, allocated memory (bytes)
+%      .nhit    : 1x1, number of states found in cache
+%      .nmiss   : 1x1, number of states not found in cache (computed)
+%      .nbypass : 1x1, number of calls not using cache (nav struct input)
+%      .nevict  : 1x1, number of least recently used states evicted
+%      .hitrate : 1x1, nhit/(nhit+nmiss)
+%      .satpos, .satposs, .peph2pos: 1x1, nhit/nmiss/nbypass of wrapper
+%
+% Notes:
+%    satellite states (position, velocity, clock, variance and health) are
+%    cached by satpos, satposs and peph2pos, keyed by satellite, time,
+%    ephemeris option and navigation data handle (see NAVLOAD)
+%    satposs states are keyed by signal reception time and pseudorange
+%    states are cached only if navigation data handle is used, since
+%    handle is not changed until NAVFREE
+%    cache is shared by all mex files in MATLAB process, it is freed when
+%    the mex file enabling cache (satcache or rtklib.core) is cleared,
+%    e.g. by "clear all" or "clear mex" (or by "free" of rtklib.core)
+%     
+% Author: 
+%    Taro Suzuki
@@ -1,12 +1,15 @@
 % SATPOS Compute satellite position, velocity and clock
 %  [x, y, z, vx, vy, vz, dts, ddts, var, svh] = SATPOS(epoch, sat, nav, opt)
+%  [x, y, z, vx, vy, vz, dts, ddts, var, svh] = SATPOS(epoch, sat, nav, opt, nthread)
 %
 % Inputs: 
 %    epoch : Mx6, calendar day/time
 %               {year, month, day, hour, minute, second}
 %    sat   : 1xN, satellite number defined in RTKLIB
-%    nav   : 1x1, navigation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
 %    opt   : 1x1, ephemeris option (EPHOPT_???)
+%   [nthread]: 1x1, number of threads for epoch loop (optional)
+%               Default: [] (OpenMP default, OMP_NUM_THREADS)
 %
 % Outputs:
 %    x     : MxN, satellite position X in ECEF (m)
@@ -26,6 +29,14 @@
 %    satellite position is referenced to antenna phase center
 %    satellite clock does not include code bias correction (tgd or bgd)
 %    Use "satposs" to compute satellite position at signal transmission
+%    epochs are computed in parallel by OpenMP and results are identical
+%    to single thread (nthread=1), messages are output after the loop
+%    precise and SSR ephemeris are computed by single thread since
+%    satellite antenna offset of RTKLIB (sunmoonpos) is not thread-safe
+%    broadcast ephemeris is selected by per-satellite index sorted by toe
+%    (same ephemeris as RTKLIB seleph/selgeph)
+%    if satellite state cache is enabled (see SATCACHE) and nav is
+%    navigation data handle, cached states are not recomputed
 % 
 % Author: 
 %    Taro Suzuki
\ No newline at end of file
@@ -1,10 +1,13 @@
 % SATPOSS Compute satellite position, velocity and clock
 %  [x, y, z, vx, vy, vz, dts, ddts, var, svh] = SATPOSS(obs, nav, opt)
+%  [x, y, z, vx, vy, vz, dts, ddts, var, svh] = SATPOSS(obs, nav, opt, nthread)
 %
 % Inputs: 
 %    obs   : 1x1, observation data struct
-%    nav   : 1x1, navigation data struct
+%    nav   : 1x1, navigation data struct or handle (see NAVLOAD)
 %    opt   : 1x1, ephemeris option (EPHOPT_???)
+%   [nthread]: 1x1, number of threads for epoch loop (optional)
+%               Default: [] (OpenMP default, OMP_NUM_THREADS)
 %
 % Outputs:
 %    x     : MxN, satellite position X in ECEF (m)
@@ -25,6 +28,14 @@
 %    pseudorange and broadcast ephemeris are needed to get signal transmission time
 %    satellite position is referenced to antenna phase center
 %    satellite clock does not include code bias correction (tgd or bgd)
+%    epochs are computed in parallel by OpenMP and results are identical
+%    to single thread (nthread=1), messages are output after the loop
+%    precise and SSR ephemeris are computed by single thread since
+%    satellite antenna offset of RTKLIB (sunmoonpos) is not thread-safe
+%    broadcast ephemeris is selected by per-satellite index sorted by toe
+%    (same ephemeris as RTKLIB seleph/selgeph)
+%    if satellite state cache is enabled (see SATCACHE) and nav is
+%    navigation data handle, cached states are not recomputed
 % 
 % Author: 
 %    Taro Suzuki
\ No newline at end of file
@@ -1,15 +1,21 @@
 % SEARCHPCV Search antenna parameter
 %  pcv = SEARCHPCV(sat, type, epoch, pcvs)
+%  pcv = SEARCHPCV(sat, type, epoch, file)
 %
 % Inputs: 
-%    sat   : 1x1, satellite number defined in RTKLIB (0: receiver antenna)
+%    sat   : 1xN, satellite number defined in RTKLIB (0: receiver antenna)
 %    type  : 1x1, antenna type for receiver antenna
 %    epoch : 1x6, calendar day/time in GPST
 %                {year, month, day, hour, minute, second}
 %    pcvs  : 1x1, pcvs struct
+%    file  : 1x1, antenna parameter file (antex)
 % 
 % Outputs:
-%    pcv   : 1x1, pcv struct
+%    pcv   : Nx1, pcv struct (empty pcv if not found)
+%
+% Notes:
+%    antenna parameter file is indexed at the first call and kept until
+%    "clear mex", later calls with the same file search it without parsing
 %
 % Author: 
 %    Taro Suzuki
@@ -4,7 +4,7 @@
 % Inputs: 
 %    epoch   : Mx6, calendar day/time in GPST
 %                 {year, month, day, hour, minute, second}
-%    nav     : 1x1, navigation data struct
+%    nav     : 1x1, navigation data struct or handle (see NAVLOAD)
 %    llh     : Mx3 or 1x3, receiver geodetic position (deg, deg, m)
 %    az      : MxN, satellite azimuth (deg)
 %                 M: number of epochs
@@ -7,5 +7,10 @@
 % Outputs:
 %    llh   : Mx3, geodetic position (deg, deg, m)
 %
+% Notes:
+%    geodetic position is computed by Bowring's method with fixed
+%    iterations (difference from ecef2pos of RTKLIB < 0.1 mm)
+%    NaN is returned for NaN input
+%
 % Author: 
 %    Taro Suzuki
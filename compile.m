@@ -9,6 +9,8 @@ clc;
 %% Compile option
 trace_option = true;    % enable/disable debug trace
 obs100Hz_option = true; % whether 100Hz observation data can be handled
+openmp_option = true;   % enable/disable OpenMP in vectorized wrappers
+shared_core = false;    % link wrappers against shared RTKLIB core library (CMake is required)
 
 %% Setting
 path = fileparts(mfilename('fullpath'));
@@ -27,115 +29,159 @@ if obs100Hz_option
     option = [option ' -DOBS_100HZ'];
 end
 
+ompoption = '';
+if openmp_option
+    if ispc % MSVC
+        ompoption = ' COMPFLAGS="$COMPFLAGS /openmp"';
+    elseif isunix && ~ismac % GCC (Apple clang does not support -fopenmp)
+        ompoption = ' CFLAGS="$CFLAGS -fopenmp" LDFLAGS="$LDFLAGS -fopenmp"';
+    end
+end
+
+%% Shared RTKLIB core library
+% RTKLIB sources are built once by src/CMakeLists.txt and removed from each
+% mex command, the library is installed to +rtklib and loaded by all mex files
+if shared_core && ispc
+    % data symbols of RTKLIB (e.g. prcopt_default) cannot be imported from
+    % DLL without __declspec(dllimport) in rtklib.h
+    warning('Shared RTKLIB core library is not supported on Windows');
+    shared_core = false;
+end
+if shared_core
+    onoff = {'OFF','ON'};
+    cmd = sprintf(['cmake -S "%s/src" -B "%s/src/build" -DRTKLIB_TRACE=%s -DRTKLIB_OBS_100HZ=%s' ...
+        ' && cmake --build "%s/src/build" --config Release' ...
+        ' && cmake --install "%s/src/build" --config Release'], ...
+        path, path, onoff{trace_option+1}, onoff{obs100Hz_option+1}, path, path);
+    if system(cmd) ~= 0
+        error('Failed to build shared RTKLIB core library (see src/CMakeLists.txt)');
+    end
+    libpath = [path '/+rtklib'];
+    if ismac
+        corelib = [' LINKLIBS="$LINKLIBS -L' libpath ' -lrtklib -Wl,-rpath,@loader_path"'];
+    else
+        corelib = [' LINKLIBS="$LINKLIBS -L' libpath ' -lrtklib -Wl,-rpath,' libpath '"'];
+    end
+    core = @(cmd) [regexprep(cmd, ' \.\./RTKLIB/src/\w+\.c', '') corelib];
+else
+    core = @(cmd) cmd;
+end
+
 %% Satellites, systems, codes functions
-eval(['mex satno.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex satsys.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex satid2no.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex satno2id.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex obs2code.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex code2obs.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex code2freq.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex sat2freq.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex code2idx.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex satno.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex satsys.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex satid2no.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex satno2id.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex obs2code.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex code2obs.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex code2freq.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex sat2freq.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex code2idx.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Time and string functions
-eval(['mex tow2epoch.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex epoch2tow.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex gsttow2epoch.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex epoch2gsttow.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex bdttow2epoch.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex epoch2bdttow.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex gpst2utc.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex utc2gpst.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex gpst2bdt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex bdt2gpst.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex epoch2doy.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex tow2doy.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex utc2gmst.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex adjgpsweek.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex reppath.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex tow2epoch.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex epoch2tow.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex gsttow2epoch.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex epoch2gsttow.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex bdttow2epoch.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex epoch2bdttow.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex gpst2utc.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex utc2gpst.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex gpst2bdt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex bdt2gpst.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex epoch2doy.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex tow2doy.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex utc2gmst.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex adjgpsweek.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex reppath.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Coordinates transformation
-eval(['mex xyz2llh.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex llh2xyz.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex xyz2enu.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex enu2xyz.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex enu2llh.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex llh2enu.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex ecef2enu.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex enu2ecef.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex covenu.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex covenusol.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex covecef.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex covecefsol.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex eci2ecef.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex deg2dms.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex dms2deg.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex xyz2llh.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex llh2xyz.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex xyz2enu.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex enu2xyz.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex enu2llh.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex llh2enu.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex ecef2enu.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex enu2ecef.c coord.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex covenu.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex covenusol.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex covecef.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex covecefsol.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex eci2ecef.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex deg2dms.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex dms2deg.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Input and output functions
-eval(['mex readpos.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex readblq.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex readerp.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex geterp.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex readpos.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readblq.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readerp.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex geterp.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Platform dependent functions
-eval(['mex expath.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex expath.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Positioning models
-eval(['mex satazel.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex geodist.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex dops.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex satazel.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex geodist.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex rcvgeom.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex dops.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Atmosphere models
-eval(['mex ionmodel.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex ionmapf.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex ionppp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex tropmodel.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex tropmapf.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]);
+eval(core(['mex ionmodel.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex ionmapf.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex ionppp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex tropmodel.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex tropmapf.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]));
 % iontec
 % readtec
-eval(['mex ionocorr.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c -outdir ../../+rtklib' option]);
-eval(['mex tropcorr.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c -outdir ../../+rtklib' option]);
+eval(core(['mex ionocorr.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c -outdir ../../+rtklib' option]));
+eval(core(['mex tropcorr.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c -outdir ../../+rtklib' option]));
 
 %% Antenna models
-eval(['mex readpcv.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex searchpcv.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex antmodel.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex antmodel_s.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex readpcv.c pcvidx.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex searchpcv.c pcvidx.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex antmodel.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex antmodel_s.c pcv2pcv.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
 
 %% Earth tide models
-eval(['mex sunmoonpos.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex tidedisp.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/tides.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex sunmoonpos.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex tidedisp.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/tides.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% Geiod models
-eval(['mex geoidh.c -I../RTKLIB/src ../RTKLIB/src/geoid.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex geoidh.c geoidmap.c mapfile.c -I../RTKLIB/src ../RTKLIB/src/geoid.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option ompoption]));
 
 %% Datum transformation
-eval(['mex tokyo2jgd.c -I../RTKLIB/src ../RTKLIB/src/datum.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex jgd2tokyo.c -I../RTKLIB/src ../RTKLIB/src/datum.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex tokyo2jgd.c -I../RTKLIB/src ../RTKLIB/src/datum.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex jgd2tokyo.c -I../RTKLIB/src ../RTKLIB/src/datum.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 
 %% RINEX functions
-eval(['mex readrnxobs.c obs2obs.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex readrnxnav.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex outrnxobs.c obs2obs.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex outrnxnav.c  nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex readrnxc.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex readrnxobs.c perf.c obs2obs.c obscache.c mapfile.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readrnxnav.c perf.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readrnxnavs.c perf.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex outrnxobs.c obs2obs.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex outrnxnav.c  nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readrnxc.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 % convrnx
 
+%% Navigation data handle functions
+eval(core(['mex navload.c perf.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex navfree.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+
 %% Ephemeris and clock functions
-eval(['mex eph2clk.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
-eval(['mex geph2clk.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
+eval(core(['mex eph2clk.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]));
+eval(core(['mex geph2clk.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]));
 % seph2clk
-eval(['mex eph2pos.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
-eval(['mex geph2pos.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
+eval(core(['mex eph2pos.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]));
+eval(core(['mex geph2pos.c eph2eph.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]));
 % seph2pos
-eval(['mex peph2pos.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
-eval(['mex satantoff.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex satpos.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
-eval(['mex satposs.c obs2obs.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option]);
-eval(['mex readsp3.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex readsap.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
-eval(['mex readdcb.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]);
+eval(core(['mex peph2pos.c pephv.c satcache.c perf.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex satantoff.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex satpos.c satcache.c perf.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex satposs.c satcache.c perf.c obs2obs.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/preceph.c ../RTKLIB/src/sbas.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex readsp3.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readsap.c pcvidx.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
+eval(core(['mex readdcb.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../RTKLIB/src/preceph.c ../RTKLIB/src/rtkcmn.c -outdir ../../+rtklib' option]));
 % alm2pos
 % tle_read
 % tle_name_read
@@ -151,17 +197,17 @@ eval(['mex readdcb.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c -I../RTKLIB/src ../
 % gen_rtcm3
 
 %% Solution functions
-eval(['mex readsol.c sol2sol.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]);
-eval(['mex readsolstat.c solstat2solstat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]);
-eval(['mex outsol.c sol2sol.c opt2opt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]);
+eval(core(['mex readsol.c sol2sol.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]));
+eval(core(['mex readsolstat.c solstat2solstat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]));
+eval(core(['mex outsol.c sol2sol.c opt2opt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]));
 % outsolex
 % outnmea_rmc
 % outnmea_gga
 % outnmea_gsv
 
 %% Google Earth kml/gpx converter
-eval(['mex convkml_.c -output convkml sol2sol.c -I../RTKLIB/src ../RTKLIB/src/convkml.c ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]);
-eval(['mex convgpx_.c -output convgpx sol2sol.c -I../RTKLIB/src ../RTKLIB/src/convgpx.c ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]);
+eval(core(['mex convkml_.c -output convkml sol2sol.c -I../RTKLIB/src ../RTKLIB/src/convkml.c ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]));
+eval(core(['mex convgpx_.c -output convgpx sol2sol.c -I../RTKLIB/src ../RTKLIB/src/convgpx.c ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/solution.c ../RTKLIB/src/geoid.c -outdir ../../+rtklib' option]));
 
 %% SBAS functions
 % sbsreadmsg
@@ -170,23 +216,28 @@ eval(['mex convgpx_.c -output convgpx sol2sol.c -I../RTKLIB/src ../RTKLIB/src/co
 % sbstropcorr
 
 %% Options functions
-eval(['mex loadopts.c opt2opt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/options.c -outdir ../../+rtklib' option]);
-eval(['mex saveopts.c opt2opt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/options.c -outdir ../../+rtklib' option]);
+eval(core(['mex loadopts.c opt2opt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/options.c -outdir ../../+rtklib' option]));
+eval(core(['mex saveopts.c opt2opt.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/options.c -outdir ../../+rtklib' option]));
 
 %% Integer ambiguity resolution
-eval(['mex lambda_.c -output lambda -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/lambda.c -outdir ../../+rtklib' option]);
+eval(core(['mex lambda_.c -output lambda -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/lambda.c -outdir ../../+rtklib' option]));
 
 %% Standard positioning
-eval(['mex pntpos_.c -output pntpos obs2obs.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/pntpos.c  ../RTKLIB/src/ephemeris.c  ../RTKLIB/src/sbas.c  ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/geoid.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option]);
+eval(core(['mex pntpos_.c -output pntpos perf.c obs2obs.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/pntpos.c  ../RTKLIB/src/ephemeris.c  ../RTKLIB/src/sbas.c  ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/geoid.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option ompoption]));
 
 %% Precise positioning
-eval(['mex rtkinit.c opt2opt.c rtk2rtk.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c  ../RTKLIB/src/ephemeris.c  ../RTKLIB/src/sbas.c  ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c -outdir ../../+rtklib' option]);
-eval(['mex rtkpos_.c -output rtkpos obs2obs.c nav2nav.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c rtk2rtk.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c ../RTKLIB/src/geoid.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option]);
+eval(core(['mex rtkinit.c opt2opt.c rtk2rtk.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c  ../RTKLIB/src/ephemeris.c  ../RTKLIB/src/sbas.c  ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c -outdir ../../+rtklib' option]));
+eval(core(['mex rtkpos_.c -output rtkpos perf.c obs2obs.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c rtk2rtk.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c ../RTKLIB/src/geoid.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option]));
 
 %% Precise point positioning
-% pppos
+eval(core(['mex pppos.c perf.c obs2obs.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c rtk2rtk.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c ../RTKLIB/src/geoid.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option]));
 
 %% Post-processing positioning
-% postpos
+eval(core(['mex postpos_.c -output postpos perf.c obs2obs.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c ../RTKLIB/src/geoid.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option ompoption]));
+
+%% Dispatcher with resident state
+eval(core(['mex core.c perf.c geoidmap.c pcvidx.c pephv.c satcache.c obs2obs.c obscache.c mapfile.c nav2nav.c registry.c ephidx.c eph2eph.c pcv2pcv.c erp2erp.c opt2opt.c rtk2rtk.c sol2sol.c ssat2ssat.c -I../RTKLIB/src ../RTKLIB/src/rtkcmn.c ../RTKLIB/src/rinex.c ../RTKLIB/src/rtkpos.c ../RTKLIB/src/pntpos.c ../RTKLIB/src/ephemeris.c ../RTKLIB/src/sbas.c ../RTKLIB/src/preceph.c ../RTKLIB/src/ionex.c ../RTKLIB/src/tides.c ../RTKLIB/src/lambda.c ../RTKLIB/src/ppp.c ../RTKLIB/src/ppp_ar.c ../RTKLIB/src/ppp_corr.c ../RTKLIB/src/mdccssr.c ../RTKLIB/src/geoid.c ../RTKLIB/src/datum.c ../RTKLIB/src/solution.c -outdir ../../+rtklib' option ompoption]));
+eval(core(['mex perfstats.c perf.c registry.c -I../RTKLIB/src -outdir ../../+rtklib' option]));
+eval(core(['mex satcache_.c -output satcache satcache.c registry.c -I../RTKLIB/src -outdir ../../+rtklib' option]));
 
 cd(path);
\ No newline at end of file
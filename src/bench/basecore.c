@@ -0,0 +1,225 @@
+/**
+ * @file basecore.c
+ * @brief Dispatcher of baseline wrappers for golden outputs of bench
+ * @author Taro Suzuki
+ * @note Built only by "make golden" against src/mex of the baseline revision
+ * (BASE in Makefile) in place of core.c and the current converters, so that
+ * golden outputs are computed by the code before optimizations
+ * @note Outputs of the baseline wrappers are adapted to the current interface
+ * used by bench: time span of readrnxobs, only received frequency blocks in
+ * obs struct, final epoch of rtk struct (default output mode of rtkpos) and
+ * epoch time of rtkpos stat. Other values are output of the baseline as is
+ * @note Baseline obs2mxobs is renamed to obs2mxobs_base by the compile
+ * definition in Makefile
+ */
+
+#include "mex_utility.h"
+
+/* wrappers of baseline -----------------------------------------------*/
+#define mexFunction mex_readrnxobs
+#include "readrnxobs.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_satposs
+#include "satposs.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_pntpos
+#include "pntpos_.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_rtkpos
+#include "rtkpos_.c"
+#undef mexFunction
+#undef NIN
+
+#undef obs2mxobs
+
+typedef void mexfunc_t(int, mxArray *[], int, const mxArray *[]);
+
+/* command table */
+typedef struct {
+    const char *name; /* command name */
+    mexfunc_t *func;  /* wrapper function */
+} corecmd_t;
+
+/* remove frequency blocks without pseudorange (not received) ---------*/
+static void prunefreq(mxArray *mxobs) {
+    const char *ftype[] = {"L1", "L2", "L5", "L6", "L7", "L8", "L9"};
+    mxArray *mxfrq, *mxP;
+    double *P;
+    int i, k, n;
+
+    for (k = 0; k < (int)(sizeof(ftype) / sizeof(ftype[0])); k++) {
+        if (!(mxfrq = mxGetField(mxobs, 0, ftype[k]))) continue;
+        mxP = mxGetField(mxfrq, 0, "P");
+        P = mxP ? mxGetPr(mxP) : NULL;
+        n = mxP ? (int)mxGetNumberOfElements(mxP) : 0;
+        for (i = 0; i < n; i++) {
+            if (!mxIsNaN(P[i]) && P[i] != 0.0) break;
+        }
+        if (i < n) continue;
+        mxDestroyArray(mxfrq);
+        mxRemoveField(mxobs, mxGetFieldNumber(mxobs, ftype[k]));
+    }
+}
+/* obs2mxobs (current interface, obsmask must be NULL) ----------------*/
+extern mxArray *obs2mxobs(const obsd_t *obs, const int n, const int *nobslist,
+                          const int *obsmask) {
+    mxArray *mxobs;
+
+    if (obsmask) mexErrMsgTxt("basecore: obsmask is not supported");
+    mxobs = obs2mxobs_base(obs, n, nobslist);
+    prunefreq(mxobs);
+    return mxobs;
+}
+/* free navigation data of mxnav2nav ----------------------------------*/
+extern void freenavdata(nav_t *nav) {
+    free(nav->eph);
+    free(nav->geph);
+    free(nav->peph);
+    free(nav->pclk);
+    nav->eph = NULL;
+    nav->geph = NULL;
+    nav->peph = NULL;
+    nav->pclk = NULL;
+    nav->n = nav->ng = nav->ne = nav->nc = 0;
+}
+/* ecef to geodetic position (points with NaN: all NaN) ---------------*/
+extern void ecef2posv(const double *xyz, const int m, double *llh) {
+    double r[3], pos[3];
+    int i, k;
+
+    for (i = 0; i < m; i++) {
+        for (k = 0; k < 3; k++) r[k] = xyz[i + k * m];
+        if (isnan(r[0]) || isnan(r[1]) || isnan(r[2])) {
+            llh[i] = llh[i + m] = llh[i + 2 * m] = mxGetNaN();
+            continue;
+        }
+        ecef2pos(r, pos);
+        llh[i] = pos[0] * R2D;
+        llh[i + m] = pos[1] * R2D;
+        llh[i + 2 * m] = pos[2];
+    }
+}
+/* geodetic position to ecef ------------------------------------------*/
+extern void pos2ecefv(const double *llh, const int m, double *xyz) {
+    double pos[3], r[3];
+    int i;
+
+    for (i = 0; i < m; i++) {
+        pos[0] = llh[i] * D2R;
+        pos[1] = llh[i + m] * D2R;
+        pos[2] = llh[i + 2 * m];
+        pos2ecef(pos, r);
+        xyz[i] = r[0];
+        xyz[i + m] = r[1];
+        xyz[i + 2 * m] = r[2];
+    }
+}
+/* readrnxobs: epochs in time span (ts, te) ---------------------------*/
+/* epochs are screened in the same way as screent in rinex.c            */
+static void base_readrnxobs(int nargout, mxArray *argout[], int nargin,
+                            const mxArray *argin[]) {
+    gtime_t ts = {0}, te = {0}, t;
+    obsd_t *obs;
+    int i, j, k, n, m = 0, iobs = 0, *nobslist;
+
+    for (i = 1; i < nargin && i < 3; i++) {
+        if (!mxIsEmpty(argin[i])) {
+            mexErrMsgTxt("basecore: readrnxobs selection is not supported");
+        }
+    }
+    if (nargin > 5) {
+        mexErrMsgTxt("basecore: readrnxobs selection is not supported");
+    }
+    if (nargin > 3 && !mxIsEmpty(argin[3])) ts = epoch2time(mxGetPr(argin[3]));
+    if (nargin > 4 && !mxIsEmpty(argin[4])) te = epoch2time(mxGetPr(argin[4]));
+
+    mex_readrnxobs(nargout, argout, 1, argin);
+    obs = mxobs2obs(argout[0], 1, &n, &nobslist);
+
+    /* pack epochs in time span */
+    for (i = j = 0; i < n; iobs += nobslist[i++]) {
+        if (nobslist[i] <= 0) continue;
+        t = obs[iobs].time;
+        if ((ts.time && timediff(t, ts) < -DTTOL) ||
+            (te.time && timediff(t, te) >= DTTOL)) {
+            continue;
+        }
+        for (k = 0; k < nobslist[i]; k++) obs[m + k] = obs[iobs + k];
+        m += nobslist[i];
+        nobslist[j++] = nobslist[i];
+    }
+    mxDestroyArray(argout[0]);
+    argout[0] = obs2mxobs(obs, j, nobslist, NULL);
+    free(obs);
+    free(nobslist);
+}
+/* rtkpos: rtk struct of final epoch and epoch time of stat -----------*/
+static void base_rtkpos(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    const char *f[32];
+    mxArray *mxrtk;
+    obsd_t *obs;
+    double ep[6], *eps;
+    int i, k, n, nrtk, nf, nep, iobs = 0, *nobslist;
+
+    if (nargin > 5) {
+        mexErrMsgTxt("basecore: rtkpos output mode is not supported");
+    }
+
+    mex_rtkpos(nargout, argout, nargin, argin);
+
+    /* final epoch (fields are moved to new struct) */
+    nrtk = (int)mxGetNumberOfElements(argout[0]);
+    nf = mxGetNumberOfFields(argout[0]);
+    for (k = 0; k < nf && k < 32; k++) {
+        f[k] = mxGetFieldNameByNumber(argout[0], k);
+    }
+    mxrtk = mxCreateStructMatrix(1, 1, nf, f);
+    for (k = 0; k < nf && nrtk > 0; k++) {
+        mxSetField(mxrtk, 0, f[k], mxGetFieldByNumber(argout[0], nrtk - 1, k));
+        mxSetField(argout[0], nrtk - 1, f[k], NULL);
+    }
+    mxDestroyArray(argout[0]);
+    argout[0] = mxrtk;
+
+    /* epoch time of stat from rover observation time */
+    if (nargout > 2) {
+        obs = mxobs2obs(argin[1], 1, &n, &nobslist);
+        nep = (int)mxGetM(mxGetField(argout[2], 0, "ep"));
+        eps = mxGetPr(mxGetField(argout[2], 0, "ep"));
+        for (i = 0; i < n && i < nep; iobs += nobslist[i++]) {
+            if (nobslist[i] <= 0) continue;
+            time2epoch(obs[iobs].time, ep);
+            for (k = 0; k < 6; k++) eps[i + nep * k] = ep[k];
+        }
+        free(obs);
+        free(nobslist);
+    }
+}
+
+static const corecmd_t cmds[] = {{"readrnxobs", base_readrnxobs},
+                                 {"satposs", mex_satposs},
+                                 {"pntpos", mex_pntpos},
+                                 {"rtkpos", base_rtkpos}};
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    char cmd[64];
+    int i;
+
+    if (nargin < 1 || !mxIsChar(argin[0])) {
+        mexErrMsgTxt("basecore: command must be string");
+    }
+    mxGetString(argin[0], cmd, sizeof(cmd));
+
+    for (i = 0; i < (int)(sizeof(cmds) / sizeof(cmds[0])); i++) {
+        if (strcmp(cmd, cmds[i].name)) continue;
+        cmds[i].func(nargout, argout, nargin - 1, argin + 1);
+        return;
+    }
+    mexErrMsgTxt("basecore: unknown command");
+}
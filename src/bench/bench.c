@@ -0,0 +1,697 @@
+/**
+ * @file bench.c
+ * @brief Benchmark of RTKLIB wrappers and converters without MATLAB
+ * @author Taro Suzuki
+ * @note Wrappers in src/mex are called through the dispatcher (core.c) with
+ * mx/mex API emulation (mxemu.c)
+ * @note Each case runs in a child process to measure its peak RSS
+ * @note All double values of outputs are compared element by element with
+ * golden file (relative tolerance GOLDTOL, NaN matches only NaN) to verify
+ * optimizations numerically. Golden file is not created by check run, it is
+ * generated by "-u" of bench built with baseline wrappers (make golden, see
+ * basecore.c)
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "mex_utility.h"
+
+#define MAXSCALE 8    /* max number of data scales */
+#define GOLDTOL 1E-9  /* relative tolerance of golden check */
+#define MAXGOLDN 1024 /* max length of golden header line */
+
+/* dispatcher of wrappers (core.c) */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]);
+
+/* benchmark data */
+typedef struct {
+    char rovfile[1024];     /* rover RINEX observation file */
+    obs_t obsr, obsb;       /* rover/base observation data */
+    nav_t nav;              /* navigation data */
+    double rb[3];           /* base station position (ECEF) */
+} benchdata_t;
+
+/* output values */
+typedef struct {
+    double *v;   /* double values of outputs (NaN included) */
+    int n, nmax; /* number of values/allocated */
+} outval_t;
+
+/* benchmark result */
+typedef struct {
+    int stat;        /* status (1:ok,0:error) */
+    int nep, nsat;   /* number of epochs/satellites */
+    double time;     /* minimum time of repeats (s) */
+    double maxrss;   /* peak RSS (MB) */
+    int nval;        /* number of output values */
+} result_t;
+
+typedef int benchfunc_t(const benchdata_t *, int, mxArray *, mxArray *,
+                        int, result_t *);
+
+/* benchmark case */
+typedef struct {
+    const char *name;  /* case name */
+    benchfunc_t *func; /* benchmark function */
+    int gold;          /* outputs are compared with golden file */
+} benchcase_t;
+
+static int nrep = 3;          /* number of repeats */
+static outval_t outv = {0};  /* output values of last repeat */
+
+/* current time (s) ---------------------------------------------------*/
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+/* call wrapper through dispatcher ------------------------------------*/
+static void callcore(const char *cmd, int nout, mxArray **out, int nin,
+                     const mxArray **in) {
+    const mxArray *argin[16];
+    mxArray *mxcmd = mxCreateString(cmd);
+    int i;
+
+    argin[0] = mxcmd;
+    for (i = 0; i < nin; i++) argin[i + 1] = in[i];
+    mexFunction(nout, out, nin + 1, argin);
+    mxDestroyArray(mxcmd);
+}
+/* add all double values in array to output values -------------------*/
+static void addval(const mxArray *mx) {
+    const double *p;
+    double *v;
+    mwSize i, n;
+    int k;
+
+    if (!mx) return;
+    n = mxGetNumberOfElements(mx);
+    if (mxIsStruct(mx)) {
+        for (i = 0; i < n; i++) {
+            for (k = 0; k < mxGetNumberOfFields(mx); k++) {
+                addval(mxGetFieldByNumber(mx, i, k));
+            }
+        }
+    } else if (mxIsCell(mx)) {
+        for (i = 0; i < n; i++) addval(mxGetCell(mx, i));
+    } else if (mxIsDouble(mx)) {
+        p = mxGetPr(mx);
+        for (i = 0; i < n; i++) {
+            if (outv.n >= outv.nmax) {
+                k = outv.nmax <= 0 ? 65536 : outv.nmax * 2;
+                if (!(v = (double *)realloc(outv.v, sizeof(double) * k))) {
+                    fprintf(stderr, "memory allocation error\n");
+                    exit(1);
+                }
+                outv.v = v;
+                outv.nmax = k;
+            }
+            outv.v[outv.n++] = p[i];
+        }
+    }
+}
+/* time of epoch ------------------------------------------------------*/
+static int nextepoch(const obs_t *obs, int i) {
+    int j;
+
+    for (j = i + 1; j < obs->n; j++) {
+        if (fabs(timediff(obs->data[j].time, obs->data[i].time)) > DTTOL) break;
+    }
+    return j;
+}
+/* rover and base observations of first nep common epochs -------------*/
+static int alignobs(const benchdata_t *data, int nep, mxArray **mxr,
+                    mxArray **mxb) {
+    const obs_t *obsr = &data->obsr, *obsb = &data->obsb;
+    obsd_t *dr, *db;
+    int i = 0, j = 0, ni, nj, n = 0, nr = 0, nb = 0, *nlr, *nlb;
+    double dt;
+
+    dr = (obsd_t *)malloc(sizeof(obsd_t) * (obsr->n + 1));
+    db = (obsd_t *)malloc(sizeof(obsd_t) * (obsb->n + 1));
+    nlr = (int *)malloc(sizeof(int) * (obsr->n + 1));
+    nlb = (int *)malloc(sizeof(int) * (obsr->n + 1));
+    if (!dr || !db || !nlr || !nlb) {
+        free(dr); free(db); free(nlr); free(nlb);
+        return 0;
+    }
+    while (i < obsr->n && j < obsb->n && n < nep) {
+        ni = nextepoch(obsr, i);
+        nj = nextepoch(obsb, j);
+        dt = timediff(obsr->data[i].time, obsb->data[j].time);
+        if (dt < -DTTOL) {
+            i = ni;
+        } else if (dt > DTTOL) {
+            j = nj;
+        } else {
+            memcpy(dr + nr, obsr->data + i, sizeof(obsd_t) * (ni - i));
+            memcpy(db + nb, obsb->data + j, sizeof(obsd_t) * (nj - j));
+            nlr[n] = ni - i;
+            nlb[n++] = nj - j;
+            nr += ni - i;
+            nb += nj - j;
+            i = ni;
+            j = nj;
+        }
+    }
+    *mxr = obs2mxobs(dr, n, nlr, NULL);
+    *mxb = obs2mxobs(db, n, nlb, NULL);
+    free(dr); free(db); free(nlr); free(nlb);
+    return n;
+}
+/* processing options -------------------------------------------------*/
+static void benchopt(const benchdata_t *data, int mode, prcopt_t *popt,
+                     solopt_t *sopt) {
+    int i;
+
+    *popt = prcopt_default;
+    *sopt = solopt_default;
+    popt->mode = mode;
+    popt->nf = 2;
+    popt->navsys = SYS_GPS | SYS_GLO | SYS_GAL | SYS_QZS | SYS_CMP;
+    popt->elmin = 15.0 * D2R;
+    popt->ionoopt = IONOOPT_BRDC;
+    popt->tropopt = TROPOPT_SAAS;
+    popt->modear = ARMODE_CONT;
+    popt->refpos = POSOPT_POS;
+    for (i = 0; i < 3; i++) popt->rb[i] = data->rb[i];
+}
+/* number of satellites of obs struct ---------------------------------*/
+static int obsnsat(const mxArray *mxobs) {
+    return (int)mxGetScalar(mxGetField(mxobs, 0, "nsat"));
+}
+/* run wrapper repeatedly and keep values of last output --------------*/
+static void runcore(const char *cmd, int nout, int nin, const mxArray **in,
+                    result_t *res) {
+    mxArray *out[8] = {0};
+    double t;
+    int i, k;
+
+    res->time = 1E99;
+    for (i = 0; i < nrep; i++) {
+        t = now();
+        callcore(cmd, nout, out, nin, in);
+        t = now() - t;
+        if (t < res->time) res->time = t;
+
+        outv.n = 0;
+        for (k = 0; k < nout; k++) {
+            addval(out[k]);
+            mxDestroyArray(out[k]);
+            out[k] = NULL;
+        }
+    }
+    res->stat = 1;
+}
+/* benchmark: readrnxobs ----------------------------------------------*/
+/* epochs are limited by end time of aligned epochs                      */
+static int readobscase(const benchdata_t *data, int nep, mxArray *mxr,
+                       int cache, result_t *res) {
+    const mxArray *in[6];
+    mxArray *out[3] = {0}, *mxfile, *mxte, *mxempty;
+    double ep[6], *tow, *week;
+    int i, n = (int)mxGetScalar(mxGetField(mxr, 0, "n"));
+
+    if (n <= 0) return 0;
+    tow = mxGetPr(mxGetField(mxr, 0, "tow"));
+    week = mxGetPr(mxGetField(mxr, 0, "week"));
+    time2epoch(gpst2time((int)week[n - 1], tow[n - 1]), ep);
+
+    setenv("MATRTKLIB_CACHE", cache ? "on" : "off", 1);
+    mxfile = mxCreateString(data->rovfile);
+    mxempty = mxCreateDoubleMatrix(0, 0, mxREAL);
+    mxte = mxCreateDoubleMatrix(1, 6, mxREAL);
+    for (i = 0; i < 6; i++) mxGetPr(mxte)[i] = ep[i];
+    in[0] = mxfile;
+    in[1] = in[2] = in[3] = mxempty;
+    in[4] = mxte;
+
+    if (cache) { /* create cache (not timed) */
+        callcore("readrnxobs", 3, out, 1, in);
+        for (i = 0; i < 3; i++) mxDestroyArray(out[i]);
+    }
+    runcore("readrnxobs", 3, 5, in, res);
+    res->nsat = obsnsat(mxr);
+
+    mxDestroyArray(mxfile);
+    mxDestroyArray(mxempty);
+    mxDestroyArray(mxte);
+    return 1;
+}
+static int benchreadobs(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    return readobscase(data, nep, mxr, 0, res);
+}
+static int benchreadobsc(const benchdata_t *data, int nep, mxArray *mxr,
+                    mxArray *mxb, int nthread, result_t *res) {
+    return readobscase(data, nep, mxr, 1, res);
+}
+/* benchmark: obs2obs (mxobs2obs + obs2mxobs) -------------------------*/
+static int benchobs2obs(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    obsd_t *obs;
+    mxArray *mx;
+    int i, n, *nlist;
+    double t;
+
+    res->time = 1E99;
+    for (i = 0; i < nrep; i++) {
+        t = now();
+        obs = mxobs2obs(mxr, 1, &n, &nlist);
+        mx = obs2mxobs(obs, n, nlist, NULL);
+        t = now() - t;
+        if (t < res->time) res->time = t;
+
+        outv.n = 0;
+        addval(mx);
+        mxDestroyArray(mx);
+        free(obs);
+        free(nlist);
+    }
+    res->nsat = obsnsat(mxr);
+    return res->stat = 1;
+}
+/* benchmark: nav2nav (nav2mxnav + mxnav2nav) -------------------------*/
+static int benchnav2nav(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    nav_t nav;
+    mxArray *mx;
+    int i;
+    double t;
+
+    res->time = 1E99;
+    for (i = 0; i < nrep; i++) {
+        t = now();
+        mx = nav2mxnav(&data->nav);
+        nav = mxnav2nav(mx);
+        t = now() - t;
+        if (t < res->time) res->time = t;
+
+        outv.n = 0;
+        addval(mx);
+        mxDestroyArray(mx);
+        freenavdata(&nav);
+    }
+    res->nsat = obsnsat(mxr);
+    return res->stat = 1;
+}
+/* benchmark: sol2sol (mxsol2sol + sol2mxsol) of pntpos solutions -----*/
+static int benchsol2sol(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    const mxArray *in[2];
+    mxArray *out[2] = {0}, *mxnav = nav2mxnav(&data->nav), *mx;
+    sol_t *sol;
+    int i, n;
+    double t;
+
+    in[0] = mxr;
+    in[1] = mxnav;
+    callcore("pntpos", 2, out, 2, in);
+    n = (int)mxGetScalar(mxGetField(out[0], 0, "n"));
+
+    res->time = 1E99;
+    for (i = 0; i < nrep; i++) {
+        t = now();
+        sol = mxsol2sol(out[0]);
+        mx = sol2mxsol(sol, n);
+        t = now() - t;
+        if (t < res->time) res->time = t;
+
+        outv.n = 0;
+        addval(mx);
+        mxDestroyArray(mx);
+        free(sol);
+    }
+    res->nsat = obsnsat(mxr);
+    mxDestroyArray(out[0]);
+    mxDestroyArray(out[1]);
+    mxDestroyArray(mxnav);
+    return res->stat = 1;
+}
+/* benchmark: satposs -------------------------------------------------*/
+static int benchsatposs(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    const mxArray *in[4];
+    mxArray *mxnav = nav2mxnav(&data->nav);
+    mxArray *mxopt = mxCreateDoubleScalar(EPHOPT_BRDC);
+    mxArray *mxthr = mxCreateDoubleScalar(nthread);
+
+    in[0] = mxr;
+    in[1] = mxnav;
+    in[2] = mxopt;
+    in[3] = mxthr;
+    runcore("satposs", 10, 4, in, res);
+    res->nsat = obsnsat(mxr);
+
+    mxDestroyArray(mxnav);
+    mxDestroyArray(mxopt);
+    mxDestroyArray(mxthr);
+    return 1;
+}
+/* benchmark: pntpos --------------------------------------------------*/
+static int benchpntpos(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    prcopt_t popt;
+    solopt_t sopt;
+    const mxArray *in[3];
+    mxArray *mxnav = nav2mxnav(&data->nav), *mxopt;
+
+    benchopt(data, PMODE_SINGLE, &popt, &sopt);
+    mxopt = opt2mxopt(&popt, &sopt);
+    in[0] = mxr;
+    in[1] = mxnav;
+    in[2] = mxopt;
+    runcore("pntpos", 2, 3, in, res);
+    res->nsat = obsnsat(mxr);
+
+    mxDestroyArray(mxnav);
+    mxDestroyArray(mxopt);
+    return 1;
+}
+/* benchmark: rtkpos (kinematic) --------------------------------------*/
+static int benchrtkpos(const benchdata_t *data, int nep, mxArray *mxr,
+                   mxArray *mxb, int nthread, result_t *res) {
+    prcopt_t popt;
+    solopt_t sopt;
+    rtk_t rtk;
+    const mxArray *in[5];
+    mxArray *mxnav = nav2mxnav(&data->nav), *mxopt, *mxrtk;
+    int i;
+
+    benchopt(data, PMODE_KINEMA, &popt, &sopt);
+    mxopt = opt2mxopt(&popt, &sopt);
+    rtkinit(&rtk, &popt);
+    for (i = 0; i < 3; i++) rtk.rb[i] = popt.rb[i];
+    mxrtk = rtk2mxrtk(&rtk, 1);
+    rtkfree(&rtk);
+
+    in[0] = mxrtk;
+    in[1] = mxr;
+    in[2] = mxnav;
+    in[3] = mxopt;
+    in[4] = mxb;
+    runcore("rtkpos", 3, 5, in, res);
+    res->nsat = obsnsat(mxr);
+
+    mxDestroyArray(mxnav);
+    mxDestroyArray(mxopt);
+    mxDestroyArray(mxrtk);
+    return 1;
+}
+/* benchmark: coordinate transformation (ecef2posv) -------------------*/
+/* nep x nsat points, points with partial NaN coordinates must be all    */
+/* NaN and others must be the same as input of pos2ecefv (self check)    */
+static int benchcoord(const benchdata_t *data, int nep, mxArray *mxr,
+                      mxArray *mxb, int nthread, result_t *res) {
+    double *llh, *xyz, *out, t;
+    int i, k, m, nan;
+
+    res->nsat = obsnsat(mxr);
+    m = nep * res->nsat;
+    llh = (double *)malloc(sizeof(double) * 3 * m + 1);
+    xyz = (double *)malloc(sizeof(double) * 3 * m + 1);
+    out = (double *)malloc(sizeof(double) * 3 * m + 1);
+    if (!llh || !xyz || !out) {
+        free(llh);
+        free(xyz);
+        free(out);
+        return 0;
+    }
+    for (i = 0; i < m; i++) {
+        llh[i] = -80.0 + 160.0 * (i % 997) / 997.0;
+        llh[i + m] = -180.0 + 360.0 * (i % 1009) / 1009.0;
+        llh[i + 2 * m] = 100.0 * (i % 13);
+    }
+    pos2ecefv(llh, m, xyz);
+    for (i = 5; i < m; i += 97) xyz[i + m * (i % 3)] = NAN;
+
+    res->time = 1E99;
+    for (k = 0; k < nrep; k++) {
+        t = now();
+        ecef2posv(xyz, m, out);
+        t = now() - t;
+        if (t < res->time) res->time = t;
+    }
+    res->stat = 1;
+    for (i = 0; i < m; i++) {
+        nan = isnan(out[i]) + isnan(out[i + m]) + isnan(out[i + 2 * m]);
+        if (i % 97 == 5 ? nan != 3
+                        : nan || fabs(out[i] - llh[i]) > 1E-8 ||
+                              fabs(out[i + m] - llh[i + m]) > 1E-8 ||
+                              fabs(out[i + 2 * m] - llh[i + 2 * m]) > 1E-3) {
+            fprintf(stderr, "coord: point %d (%.9f,%.9f,%.4f)\n", i, out[i],
+                    out[i + m], out[i + 2 * m]);
+            res->stat = 0;
+            break;
+        }
+    }
+    free(llh);
+    free(xyz);
+    free(out);
+    return res->stat;
+}
+
+/* cases without baseline counterpart are self-checked (not golden) */
+static const benchcase_t cases[] = {
+    {"readrnxobs", benchreadobs, 1}, {"readrnxobs(cache)", benchreadobsc, 1},
+    {"obs2obs", benchobs2obs, 1},    {"nav2nav", benchnav2nav, 1},
+    {"sol2sol", benchsol2sol, 1},    {"satposs", benchsatposs, 1},
+    {"pntpos", benchpntpos, 1},      {"rtkpos", benchrtkpos, 1},
+    {"coord", benchcoord, 0}};
+
+/* read/write all bytes of pipe --------------------------------------*/
+static int readall(int fd, void *buff, size_t size) {
+    ssize_t n;
+
+    for (; size > 0; size -= (size_t)n, buff = (char *)buff + n) {
+        if ((n = read(fd, buff, size)) <= 0) return 0;
+    }
+    return 1;
+}
+static int writeall(int fd, const void *buff, size_t size) {
+    ssize_t n;
+
+    for (; size > 0; size -= (size_t)n, buff = (const char *)buff + n) {
+        if ((n = write(fd, buff, size)) <= 0) return 0;
+    }
+    return 1;
+}
+/* run case in child process ------------------------------------------*/
+/* output values are returned to val (allocated, NULL: no value)         */
+static int runcase(const benchcase_t *c, const benchdata_t *data, int nep,
+                   int nthread, result_t *res, double **val) {
+    struct rusage ru;
+    mxArray *mxr = NULL, *mxb = NULL;
+    int fd[2], status;
+    pid_t pid;
+
+    memset(res, 0, sizeof(result_t));
+    *val = NULL;
+    if (pipe(fd)) return 0;
+    if ((pid = fork()) < 0) return 0;
+
+    if (pid == 0) { /* child */
+        close(fd[0]);
+        res->nep = alignobs(data, nep, &mxr, &mxb);
+        if (res->nep > 0) c->func(data, nep, mxr, mxb, nthread, res);
+        getrusage(RUSAGE_SELF, &ru);
+        res->maxrss = ru.ru_maxrss / 1024.0; /* KB (Linux) to MB */
+        res->nval = outv.n;
+        if (!writeall(fd[1], res, sizeof(result_t)) ||
+            !writeall(fd[1], outv.v, sizeof(double) * outv.n)) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    close(fd[1]);
+    if (!readall(fd[0], res, sizeof(result_t))) {
+        res->stat = 0;
+    } else if (res->nval > 0 &&
+               (!(*val = (double *)malloc(sizeof(double) * res->nval)) ||
+                !readall(fd[0], *val, sizeof(double) * res->nval))) {
+        res->stat = 0;
+    }
+    close(fd[0]);
+    waitpid(pid, &status, 0);
+    return res->stat;
+}
+/* write golden output ------------------------------------------------*/
+static void writegold(FILE *fp, const char *name, double scale,
+                      const double *val, int n) {
+    int i;
+
+    fprintf(fp, "%s %.4f %d\n", name, scale, n);
+    for (i = 0; i < n; i++) fprintf(fp, "%.17g\n", val[i]);
+}
+/* golden check: 1:ok,0:ng,-1:not found -------------------------------*/
+/* values are compared element by element (NaN matches only NaN)         */
+static int checkgold(FILE *fp, const char *name, double scale,
+                     const double *val, int n) {
+    char buff[MAXGOLDN], gname[64];
+    double gscale, g;
+    int i, gn;
+
+    rewind(fp);
+    while (fgets(buff, sizeof(buff), fp)) {
+        if (sscanf(buff, "%63s %lf %d", gname, &gscale, &gn) < 3) continue;
+        if (strcmp(gname, name) || fabs(gscale - scale) > 1E-6) continue;
+
+        if (gn != n) {
+            fprintf(stderr, "%s %.2f: number of values %d (golden %d)\n",
+                    name, scale, n, gn);
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            if (!fgets(buff, sizeof(buff), fp)) return 0;
+            g = strtod(buff, NULL);
+            if (isnan(g) ? isnan(val[i])
+                         : fabs(val[i] - g) <= GOLDTOL * fmax(1.0, fabs(g))) {
+                continue;
+            }
+            fprintf(stderr, "%s %.2f: value %d %.17g (golden %.17g)\n", name,
+                    scale, i, val[i], g);
+            return 0;
+        }
+        return 1;
+    }
+    return -1;
+}
+/* read benchmark data ------------------------------------------------*/
+static int readdata(const char *dir, benchdata_t *data) {
+    sta_t sta = {{0}};
+    gtime_t t0 = {0};
+    char file[1024];
+
+    sprintf(data->rovfile, "%s/rover.obs", dir);
+    if (readrnxt(data->rovfile, 1, t0, t0, 0, "", &data->obsr, NULL, NULL) <=
+        0) {
+        fprintf(stderr, "rover observation read error: %s\n", data->rovfile);
+        return 0;
+    }
+    sprintf(file, "%s/base.obs", dir);
+    if (readrnxt(file, 2, t0, t0, 0, "", &data->obsb, NULL, &sta) <= 0) {
+        fprintf(stderr, "base observation read error: %s\n", file);
+        return 0;
+    }
+    sprintf(file, "%s/base.nav", dir);
+    if (readrnxt(file, 1, t0, t0, 0, "", NULL, &data->nav, NULL) <= 0) {
+        fprintf(stderr, "navigation read error: %s\n", file);
+        return 0;
+    }
+    sortobs(&data->obsr);
+    sortobs(&data->obsb);
+    uniqnav(&data->nav);
+    memcpy(data->rb, sta.pos, sizeof(double) * 3);
+    return 1;
+}
+/* print usage --------------------------------------------------------*/
+static void usage(void) {
+    fprintf(stderr,
+            "usage: bench [-d dir] [-s scale,...] [-r nrep] [-t nthread]\n"
+            "             [-g golden] [-u]\n"
+            "  -d dir    data directory (rover.obs, base.obs, base.nav)\n"
+            "            [../../examples/data/static]\n"
+            "  -s scale  ratios of epochs of data [0.25,0.5,1]\n"
+            "  -r nrep   number of repeats (minimum time is reported) [3]\n"
+            "  -t nthread number of threads of satposs [1]\n"
+            "  -g golden golden output file [golden.txt]\n"
+            "  -u        update golden output file (baseline wrappers)\n");
+    exit(2);
+}
+
+/* main ---------------------------------------------------------------*/
+int main(int argc, char **argv) {
+    benchdata_t data = {{0}};
+    result_t res;
+    FILE *fp = NULL, *fpout = NULL;
+    const char *dir = "../../examples/data/static", *gold = "golden.txt";
+    double *val;
+    char *p, *q;
+    double scale[MAXSCALE] = {0.25, 0.5, 1.0};
+    int i, j, k, nscale = 3, nthread = 1, update = 0, nep, stat, ng = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            for (nscale = 0, p = argv[++i]; nscale < MAXSCALE; p = q + 1) {
+                scale[nscale++] = strtod(p, &q);
+                if (*q != ',') break;
+            }
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            nrep = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            nthread = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+            gold = argv[++i];
+        } else if (!strcmp(argv[i], "-u")) {
+            update = 1;
+        } else {
+            usage();
+        }
+    }
+    if (nrep < 1) nrep = 1;
+    if (nthread < 1) nthread = 1;
+    mxemuquiet(1);
+
+    if (!readdata(dir, &data)) return 1;
+
+    /* golden file is generated by -u on baseline tree (not by check run) */
+    if (!update && !(fp = fopen(gold, "r"))) {
+        fprintf(stderr, "golden file not found: %s (generate it by make "
+                        "golden)\n", gold);
+        return 1;
+    }
+    if (update) {
+        if (!(fpout = fopen(gold, "w"))) {
+            fprintf(stderr, "golden file open error: %s\n", gold);
+            return 1;
+        }
+    }
+    printf("%-18s %5s %6s %4s %10s %10s %12s %8s %6s\n", "case", "scale",
+           "epochs", "nsat", "time(ms)", "epochs/s", "ns/sat-ep", "RSS(MB)",
+           "golden");
+
+    for (i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        for (j = 0; j < nscale; j++) {
+            for (k = 0, nep = 0; k < data.obsr.n; k = nextepoch(&data.obsr, k)) {
+                nep++;
+            }
+            nep = (int)(nep * scale[j] + 0.5);
+
+            if (!runcase(cases + i, &data, nep, nthread, &res, &val)) {
+                printf("%-18s %5.2f  error\n", cases[i].name, scale[j]);
+                free(val);
+                ng++;
+                continue;
+            }
+            if (!cases[i].gold) {
+                stat = 1; /* self-checked by case */
+            } else if (fpout) {
+                writegold(fpout, cases[i].name, scale[j], val, res.nval);
+                stat = 2;
+            } else {
+                stat = checkgold(fp, cases[i].name, scale[j], val, res.nval);
+                if (stat <= 0) ng++;
+            }
+            free(val);
+            printf("%-18s %5.2f %6d %4d %10.3f %10.1f %12.1f %8.1f %6s\n",
+                   cases[i].name, scale[j], res.nep, res.nsat,
+                   res.time * 1E3, res.nep / res.time,
+                   res.time * 1E9 / ((double)res.nep * res.nsat), res.maxrss,
+                   stat == 1 ? "OK" : (stat == 0 ? "NG" : (stat == 2 ? "UPD" : "MISS")));
+        }
+    }
+    if (fp) fclose(fp);
+    if (fpout) fclose(fpout);
+    freeobs(&data.obsr);
+    freeobs(&data.obsb);
+    freenav(&data.nav, 0xFF);
+    return ng > 0 ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file mex.h
+ * @brief Minimal emulation of MATLAB mx/mex API for benchmark
+ * @author Taro Suzuki
+ * @note Only the functions used in src/mex are declared
+ * @note Semantics follow MATLAB: mxSetField/mxSetCell/mxRemoveField do not
+ * free replaced or removed arrays
+ */
+
+#ifndef _MEX_EMULATION_
+#define _MEX_EMULATION_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef size_t mwSize;
+typedef size_t mwIndex;
+typedef uint16_t mxChar;
+typedef struct mxArray_tag mxArray;
+
+typedef enum { mxREAL, mxCOMPLEX } mxComplexity;
+typedef enum {
+    mxUNKNOWN_CLASS, mxCELL_CLASS, mxSTRUCT_CLASS, mxLOGICAL_CLASS,
+    mxCHAR_CLASS, mxVOID_CLASS, mxDOUBLE_CLASS, mxSINGLE_CLASS,
+    mxINT8_CLASS, mxUINT8_CLASS, mxINT16_CLASS, mxUINT16_CLASS,
+    mxINT32_CLASS, mxUINT32_CLASS, mxINT64_CLASS, mxUINT64_CLASS
+} mxClassID;
+
+/* create/destroy */
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag);
+mxArray *mxCreateDoubleScalar(double value);
+mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID cls,
+                               mxComplexity flag);
+mxArray *mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID cls,
+                                     mxComplexity flag);
+mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims, mxClassID cls,
+                              mxComplexity flag);
+mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfield,
+                              const char **fields);
+mxArray *mxCreateCellMatrix(mwSize m, mwSize n);
+mxArray *mxCreateString(const char *str);
+void mxDestroyArray(mxArray *mx);
+void mxFree(void *ptr);
+
+/* data access */
+double *mxGetPr(const mxArray *mx);
+void *mxGetData(const mxArray *mx);
+double mxGetScalar(const mxArray *mx);
+mwSize mxGetM(const mxArray *mx);
+mwSize mxGetN(const mxArray *mx);
+mwSize mxGetNumberOfElements(const mxArray *mx);
+mwSize mxGetNumberOfDimensions(const mxArray *mx);
+const mwSize *mxGetDimensions(const mxArray *mx);
+int mxGetString(const mxArray *mx, char *str, mwSize len);
+char *mxArrayToString(const mxArray *mx);
+
+/* struct and cell */
+mxArray *mxGetField(const mxArray *mx, mwIndex i, const char *field);
+void mxSetField(mxArray *mx, mwIndex i, const char *field, mxArray *value);
+int mxGetFieldNumber(const mxArray *mx, const char *field);
+int mxAddField(mxArray *mx, const char *field);
+void mxRemoveField(mxArray *mx, int k);
+int mxGetNumberOfFields(const mxArray *mx);
+const char *mxGetFieldNameByNumber(const mxArray *mx, int k);
+mxArray *mxGetFieldByNumber(const mxArray *mx, mwIndex i, int k);
+mxArray *mxGetCell(const mxArray *mx, mwIndex i);
+void mxSetCell(mxArray *mx, mwIndex i, mxArray *value);
+
+/* type */
+mxClassID mxGetClassID(const mxArray *mx);
+bool mxIsDouble(const mxArray *mx);
+bool mxIsChar(const mxArray *mx);
+bool mxIsCell(const mxArray *mx);
+bool mxIsStruct(const mxArray *mx);
+bool mxIsNumeric(const mxArray *mx);
+bool mxIsUint64(const mxArray *mx);
+bool mxIsEmpty(const mxArray *mx);
+
+/* NaN */
+double mxGetNaN(void);
+bool mxIsNaN(double x);
+
+/* mex functions */
+void mexErrMsgTxt(const char *msg);
+void mexWarnMsgTxt(const char *msg);
+int mexPrintf(const char *fmt, ...);
+void mexLock(void);
+void mexUnlock(void);
+bool mexIsLocked(void);
+int mexAtExit(void (*func)(void));
+const mxArray *mexGetVariablePtr(const char *ws, const char *name);
+int mexPutVariable(const char *ws, const char *name, const mxArray *mx);
+
+/* benchmark: suppress mexPrintf/mexWarnMsgTxt outputs */
+void mxemuquiet(int quiet);
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * @file mxemu.c
+ * @brief Minimal emulation of MATLAB mx/mex API for benchmark
+ * @author Taro Suzuki
+ * @note Arrays are column-major as MATLAB, mexErrMsgTxt exits the process
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#include "mex.h"
+
+#define MXMAXDIM 8 /* max number of dimensions */
+#define MXMAXVAR 16 /* max number of workspace variables */
+
+struct mxArray_tag {
+    mxClassID cls;          /* class */
+    mwSize ndim;            /* number of dimensions */
+    mwSize dims[MXMAXDIM];  /* dimensions */
+    mwSize nelem;           /* number of elements */
+    void *data;             /* numeric/char data */
+    int nfield;             /* number of fields (struct) */
+    char **fname;           /* field names (struct) */
+    mxArray **elem;         /* fields (nelem*nfield) or cells (nelem) */
+};
+
+/* workspace variable (numeric/char only) */
+typedef struct {
+    char name[64];  /* variable name */
+    mxArray *mx;    /* value */
+} mxvar_t;
+
+static int quiet = 0;
+static mxvar_t vars[MXMAXVAR];
+static int nvar = 0;
+
+/* element size of class ----------------------------------------------*/
+static size_t elemsize(mxClassID cls) {
+    switch (cls) {
+        case mxDOUBLE_CLASS: case mxINT64_CLASS: case mxUINT64_CLASS: return 8;
+        case mxSINGLE_CLASS: case mxINT32_CLASS: case mxUINT32_CLASS: return 4;
+        case mxCHAR_CLASS: case mxINT16_CLASS: case mxUINT16_CLASS: return 2;
+        case mxLOGICAL_CLASS: case mxINT8_CLASS: case mxUINT8_CLASS: return 1;
+        default: return sizeof(mxArray *);
+    }
+}
+/* allocate memory (exit on error) ------------------------------------*/
+static void *xcalloc(size_t n, size_t size) {
+    void *p = calloc(n > 0 ? n : 1, size > 0 ? size : 1);
+    if (!p) mexErrMsgTxt("mxemu: memory allocation error");
+    return p;
+}
+/* new array ----------------------------------------------------------*/
+static mxArray *newarray(mxClassID cls, mwSize ndim, const mwSize *dims,
+                         int init) {
+    mxArray *mx = (mxArray *)xcalloc(1, sizeof(mxArray));
+    mwSize i;
+
+    mx->cls = cls;
+    mx->ndim = ndim < 2 ? 2 : ndim;
+    mx->dims[0] = mx->dims[1] = 1;
+    mx->nelem = 1;
+    for (i = 0; i < ndim && i < MXMAXDIM; i++) {
+        mx->dims[i] = dims[i];
+        mx->nelem *= dims[i];
+    }
+    if (cls != mxSTRUCT_CLASS && cls != mxCELL_CLASS) {
+        mx->data = init ? xcalloc(mx->nelem, elemsize(cls))
+                        : malloc(mx->nelem > 0 ? mx->nelem * elemsize(cls) : 1);
+        if (!mx->data) mexErrMsgTxt("mxemu: memory allocation error");
+    }
+    return mx;
+}
+/* create/destroy -----------------------------------------------------*/
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag) {
+    mwSize dims[2] = {m, n};
+    return newarray(mxDOUBLE_CLASS, 2, dims, 1);
+}
+mxArray *mxCreateDoubleScalar(double value) {
+    mxArray *mx = mxCreateDoubleMatrix(1, 1, mxREAL);
+    *(double *)mx->data = value;
+    return mx;
+}
+mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID cls,
+                               mxComplexity flag) {
+    mwSize dims[2] = {m, n};
+    return newarray(cls, 2, dims, 1);
+}
+mxArray *mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID cls,
+                                     mxComplexity flag) {
+    mwSize dims[2] = {m, n};
+    return newarray(cls, 2, dims, 0);
+}
+mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims, mxClassID cls,
+                              mxComplexity flag) {
+    return newarray(cls, ndim, dims, 1);
+}
+mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfield,
+                              const char **fields) {
+    mwSize dims[2] = {m, n};
+    mxArray *mx = newarray(mxSTRUCT_CLASS, 2, dims, 1);
+    int k;
+
+    mx->nfield = nfield;
+    mx->fname = (char **)xcalloc(nfield, sizeof(char *));
+    for (k = 0; k < nfield; k++) {
+        mx->fname[k] = (char *)xcalloc(strlen(fields[k]) + 1, 1);
+        strcpy(mx->fname[k], fields[k]);
+    }
+    mx->elem = (mxArray **)xcalloc(mx->nelem * nfield, sizeof(mxArray *));
+    return mx;
+}
+mxArray *mxCreateCellMatrix(mwSize m, mwSize n) {
+    mwSize dims[2] = {m, n};
+    mxArray *mx = newarray(mxCELL_CLASS, 2, dims, 1);
+    mx->elem = (mxArray **)xcalloc(mx->nelem, sizeof(mxArray *));
+    return mx;
+}
+mxArray *mxCreateString(const char *str) {
+    mwSize i, dims[2] = {1, strlen(str)};
+    mxArray *mx = newarray(mxCHAR_CLASS, 2, dims, 1);
+
+    for (i = 0; i < dims[1]; i++) {
+        ((mxChar *)mx->data)[i] = (mxChar)(unsigned char)str[i];
+    }
+    return mx;
+}
+void mxDestroyArray(mxArray *mx) {
+    mwSize i, n;
+    int k;
+
+    if (!mx) return;
+    if (mx->elem) {
+        n = mx->cls == mxSTRUCT_CLASS ? mx->nelem * mx->nfield : mx->nelem;
+        for (i = 0; i < n; i++) mxDestroyArray(mx->elem[i]);
+        free(mx->elem);
+    }
+    for (k = 0; k < mx->nfield; k++) free(mx->fname[k]);
+    free(mx->fname);
+    free(mx->data);
+    free(mx);
+}
+void mxFree(void *ptr) { free(ptr); }
+
+/* data access --------------------------------------------------------*/
+double *mxGetPr(const mxArray *mx) { return (double *)mx->data; }
+void *mxGetData(const mxArray *mx) { return mx->data; }
+double mxGetScalar(const mxArray *mx) {
+    if (!mx || mx->nelem == 0 || !mx->data) return 0.0;
+    switch (mx->cls) {
+        case mxDOUBLE_CLASS: return *(double *)mx->data;
+        case mxSINGLE_CLASS: return *(float *)mx->data;
+        case mxINT32_CLASS: return *(int32_t *)mx->data;
+        case mxUINT32_CLASS: return *(uint32_t *)mx->data;
+        case mxINT64_CLASS: return (double)*(int64_t *)mx->data;
+        case mxUINT64_CLASS: return (double)*(uint64_t *)mx->data;
+        case mxCHAR_CLASS: return *(mxChar *)mx->data;
+        case mxINT16_CLASS: return *(int16_t *)mx->data;
+        case mxUINT16_CLASS: return *(uint16_t *)mx->data;
+        case mxINT8_CLASS: return *(int8_t *)mx->data;
+        default: return *(uint8_t *)mx->data;
+    }
+}
+mwSize mxGetM(const mxArray *mx) { return mx->dims[0]; }
+mwSize mxGetN(const mxArray *mx) { /* product of 2nd and later dims */
+    mwSize i, n = 1;
+    for (i = 1; i < mx->ndim; i++) n *= mx->dims[i];
+    return n;
+}
+mwSize mxGetNumberOfElements(const mxArray *mx) { return mx->nelem; }
+mwSize mxGetNumberOfDimensions(const mxArray *mx) { return mx->ndim; }
+const mwSize *mxGetDimensions(const mxArray *mx) { return mx->dims; }
+int mxGetString(const mxArray *mx, char *str, mwSize len) {
+    mwSize i;
+
+    if (!mx || mx->cls != mxCHAR_CLASS || len == 0) return 1;
+    for (i = 0; i < mx->nelem && i < len - 1; i++) {
+        str[i] = (char)((mxChar *)mx->data)[i];
+    }
+    str[i] = '\0';
+    return i < mx->nelem ? 1 : 0;
+}
+char *mxArrayToString(const mxArray *mx) {
+    char *str;
+
+    if (!mx || mx->cls != mxCHAR_CLASS) return NULL;
+    str = (char *)xcalloc(mx->nelem + 1, 1);
+    mxGetString(mx, str, mx->nelem + 1);
+    return str;
+}
+
+/* struct and cell ----------------------------------------------------*/
+int mxGetFieldNumber(const mxArray *mx, const char *field) {
+    int k;
+
+    if (!mx || mx->cls != mxSTRUCT_CLASS) return -1;
+    for (k = 0; k < mx->nfield; k++) {
+        if (!strcmp(mx->fname[k], field)) return k;
+    }
+    return -1;
+}
+mxArray *mxGetField(const mxArray *mx, mwIndex i, const char *field) {
+    int k = mxGetFieldNumber(mx, field);
+    return k < 0 || i >= mx->nelem ? NULL : mx->elem[i * mx->nfield + k];
+}
+void mxSetField(mxArray *mx, mwIndex i, const char *field, mxArray *value) {
+    int k = mxGetFieldNumber(mx, field);
+    if (k < 0 || i >= mx->nelem) mexErrMsgTxt("mxemu: invalid field");
+    mx->elem[i * mx->nfield + k] = value;
+}
+int mxAddField(mxArray *mx, const char *field) {
+    mxArray **elem;
+    mwSize i;
+    int k, n;
+
+    if (!mx || mx->cls != mxSTRUCT_CLASS) return -1;
+    if ((k = mxGetFieldNumber(mx, field)) >= 0) return k;
+    n = mx->nfield + 1;
+    elem = (mxArray **)xcalloc(mx->nelem * n, sizeof(mxArray *));
+    for (i = 0; i < mx->nelem; i++) {
+        for (k = 0; k < mx->nfield; k++) {
+            elem[i * n + k] = mx->elem[i * mx->nfield + k];
+        }
+    }
+    free(mx->elem);
+    mx->elem = elem;
+    mx->fname = (char **)realloc(mx->fname, sizeof(char *) * n);
+    mx->fname[n - 1] = (char *)xcalloc(strlen(field) + 1, 1);
+    strcpy(mx->fname[n - 1], field);
+    mx->nfield = n;
+    return n - 1;
+}
+void mxRemoveField(mxArray *mx, int k) {
+    mwSize i;
+    int j, m, n;
+
+    if (!mx || mx->cls != mxSTRUCT_CLASS || k < 0 || k >= mx->nfield) return;
+    n = mx->nfield - 1;
+    for (i = 0; i < mx->nelem; i++) {
+        for (j = m = 0; j <= n; j++) {
+            if (j == k) continue;
+            mx->elem[i * n + m++] = mx->elem[i * mx->nfield + j];
+        }
+    }
+    free(mx->fname[k]);
+    memmove(mx->fname + k, mx->fname + k + 1, sizeof(char *) * (n - k));
+    mx->nfield = n;
+}
+int mxGetNumberOfFields(const mxArray *mx) { return mx->nfield; }
+const char *mxGetFieldNameByNumber(const mxArray *mx, int k) {
+    return k < 0 || k >= mx->nfield ? NULL : mx->fname[k];
+}
+mxArray *mxGetFieldByNumber(const mxArray *mx, mwIndex i, int k) {
+    return k < 0 || k >= mx->nfield || i >= mx->nelem
+               ? NULL
+               : mx->elem[i * mx->nfield + k];
+}
+mxArray *mxGetCell(const mxArray *mx, mwIndex i) {
+    return !mx || mx->cls != mxCELL_CLASS || i >= mx->nelem ? NULL
+                                                             : mx->elem[i];
+}
+void mxSetCell(mxArray *mx, mwIndex i, mxArray *value) {
+    if (!mx || mx->cls != mxCELL_CLASS || i >= mx->nelem) {
+        mexErrMsgTxt("mxemu: invalid cell index");
+    }
+    mx->elem[i] = value;
+}
+
+/* type ---------------------------------------------------------------*/
+mxClassID mxGetClassID(const mxArray *mx) { return mx->cls; }
+bool mxIsDouble(const mxArray *mx) { return mx->cls == mxDOUBLE_CLASS; }
+bool mxIsChar(const mxArray *mx) { return mx->cls == mxCHAR_CLASS; }
+bool mxIsCell(const mxArray *mx) { return mx->cls == mxCELL_CLASS; }
+bool mxIsStruct(const mxArray *mx) { return mx->cls == mxSTRUCT_CLASS; }
+bool mxIsNumeric(const mxArray *mx) {
+    return mx->cls >= mxDOUBLE_CLASS && mx->cls <= mxUINT64_CLASS;
+}
+bool mxIsUint64(const mxArray *mx) { return mx->cls == mxUINT64_CLASS; }
+bool mxIsEmpty(const mxArray *mx) { return mx->nelem == 0; }
+
+/* NaN ----------------------------------------------------------------*/
+double mxGetNaN(void) { return NAN; }
+bool mxIsNaN(double x) { return isnan(x); }
+
+/* mex functions ------------------------------------------------------*/
+void mexErrMsgTxt(const char *msg) {
+    fprintf(stderr, "error: %s\n", msg);
+    exit(1);
+}
+void mexWarnMsgTxt(const char *msg) {
+    if (!quiet) fprintf(stderr, "warning: %s\n", msg);
+}
+int mexPrintf(const char *fmt, ...) {
+    va_list ap;
+    int n;
+
+    if (quiet) return 0;
+    va_start(ap, fmt);
+    n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+static int mexlocked = 0;
+void mexLock(void) { mexlocked = 1; }
+void mexUnlock(void) { mexlocked = 0; }
+bool mexIsLocked(void) { return mexlocked; }
+int mexAtExit(void (*func)(void)) { return 0; }
+
+/* workspace variables (one workspace shared by "base"/"caller"/"global") */
+const mxArray *mexGetVariablePtr(const char *ws, const char *name) {
+    int i;
+
+    for (i = 0; i < nvar; i++) {
+        if (!strcmp(vars[i].name, name)) return vars[i].mx;
+    }
+    return NULL;
+}
+int mexPutVariable(const char *ws, const char *name, const mxArray *mx) {
+    mxArray *copy;
+    int i;
+
+    if (mx->cls == mxSTRUCT_CLASS || mx->cls == mxCELL_CLASS) return 1;
+    copy = newarray(mx->cls, mx->ndim, mx->dims, 0);
+    memcpy(copy->data, mx->data, elemsize(mx->cls) * mx->nelem);
+
+    for (i = 0; i < nvar; i++) {
+        if (strcmp(vars[i].name, name)) continue;
+        mxDestroyArray(vars[i].mx);
+        vars[i].mx = copy;
+        return 0;
+    }
+    if (nvar >= MXMAXVAR) {
+        mxDestroyArray(copy);
+        return 1;
+    }
+    strncpy(vars[nvar].name, name, sizeof(vars[nvar].name) - 1);
+    vars[nvar++].mx = copy;
+    return 0;
+}
+
+void mxemuquiet(int q) { quiet = q; }
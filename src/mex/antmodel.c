@@ -3,6 +3,7 @@
  * @brief Compute antenna offset by antenna phase center parameters
  * @author Taro Suzuki
  * @note Wrapper for "antmodel" in rtkcmn.c
+ * @note Epochs are processed in parallel by OpenMP
  */
 
 #include "mex_utility.h"
@@ -13,8 +14,8 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     pcv_t pcv = {0};
-    int i, j, m, nsat, opt, freqidx;
-    double *del, *azs, *els, *dant, azel[2], dantfreq[NFREQ];
+    int i, j, m, nsat, opt, freqidx, nthread;
+    double *del, *azs, *els, *dant;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -33,17 +34,24 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     els = (double *)mxGetPr(argin[3]);
     opt = (int)mxGetScalar(argin[4]);
     freqidx = (int)mxGetScalar(argin[5]);
+    nthread = mxGetNumThreads(nargin, argin, 6);
+    if (freqidx < 0 || freqidx >= NFREQ) {
+        mexErrMsgTxt("antmodel: invalid frequency index");
+    }
 
     /* output */
     argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
     dant = mxGetPr(argout[0]);
 
     /* call RTKLIB function */
+#pragma omp parallel for num_threads(nthread) private(j) schedule(static)
     for (i = 0; i < m; i++) {
+        double azel[2], dantfreq[NFREQ];
+
         for (j = 0; j < nsat; j++) {
             azel[0] = azs[i + m * j] * D2R;
             azel[1] = els[i + m * j] * D2R;
-            antmodel(&pcv, del, azel, opt, &dantfreq);
+            antmodel(&pcv, del, azel, opt, dantfreq);
             dant[i + m * j] = dantfreq[freqidx];
         }
     }
@@ -3,6 +3,8 @@
  * @brief Compute satellite antenna phase center parameters
  * @author Taro Suzuki
  * @note Wrapper for "antmodel_s" in rtkcmn.c
+ * @note Only PCV of input satellites are converted from struct, and epochs
+ * are processed in parallel by OpenMP
  */
 
 #include "mex_utility.h"
@@ -12,34 +14,58 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    pcv_t pcvs[MAXSAT] = {{0}};
-    int i, j, m, nsat, freqidx;
-    double *sat, *nadir, *dant, azel[2], dantfreq[NFREQ];
+    const char *pcvf[] = {"sat", "type", "code", "ts", "te", "off", "var"};
+    pcv_t *pcvs;
+    int i, j, m, nsat, freqidx, nthread, *valid;
+    double *sat, *nadir, *dant;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
     mxCheckSizeOfArgument(argin[0], MAXSAT, 1); /* pcv */
+    mxCheckStruct(argin[0], pcvf, 7);
     mxCheckSameColumns(argin[1], argin[2]);     /* sat,nadir */
     mxCheckScalar(argin[3]);                    /* freqidx */
 
     /* input */
-    mxpcv2pcv(argin[0], MAXSAT, pcvs);
     sat = (double *)mxGetPr(argin[1]);
     nsat = (int)mxGetN(argin[1]);
     nadir = (double *)mxGetPr(argin[2]);
     m = (int)mxGetM(argin[2]);
     freqidx = (int)mxGetScalar(argin[3]);
+    nthread = mxGetNumThreads(nargin, argin, 4);
+    if (freqidx < 0 || freqidx >= NFREQ) {
+        mexErrMsgTxt("antmodel_s: invalid frequency index");
+    }
+
+    /* PCV of input satellites */
+    if (!(pcvs = (pcv_t *)malloc(sizeof(pcv_t) * (nsat > 0 ? nsat : 1))) ||
+        !(valid = (int *)malloc(sizeof(int) * (nsat > 0 ? nsat : 1)))) {
+        free(pcvs);
+        mexErrMsgTxt("antmodel_s: memory allocation error");
+    }
+    for (j = 0; j < nsat; j++) {
+        valid[j] = sat[j] >= 1 && sat[j] <= MAXSAT;
+        if (valid[j]) mxpcv2pcvi(argin[0], (int)sat[j] - 1, pcvs + j);
+    }
 
     /* output */
     argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
     dant = mxGetPr(argout[0]);
 
     /* call RTKLIB function */
+#pragma omp parallel for num_threads(nthread) private(j) schedule(static)
     for (i = 0; i < m; i++) {
+        double dantfreq[NFREQ];
+
         for (j = 0; j < nsat; j++) {
-            antmodel_s(&pcvs[(int)sat[j] - 1], nadir[i + m * j] * D2R,
-                       &dantfreq);
+            if (!valid[j]) {
+                dant[i + m * j] = mxGetNaN();
+                continue;
+            }
+            antmodel_s(pcvs + j, nadir[i + m * j] * D2R, dantfreq);
             dant[i + m * j] = dantfreq[freqidx];
         }
     }
+    free(pcvs);
+    free(valid);
 }
@@ -0,0 +1,139 @@
+/**
+ * @file coord.c
+ * @brief Batch coordinate transformation of column-major (m x 3) arrays
+ * @author Taro Suzuki
+ * @note Batch versions of "ecef2pos", "pos2ecef", "ecef2enu" and "enu2ecef"
+ * in rtkcmn.c, geodetic position is (lat,lon,height) in (deg,deg,m)
+ * @note Loop bodies are branch-free over columns so that they are vectorized
+ * (AVX2/NEON) by OpenMP simd or compiler, and are scalar loops otherwise
+ * @note ecef2posv uses Bowring's method with fixed two iterations instead of
+ * iteration until convergence (difference from ecef2pos < 0.1 mm)
+ * @note ecef2posv outputs all NaN for point with any NaN coordinate (same as
+ * xyz2llh before batch version)
+ */
+
+#include "mex_utility.h"
+
+#include <math.h>
+
+#define MINPARALLEL 16384 /* min number of points for multithreading */
+
+/* loop over points with threads and SIMD lanes (OpenMP 4.0 or later) */
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define FOR_POINTS \
+    _Pragma("omp parallel for simd schedule(static) if (m >= MINPARALLEL)")
+#else
+#define FOR_POINTS
+#endif
+
+/* ecef to geodetic position ------------------------------------------*/
+extern void ecef2posv(const double *xyz, const int m, double *llh) {
+    const double *x = xyz, *y = xyz + m, *z = xyz + 2 * m;
+    const double a = RE_WGS84, f = FE_WGS84, e2 = FE_WGS84 * (2.0 - FE_WGS84);
+    const double b = a * (1.0 - f), ep2 = e2 / (1.0 - e2);
+    double *lat = llh, *lon = llh + m, *hgt = llh + 2 * m, l[3], r[3];
+    int i;
+
+    /* sin/cos of latitude and height (latitude as (num,den) of atan2) */
+    FOR_POINTS
+    for (i = 0; i < m; i++) {
+        double p, sb, cb, s, num = 0.0, den = 0.0, sp, cp;
+        int k;
+
+        p = sqrt(x[i] * x[i] + y[i] * y[i]);
+        sb = z[i];                    /* initial tan(beta)=z/((1-f)p) */
+        cb = (1.0 - f) * p;
+        s = sqrt(sb * sb + cb * cb);
+        sb /= s;
+        cb /= s;
+        for (k = 0; k < 2; k++) {
+            num = z[i] + ep2 * b * sb * sb * sb;
+            den = p - e2 * a * cb * cb * cb;
+            sb = (1.0 - f) * num;     /* tan(beta)=(1-f)tan(lat) */
+            cb = den;
+            s = sqrt(sb * sb + cb * cb);
+            sb /= s;
+            cb /= s;
+        }
+        s = sqrt(num * num + den * den);
+        sp = num / s;
+        cp = den / s;
+        hgt[i] = p * cp + z[i] * sp - a * sqrt(1.0 - e2 * sp * sp);
+        lat[i] = num;
+        lon[i] = den;
+    }
+    FOR_POINTS
+    for (i = 0; i < m; i++) {
+        lat[i] = atan2(lat[i], lon[i]) * R2D;
+        lon[i] = atan2(y[i], x[i]) * R2D;
+    }
+    /* points with NaN (all NaN) and points on z-axis (same as ecef2pos) */
+    for (i = 0; i < m; i++) {
+        if (isnan(x[i]) || isnan(y[i]) || isnan(z[i])) {
+            lat[i] = lon[i] = hgt[i] = NAN;
+            continue;
+        }
+        if (!(x[i] * x[i] + y[i] * y[i] <= 1E-12)) continue;
+        r[0] = x[i];
+        r[1] = y[i];
+        r[2] = z[i];
+        ecef2pos(r, l);
+        lat[i] = l[0] * R2D;
+        lon[i] = l[1] * R2D;
+        hgt[i] = l[2];
+    }
+}
+/* geodetic position to ecef ------------------------------------------*/
+extern void pos2ecefv(const double *llh, const int m, double *xyz) {
+    const double *lat = llh, *lon = llh + m, *hgt = llh + 2 * m;
+    const double e2 = FE_WGS84 * (2.0 - FE_WGS84);
+    double *x = xyz, *y = xyz + m, *z = xyz + 2 * m;
+    int i;
+
+    FOR_POINTS
+    for (i = 0; i < m; i++) {
+        double sinp = sin(lat[i] * D2R), cosp = cos(lat[i] * D2R);
+        double sinl = sin(lon[i] * D2R), cosl = cos(lon[i] * D2R);
+        double v = RE_WGS84 / sqrt(1.0 - e2 * sinp * sinp);
+
+        x[i] = (v + hgt[i]) * cosp * cosl;
+        y[i] = (v + hgt[i]) * cosp * sinl;
+        z[i] = (v * (1.0 - e2) + hgt[i]) * sinp;
+    }
+}
+/* ecef to local coordinate (enu=E*(xyz-org)) -------------------------*/
+/* E is ecef to enu matrix by xyz2enu, org can be NULL                  */
+extern void ecef2enuv(const double *E, const double *org, const double *xyz,
+                      const int m, double *enu) {
+    const double *x = xyz, *y = xyz + m, *z = xyz + 2 * m;
+    const double o0 = org ? org[0] : 0.0, o1 = org ? org[1] : 0.0,
+                 o2 = org ? org[2] : 0.0;
+    double *e = enu, *n = enu + m, *u = enu + 2 * m;
+    int i;
+
+    FOR_POINTS
+    for (i = 0; i < m; i++) {
+        double dx = x[i] - o0, dy = y[i] - o1, dz = z[i] - o2;
+
+        e[i] = E[0] * dx + E[3] * dy + E[6] * dz;
+        n[i] = E[1] * dx + E[4] * dy + E[7] * dz;
+        u[i] = E[2] * dx + E[5] * dy + E[8] * dz;
+    }
+}
+/* local coordinate to ecef (xyz=E'*enu+org) --------------------------*/
+/* E is ecef to enu matrix by xyz2enu, org can be NULL                  */
+extern void enu2ecefv(const double *E, const double *org, const double *enu,
+                      const int m, double *xyz) {
+    const double *e = enu, *n = enu + m, *u = enu + 2 * m;
+    const double o0 = org ? org[0] : 0.0, o1 = org ? org[1] : 0.0,
+                 o2 = org ? org[2] : 0.0;
+    double *x = xyz, *y = xyz + m, *z = xyz + 2 * m;
+    int i;
+
+    FOR_POINTS
+    for (i = 0; i < m; i++) {
+        x[i] = E[0] * e[i] + E[1] * n[i] + E[2] * u[i] + o0;
+        y[i] = E[3] * e[i] + E[4] * n[i] + E[5] * u[i] + o1;
+        z[i] = E[6] * e[i] + E[7] * n[i] + E[8] * u[i] + o2;
+    }
+}
@@ -0,0 +1,239 @@
+/**
+ * @file core.c
+ * @brief Dispatcher of RTKLIB wrappers with resident state
+ * @author Taro Suzuki
+ * @note New development function
+ * @note core(command, ...) calls the wrapper of command in one mex file
+ * @note core is locked in memory by mexLock and owns navigation data
+ * handles, geoid/datum models, PCV tables and thread setting between calls
+ * @note Navigation data handles created by core are registered to core in the
+ * registry (registry.c), "free" and exit free them and invalidate their ids,
+ * so that later use of the handles raises an error
+ */
+
+#include "mex_utility.h"
+
+/* wrappers compiled in dispatcher ------------------------------------*/
+#define mexFunction mex_navload
+#include "navload.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_navfree
+#include "navfree.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_readrnxnav
+#include "readrnxnav.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_readrnxnavs
+#include "readrnxnavs.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_readrnxobs
+#include "readrnxobs.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_satpos
+#include "satpos.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_satposs
+#include "satposs.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_peph2pos
+#include "peph2pos.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_pntpos
+#include "pntpos_.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_rtkpos
+#include "rtkpos_.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_pppos
+#include "pppos.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_postpos
+#include "postpos_.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_geoidh
+#include "geoidh.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_tokyo2jgd
+#include "tokyo2jgd.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_jgd2tokyo
+#include "jgd2tokyo.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_searchpcv
+#include "searchpcv.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_perfstats
+#include "perfstats.c"
+#undef mexFunction
+#undef NIN
+#define mexFunction mex_satcache
+#include "satcache_.c"
+#undef mexFunction
+#undef NIN
+
+typedef void mexfunc_t(int, mxArray *[], int, const mxArray *[]);
+
+/* command table */
+typedef struct {
+    const char *name; /* command name */
+    mexfunc_t *func;  /* wrapper function */
+} corecmd_t;
+
+/* resident state */
+static int geoid = 0;   /* geoid model opened by "geoid" command */
+static int nthread = 0; /* threads set by "nthread" command (0: default) */
+static int locked = 0;
+
+static const corecmd_t cmds[] = {
+    {"navload", mex_navload},       {"navfree", mex_navfree},
+    {"readrnxnav", mex_readrnxnav}, {"readrnxnavs", mex_readrnxnavs},
+    {"readrnxobs", mex_readrnxobs}, {"satpos", mex_satpos},
+    {"satposs", mex_satposs},       {"peph2pos", mex_peph2pos},
+    {"pntpos", mex_pntpos},         {"rtkpos", mex_rtkpos},
+    {"pppos", mex_pppos},           {"postpos", mex_postpos},
+    {"geoidh", mex_geoidh},         {"tokyo2jgd", mex_tokyo2jgd},
+    {"jgd2tokyo", mex_jgd2tokyo},   {"searchpcv", mex_searchpcv},
+    {"perfstats", mex_perfstats},   {"satcache", mex_satcache}};
+
+/* register navigation data handle to core ---------------------------*/
+static void ownnavh(const mxArray *mx) {
+    if (mx && mxisnavh(mx)) {
+        regsetowner(REG_NAV, *(uint64_t *)mxGetData(mx), cmds);
+    }
+}
+/* free all resident state --------------------------------------------*/
+static void freestate(void) {
+    freenavhs(cmds);
+    freeppphs(); /* PPP sessions opened by core (pppos.c) */
+    satcachefree();
+    freepcvindex();
+    if (geoid) closegeoid();
+    geoid = 0;
+    freegeoidmap();
+}
+/* resident state status ----------------------------------------------*/
+static mxArray *corestatus(void) {
+    const char *f[] = {"locked", "nnavh", "npcv", "geoid", "nthread",
+                       "commands"};
+    mxArray *mx, *mxcmds;
+    int i, n = (int)(sizeof(cmds) / sizeof(cmds[0]));
+
+    mx = mxCreateStructMatrix(1, 1, 6, f);
+    mxSetField(mx, 0, "locked", mxCreateDoubleScalar(locked));
+    mxSetField(mx, 0, "nnavh", mxCreateDoubleScalar(regnum(REG_NAV, cmds)));
+    mxSetField(mx, 0, "npcv", mxCreateDoubleScalar(npcvindex()));
+    mxSetField(mx, 0, "geoid", mxCreateDoubleScalar(geoid));
+    mxSetField(mx, 0, "nthread",
+               mxCreateDoubleScalar(nthread > 0 ? nthread
+                                                : mxGetNumThreads(0, NULL, 0)));
+    mxcmds = mxCreateCellMatrix(1, n);
+    for (i = 0; i < n; i++) {
+        mxSetCell(mxcmds, i, mxCreateString(cmds[i].name));
+    }
+    mxSetField(mx, 0, "commands", mxcmds);
+    return mx;
+}
+/* resident state commands --------------------------------------------*/
+static int corestate(const char *cmd, int nargout, mxArray *argout[],
+                     int nargin, const mxArray *argin[]) {
+    const pcvidx_t *idx;
+    char file[512], errmsg[600];
+    int model;
+
+    if (!strcmp(cmd, "readpcv")) { /* PCV table is parsed once per file */
+        mxCheckNumberOfArguments(nargin, 1);
+        mxCheckChar(argin[0]);
+        mxGetString(argin[0], file, sizeof(file));
+        if (!(idx = pcvindex(file))) {
+            sprintf(errmsg, "readpcv: Invalid PCV file: %s", file);
+            mexErrMsgTxt(errmsg);
+        }
+        argout[0] = pcv2mxpcv(idx->pcvs.pcv, idx->pcvs.n);
+    } else if (!strcmp(cmd, "geoid")) { /* open geoid model until closed */
+        mxCheckNumberOfArguments(nargin, 2);
+        mxCheckScalar(argin[0]);
+        mxCheckChar(argin[1]);
+        model = (int)mxGetScalar(argin[0]);
+        mxGetString(argin[1], file, sizeof(file));
+        if (geoid) closegeoid();
+        if (!(geoid = opengeoid(model, file))) {
+            sprintf(errmsg, "geoid model file open error: %s", file);
+            mexErrMsgTxt(errmsg);
+        }
+    } else if (!strcmp(cmd, "geoidclose")) {
+        if (geoid) closegeoid();
+        geoid = 0;
+    } else if (!strcmp(cmd, "nthread")) { /* default threads of wrappers */
+        mxCheckNumberOfArguments(nargin, 1);
+        mxCheckScalar(argin[0]);
+        if ((int)mxGetScalar(argin[0]) < 1) {
+            mexErrMsgTxt("Number of threads must be positive");
+        }
+#ifdef _OPENMP
+        nthread = (int)mxGetScalar(argin[0]);
+        omp_set_num_threads(nthread);
+#else
+        nthread = 1; /* always 1 without OpenMP */
+#endif
+    } else if (!strcmp(cmd, "status")) {
+        argout[0] = corestatus();
+    } else if (!strcmp(cmd, "free")) { /* free resident state */
+        freestate();
+    } else if (!strcmp(cmd, "unlock")) { /* allow "clear" to unload core */
+        if (locked) mexUnlock();
+        locked = 0;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+/* exit function ------------------------------------------------------*/
+static void coreexit(void) { freestate(); }
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    char cmd[32], errmsg[64];
+    int i, n = (int)(sizeof(cmds) / sizeof(cmds[0]));
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, 1);
+    mxCheckChar(argin[0]); /* command */
+    mxGetString(argin[0], cmd, sizeof(cmd));
+
+    /* keep resident state until "unlock" */
+    if (!locked) {
+        mexLock();
+        mexAtExit(coreexit);
+        locked = 1;
+    }
+    if (corestate(cmd, nargout, argout, nargin - 1, argin + 1)) return;
+
+    for (i = 0; i < n; i++) {
+        if (strcmp(cmd, cmds[i].name)) continue;
+
+        cmds[i].func(nargout, argout, nargin - 1, argin + 1);
+        if (cmds[i].func == mex_navload || cmds[i].func == mex_readrnxnavs) {
+            ownnavh(argout[0]);
+        }
+        return;
+    }
+    sprintf(errmsg, "core: unknown command: %.32s", cmd);
+    mexErrMsgTxt(errmsg);
+}
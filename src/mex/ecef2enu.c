@@ -5,7 +5,7 @@
  * @note Wrapper for "ecef2enu" in rtkcmn.c
  * @note Change input unit from radian to degree
  * @note Output transformation matrix
- * @note Support vector inputs
+ * @note Support vector inputs (batch transformation in coord.c)
  */
 
 #include "mex_utility.h"
@@ -16,8 +16,8 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     mwSize dims[3] = {3, 3, 0};
-    int i, j, m;
-    double x[3], e[3], o[3], Et[9], *orgllh, *ecef, *enu, *E;
+    int m;
+    double o[3], Et[9], *orgllh, *ecef, *enu, *E;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -42,14 +42,6 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     xyz2enu(o, Et);
     transpose_mw(Et, dims, E); /* transpose, ecef -> enu */
 
-    /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        x[0] = ecef[i + m * 0];
-        x[1] = ecef[i + m * 1];
-        x[2] = ecef[i + m * 2];
-        ecef2enu(o, x, e);
-        enu[i + m * 0] = e[0];
-        enu[i + m * 1] = e[1];
-        enu[i + m * 2] = e[2];
-    }
+    /* call RTKLIB function (batch) */
+    ecef2enuv(Et, NULL, ecef, m, enu);
 }
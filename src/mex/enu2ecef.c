@@ -5,7 +5,7 @@
  * @note Wrapper for "enu2ecef" in rtkcmn.c
  * @note Change input unit from radian to degree
  * @note Output transformation matrix
- * @note Support vector inputs
+ * @note Support vector inputs (batch transformation in coord.c)
  */
 
 #include "mex_utility.h"
@@ -15,8 +15,8 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    int i, j, m;
-    double e[3], x[3], o[3], *orgllh, *ecef, *enu, *E;
+    int m;
+    double o[3], *orgllh, *ecef, *enu, *E;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -40,14 +40,6 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
 
     xyz2enu(o, E); /* enu -> ecef */
 
-    /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        e[0] = enu[i + m * 0];
-        e[1] = enu[i + m * 1];
-        e[2] = enu[i + m * 2];
-        enu2ecef(o, e, x);
-        ecef[i + m * 0] = x[0];
-        ecef[i + m * 1] = x[1];
-        ecef[i + m * 2] = x[2];
-    }
+    /* call RTKLIB function (batch) */
+    enu2ecefv(E, NULL, enu, m, ecef);
 }
@@ -4,7 +4,7 @@
  * @author Taro Suzuki
  * @note Input unit from radian to degree
  * @note Output transformation matrix
- * @note Support vector inputs
+ * @note Support vector inputs (batch transformation in coord.c)
  */
 
 #include "mex_utility.h"
@@ -14,8 +14,8 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    int i, j, m;
-    double e[3], x[3], l[3], o[3], orgxyz[3], *orgllh, *llh, *enu, *E;
+    int m;
+    double o[3], orgxyz[3], *orgllh, *llh, *enu, *E, *xyz;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -40,22 +40,11 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     pos2ecef(o, orgxyz);
     xyz2enu(o, E); /* enu -> ecef */
 
-    /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        e[0] = enu[i + m * 0];
-        e[1] = enu[i + m * 1];
-        e[2] = enu[i + m * 2];
-        if (mxIsNaN(e[0]) || mxIsNaN(e[1]) || mxIsNaN(e[2])) {
-            llh[i + m * 0] = llh[i + m * 1] = llh[i + m * 2] = mxGetNaN();
-            continue;
-        }
-        enu2ecef(o, e, x);
-        x[0] += orgxyz[0];
-        x[1] += orgxyz[1];
-        x[2] += orgxyz[2];
-        ecef2pos(x, l);
-        llh[i + m * 0] = l[0] * R2D;
-        llh[i + m * 1] = l[1] * R2D;
-        llh[i + m * 2] = l[2];
+    /* call RTKLIB function (batch, NaN for NaN input) */
+    if (!(xyz = (double *)malloc(sizeof(double) * 3 * m + 1))) {
+        mexErrMsgTxt("enu2llh: memory allocation error");
     }
+    enu2ecefv(E, orgxyz, enu, m, xyz);
+    ecef2posv(xyz, m, llh);
+    free(xyz);
 }
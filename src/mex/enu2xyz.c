@@ -3,7 +3,7 @@
  * @brief Transform local tangential coordinate to ECEF coordinate
  * @author Taro Suzuki
  * @note Output transformation matrix
- * @note Support vector inputs
+ * @note Support vector inputs (batch transformation in coord.c)
  */
 
 #include "mex_utility.h"
@@ -13,8 +13,8 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    int i, j, m;
-    double e[3], x[3], o[3], oxyz[3], *orgllh, *xyz, *enu, *E;
+    int m;
+    double o[3], oxyz[3], *orgllh, *xyz, *enu, *E;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -39,14 +39,6 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     pos2ecef(o, oxyz);
     xyz2enu(o, E); /* enu -> ecef */
 
-    /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        e[0] = enu[i + m * 0];
-        e[1] = enu[i + m * 1];
-        e[2] = enu[i + m * 2];
-        enu2ecef(o, e, x);
-        xyz[i + m * 0] = x[0] + oxyz[0];
-        xyz[i + m * 1] = x[1] + oxyz[1];
-        xyz[i + m * 2] = x[2] + oxyz[2];
-    }
+    /* call RTKLIB function (batch) */
+    enu2ecefv(E, oxyz, enu, m, xyz);
 }
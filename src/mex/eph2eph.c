@@ -3,10 +3,75 @@
  * @brief Convert mxArray mxeph/mxgeph/mxpeph to eph_t/geph_t/peph_t, and vice
  * versa
  * @author Taro Suzuki
+ * @note Columnar ephemeris is 1x1 struct with one vector/matrix per field
+ * (Nx1 scalar fields, Nx6 epochs). It is accepted by all mx*2* functions.
  */
 
+#include <stddef.h>
+
 #include "mex_utility.h"
 
+/* create column field of columnar struct -----------------------------*/
+static double *setcol(mxArray *mxs, const char *field, const int m,
+                      const int n) {
+    mxArray *mx = mxCreateDoubleMatrix(m, n, mxREAL);
+    mxSetField(mxs, 0, field, mx);
+    return mxGetPr(mx);
+}
+/* get column field of columnar struct --------------------------------*/
+/* field must be m x n (x k) double array (empty if no record)           */
+static const double *getcol(const mxArray *mxs, const char *field,
+                            const int m, const int n, const int k) {
+    const mxArray *mx = mxGetField(mxs, 0, field);
+    const mwSize *dims;
+    mwSize nd;
+    char msg[512];
+
+    if (mx && mxIsDouble(mx)) {
+        nd = mxGetNumberOfDimensions(mx);
+        dims = mxGetDimensions(mx);
+        if (mxIsEmpty(mx) && m * n * k == 0) return mxGetPr(mx);
+        if (nd <= 3 && (int)dims[0] == m && (int)dims[1] == n &&
+            (nd < 3 ? 1 : (int)dims[2]) == k) {
+            return mxGetPr(mx);
+        }
+    }
+    sprintf(msg, "Wrong size of columnar ephemeris field: %s (%dx%dx%d)",
+            field, m, n, k);
+    mexErrMsgTxt(msg);
+    return NULL;
+}
+/* set epoch to i-th row of Nx6 matrix --------------------------------*/
+static void setepoch(double *p, const int n, const int i, gtime_t t) {
+    double ep[6];
+    int k;
+    time2epoch(t, ep);
+    for (k = 0; k < 6; k++) p[i + n * k] = ep[k];
+}
+/* get epoch from i-th row of Nx6 matrix ------------------------------*/
+static gtime_t getepoch(const double *p, const int n, const int i) {
+    double ep[6];
+    int k;
+    for (k = 0; k < 6; k++) ep[k] = p[i + n * k];
+    return epoch2time(ep);
+}
+static void mxephc2eph(const mxArray *mxeph, const int n, eph_t *eph);
+static void mxgephc2geph(const mxArray *mxgeph, const int n, geph_t *geph);
+static void mxpephc2peph(const mxArray *mxpeph, const int n, peph_t *peph);
+static void mxpclkc2pclk(const mxArray *mxpclk, const int n, pclk_t *pclk);
+
+/* number of records in struct array or columnar struct ---------------*/
+extern int mxgetnrec(const mxArray *mxs, const char *field) {
+    const mxArray *mx;
+
+    if (mxGetNumberOfElements(mxs) != 1) {
+        return (int)mxGetNumberOfElements(mxs);
+    }
+    /* 1x1 struct array is same as columnar struct with 1 record */
+    if (!(mx = mxGetField(mxs, 0, field))) return 0;
+    return (int)mxGetM(mx);
+}
+
 /* eph2mxeph ----------------------------------------------------------*/
 extern mxArray *eph2mxeph(const eph_t *eph, const int n) {
     int i;
@@ -141,6 +206,12 @@ extern void mxeph2eph(const mxArray *mxeph, const int n, eph_t *eph) {
     /* check eph struct */
     mxCheckStruct(mxeph, ephf, 34);
 
+    /* columnar struct */
+    if (mxGetNumberOfElements(mxeph) == 1) {
+        mxephc2eph(mxeph, n, eph);
+        return;
+    }
+
     for (i = 0; i < n; i++) {
         eph[i].sat = (int)mxGetScalar(mxGetField(mxeph, i, "sat"));
         eph[i].iode = (int)mxGetScalar(mxGetField(mxeph, i, "iode"));
@@ -189,6 +260,12 @@ extern void mxgeph2geph(const mxArray *mxgeph, const int n, geph_t *geph) {
     /* check geph struct */
     mxCheckStruct(mxgeph, gephf, 14);
 
+    /* columnar struct */
+    if (mxGetNumberOfElements(mxgeph) == 1) {
+        mxgephc2geph(mxgeph, n, geph);
+        return;
+    }
+
     for (i = 0; i < n; i++) {
         geph[i].sat = (int)mxGetScalar(mxGetField(mxgeph, i, "sat"));
         geph[i].iode = (int)mxGetScalar(mxGetField(mxgeph, i, "iode"));
@@ -281,6 +358,12 @@ extern void mxpeph2peph(const mxArray *mxpeph, const int n, peph_t *peph) {
     /* check peph struct */
     mxCheckStruct(mxpeph, pephf, 8);
 
+    /* columnar struct */
+    if (mxGetNumberOfElements(mxpeph) == 1) {
+        mxpephc2peph(mxpeph, n, peph);
+        return;
+    }
+
     for (i = 0; i < n; i++) {
         peph[i].time =
             epoch2time((double *)mxGetPr(mxGetField(mxpeph, i, "time")));
@@ -355,6 +438,12 @@ extern void mxpclk2pclk(const mxArray *mxpclk, const int n, pclk_t *pclk) {
     /* check pclk struct */
     mxCheckStruct(mxpclk, pclkf, 4);
 
+    /* columnar struct */
+    if (mxGetNumberOfElements(mxpclk) == 1) {
+        mxpclkc2pclk(mxpclk, n, pclk);
+        return;
+    }
+
     for (i = 0; i < n; i++) {
         pclk[i].time =
             epoch2time((double *)mxGetPr(mxGetField(mxpclk, i, "time")));
@@ -369,3 +458,311 @@ extern void mxpclk2pclk(const mxArray *mxpclk, const int n, pclk_t *pclk) {
         }
     }
 }
+
+/* columnar ephemeris fields ------------------------------------------*/
+typedef struct {
+    const char *name; /* field name */
+    size_t off;       /* offset in struct */
+} colf_t;
+
+static const colf_t EPHI[] = {
+    {"sat", offsetof(eph_t, sat)},   {"iode", offsetof(eph_t, iode)},
+    {"iodc", offsetof(eph_t, iodc)}, {"sva", offsetof(eph_t, sva)},
+    {"svh", offsetof(eph_t, svh)},   {"week", offsetof(eph_t, week)},
+    {"code", offsetof(eph_t, code)}, {"flag", offsetof(eph_t, flag)}};
+static const colf_t EPHD[] = {
+    {"A", offsetof(eph_t, A)},       {"e", offsetof(eph_t, e)},
+    {"i0", offsetof(eph_t, i0)},     {"OMG0", offsetof(eph_t, OMG0)},
+    {"omg", offsetof(eph_t, omg)},   {"M0", offsetof(eph_t, M0)},
+    {"deln", offsetof(eph_t, deln)}, {"OMGd", offsetof(eph_t, OMGd)},
+    {"idot", offsetof(eph_t, idot)}, {"crc", offsetof(eph_t, crc)},
+    {"crs", offsetof(eph_t, crs)},   {"cuc", offsetof(eph_t, cuc)},
+    {"cus", offsetof(eph_t, cus)},   {"cic", offsetof(eph_t, cic)},
+    {"cis", offsetof(eph_t, cis)},   {"toes", offsetof(eph_t, toes)},
+    {"fit", offsetof(eph_t, fit)},   {"f0", offsetof(eph_t, f0)},
+    {"f1", offsetof(eph_t, f1)},     {"f2", offsetof(eph_t, f2)},
+    {"Adot", offsetof(eph_t, Adot)}, {"ndot", offsetof(eph_t, ndot)}};
+static const colf_t GEPHI[] = {
+    {"sat", offsetof(geph_t, sat)}, {"iode", offsetof(geph_t, iode)},
+    {"frq", offsetof(geph_t, frq)}, {"svh", offsetof(geph_t, svh)},
+    {"sva", offsetof(geph_t, sva)}, {"age", offsetof(geph_t, age)}};
+static const colf_t GEPHD[] = {{"taun", offsetof(geph_t, taun)},
+                               {"gamn", offsetof(geph_t, gamn)},
+                               {"dtaun", offsetof(geph_t, dtaun)}};
+static const colf_t GEPHV[] = {{"pos", offsetof(geph_t, pos)},
+                               {"vel", offsetof(geph_t, vel)},
+                               {"acc", offsetof(geph_t, acc)}};
+
+#define NCOLF(f) ((int)(sizeof(f) / sizeof(colf_t)))
+#define COLI(p, f) (*(int *)((char *)(p) + (f).off))
+#define COLD(p, f) (*(double *)((char *)(p) + (f).off))
+
+/* eph2mxephc ---------------------------------------------------------*/
+extern mxArray *eph2mxephc(const eph_t *eph, const int n) {
+    int i, j, k;
+    double *p, *toe, *toc, *ttr, *tgd;
+    mxArray *mxeph;
+
+    /* output struct (same fields as eph2mxeph) */
+    const char *ephf[] = {
+        "sat",  "iode", "iodc", "sva", "svh", "week", "code", "flag", "toe",
+        "toc",  "ttr",  "A",    "e",   "i0",  "OMG0", "omg",  "M0",   "deln",
+        "OMGd", "idot", "crc",  "crs", "cuc", "cus",  "cic",  "cis",  "toes",
+        "fit",  "f0",   "f1",   "f2",  "tgd", "Adot", "ndot"};
+
+    mxeph = mxCreateStructMatrix(1, 1, 34, ephf);
+
+    for (j = 0; j < NCOLF(EPHI); j++) {
+        p = setcol(mxeph, EPHI[j].name, n, 1);
+        for (i = 0; i < n; i++) p[i] = COLI(eph + i, EPHI[j]);
+    }
+    for (j = 0; j < NCOLF(EPHD); j++) {
+        p = setcol(mxeph, EPHD[j].name, n, 1);
+        for (i = 0; i < n; i++) p[i] = COLD(eph + i, EPHD[j]);
+    }
+    toe = setcol(mxeph, "toe", n, 6);
+    toc = setcol(mxeph, "toc", n, 6);
+    ttr = setcol(mxeph, "ttr", n, 6);
+    tgd = setcol(mxeph, "tgd", n, 4);
+    for (i = 0; i < n; i++) {
+        setepoch(toe, n, i, eph[i].toe);
+        setepoch(toc, n, i, eph[i].toc);
+        setepoch(ttr, n, i, eph[i].ttr);
+        for (k = 0; k < 4; k++) tgd[i + n * k] = eph[i].tgd[k];
+    }
+    return mxeph;
+}
+
+/* mxephc2eph ---------------------------------------------------------*/
+static void mxephc2eph(const mxArray *mxeph, const int n, eph_t *eph) {
+    int i, j, k;
+    const double *p, *toe, *toc, *ttr, *tgd;
+
+    for (j = 0; j < NCOLF(EPHI); j++) {
+        p = getcol(mxeph, EPHI[j].name, n, 1, 1);
+        for (i = 0; i < n; i++) COLI(eph + i, EPHI[j]) = (int)p[i];
+    }
+    for (j = 0; j < NCOLF(EPHD); j++) {
+        p = getcol(mxeph, EPHD[j].name, n, 1, 1);
+        for (i = 0; i < n; i++) COLD(eph + i, EPHD[j]) = p[i];
+    }
+    toe = getcol(mxeph, "toe", n, 6, 1);
+    toc = getcol(mxeph, "toc", n, 6, 1);
+    ttr = getcol(mxeph, "ttr", n, 6, 1);
+    tgd = getcol(mxeph, "tgd", n, 4, 1);
+    for (i = 0; i < n; i++) {
+        eph[i].toe = getepoch(toe, n, i);
+        eph[i].toc = getepoch(toc, n, i);
+        eph[i].ttr = getepoch(ttr, n, i);
+        for (k = 0; k < 4; k++) eph[i].tgd[k] = tgd[i + n * k];
+    }
+}
+
+/* geph2mxgephc -------------------------------------------------------*/
+extern mxArray *geph2mxgephc(const geph_t *geph, const int n) {
+    int i, j, k;
+    double *p, *toe, *tof;
+    mxArray *mxgeph;
+
+    /* output struct (same fields as geph2mxgeph) */
+    const char *gephf[] = {"sat", "iode", "frq",  "svh",  "sva",
+                           "age", "toe",  "tof",  "pos",  "vel",
+                           "acc", "taun", "gamn", "dtaun"};
+
+    mxgeph = mxCreateStructMatrix(1, 1, 14, gephf);
+
+    for (j = 0; j < NCOLF(GEPHI); j++) {
+        p = setcol(mxgeph, GEPHI[j].name, n, 1);
+        for (i = 0; i < n; i++) p[i] = COLI(geph + i, GEPHI[j]);
+    }
+    for (j = 0; j < NCOLF(GEPHD); j++) {
+        p = setcol(mxgeph, GEPHD[j].name, n, 1);
+        for (i = 0; i < n; i++) p[i] = COLD(geph + i, GEPHD[j]);
+    }
+    for (j = 0; j < NCOLF(GEPHV); j++) {
+        p = setcol(mxgeph, GEPHV[j].name, n, 3);
+        for (i = 0; i < n; i++) {
+            for (k = 0; k < 3; k++) {
+                p[i + n * k] = (&COLD(geph + i, GEPHV[j]))[k];
+            }
+        }
+    }
+    toe = setcol(mxgeph, "toe", n, 6);
+    tof = setcol(mxgeph, "tof", n, 6);
+    for (i = 0; i < n; i++) {
+        setepoch(toe, n, i, geph[i].toe);
+        setepoch(tof, n, i, geph[i].tof);
+    }
+    return mxgeph;
+}
+
+/* mxgephc2geph -------------------------------------------------------*/
+static void mxgephc2geph(const mxArray *mxgeph, const int n, geph_t *geph) {
+    int i, j, k;
+    const double *p, *toe, *tof;
+
+    for (j = 0; j < NCOLF(GEPHI); j++) {
+        p = getcol(mxgeph, GEPHI[j].name, n, 1, 1);
+        for (i = 0; i < n; i++) COLI(geph + i, GEPHI[j]) = (int)p[i];
+    }
+    for (j = 0; j < NCOLF(GEPHD); j++) {
+        p = getcol(mxgeph, GEPHD[j].name, n, 1, 1);
+        for (i = 0; i < n; i++) COLD(geph + i, GEPHD[j]) = p[i];
+    }
+    for (j = 0; j < NCOLF(GEPHV); j++) {
+        p = getcol(mxgeph, GEPHV[j].name, n, 3, 1);
+        for (i = 0; i < n; i++) {
+            for (k = 0; k < 3; k++) {
+                (&COLD(geph + i, GEPHV[j]))[k] = p[i + n * k];
+            }
+        }
+    }
+    toe = getcol(mxgeph, "toe", n, 6, 1);
+    tof = getcol(mxgeph, "tof", n, 6, 1);
+    for (i = 0; i < n; i++) {
+        geph[i].toe = getepoch(toe, n, i);
+        geph[i].tof = getepoch(tof, n, i);
+    }
+}
+
+/* peph2mxpephc -------------------------------------------------------*/
+extern mxArray *peph2mxpephc(const peph_t *peph, const int n) {
+    int i, j, k;
+    double *time, *index, *pos, *std, *vel, *vst, *cov, *vco;
+    mwSize dims4[3] = {MAXSAT, 4, 0}, dims3[3] = {MAXSAT, 3, 0};
+    mxArray *mxpeph, *mx[6];
+
+    /* output struct (same fields as peph2mxpeph) */
+    const char *pephf[] = {"time", "index", "pos", "std",
+                           "vel",  "vst",   "cov", "vco"};
+
+    mxpeph = mxCreateStructMatrix(1, 1, 8, pephf);
+
+    time = setcol(mxpeph, "time", n, 6);
+    index = setcol(mxpeph, "index", n, 1);
+
+    /* MAXSATx4xN/MAXSATx3xN arrays, each page is same as peph2mxpeph */
+    dims4[2] = dims3[2] = (mwSize)n;
+    for (k = 0; k < 6; k++) {
+        mx[k] = mxCreateNumericArray(3, k < 4 ? dims4 : dims3, mxDOUBLE_CLASS,
+                                     mxREAL);
+        mxSetField(mxpeph, 0, pephf[k + 2], mx[k]);
+    }
+    pos = mxGetPr(mx[0]);
+    std = mxGetPr(mx[1]);
+    vel = mxGetPr(mx[2]);
+    vst = mxGetPr(mx[3]);
+    cov = mxGetPr(mx[4]);
+    vco = mxGetPr(mx[5]);
+
+    for (i = 0; i < n; i++) {
+        setepoch(time, n, i, peph[i].time);
+        index[i] = peph[i].index;
+
+        for (j = 0; j < MAXSAT; j++) {
+            for (k = 0; k < 4; k++) {
+                pos[MAXSAT * k + j] = peph[i].pos[j][k];
+                std[MAXSAT * k + j] = (double)peph[i].std[j][k];
+                vel[MAXSAT * k + j] = peph[i].vel[j][k];
+                vst[MAXSAT * k + j] = (double)peph[i].vst[j][k];
+            }
+            for (k = 0; k < 3; k++) {
+                cov[MAXSAT * k + j] = (double)peph[i].cov[j][k];
+                vco[MAXSAT * k + j] = (double)peph[i].vco[j][k];
+            }
+        }
+        pos += MAXSAT * 4;
+        std += MAXSAT * 4;
+        vel += MAXSAT * 4;
+        vst += MAXSAT * 4;
+        cov += MAXSAT * 3;
+        vco += MAXSAT * 3;
+    }
+    return mxpeph;
+}
+
+/* mxpephc2peph -------------------------------------------------------*/
+static void mxpephc2peph(const mxArray *mxpeph, const int n, peph_t *peph) {
+    int i, j, k;
+    const double *time, *index, *pos, *std, *vel, *vst, *cov, *vco;
+
+    time = getcol(mxpeph, "time", n, 6, 1);
+    index = getcol(mxpeph, "index", n, 1, 1);
+    pos = getcol(mxpeph, "pos", MAXSAT, 4, n);
+    std = getcol(mxpeph, "std", MAXSAT, 4, n);
+    vel = getcol(mxpeph, "vel", MAXSAT, 4, n);
+    vst = getcol(mxpeph, "vst", MAXSAT, 4, n);
+    cov = getcol(mxpeph, "cov", MAXSAT, 3, n);
+    vco = getcol(mxpeph, "vco", MAXSAT, 3, n);
+
+    for (i = 0; i < n; i++) {
+        peph[i].time = getepoch(time, n, i);
+        peph[i].index = (int)index[i];
+
+        for (j = 0; j < MAXSAT; j++) {
+            for (k = 0; k < 4; k++) {
+                peph[i].pos[j][k] = pos[MAXSAT * k + j];
+                peph[i].std[j][k] = (float)std[MAXSAT * k + j];
+                peph[i].vel[j][k] = vel[MAXSAT * k + j];
+                peph[i].vst[j][k] = (float)vst[MAXSAT * k + j];
+            }
+            for (k = 0; k < 3; k++) {
+                peph[i].cov[j][k] = (float)cov[MAXSAT * k + j];
+                peph[i].vco[j][k] = (float)vco[MAXSAT * k + j];
+            }
+        }
+        pos += MAXSAT * 4;
+        std += MAXSAT * 4;
+        vel += MAXSAT * 4;
+        vst += MAXSAT * 4;
+        cov += MAXSAT * 3;
+        vco += MAXSAT * 3;
+    }
+}
+
+/* pclk2mxpclkc -------------------------------------------------------*/
+extern mxArray *pclk2mxpclkc(const pclk_t *pclk, const int n) {
+    int i, j;
+    double *time, *index, *clk, *std;
+    mxArray *mxpclk;
+
+    /* output struct (same fields as pclk2mxpclk) */
+    const char *pclkf[] = {"time", "index", "clk", "std"};
+
+    mxpclk = mxCreateStructMatrix(1, 1, 4, pclkf);
+
+    time = setcol(mxpclk, "time", n, 6);
+    index = setcol(mxpclk, "index", n, 1);
+    clk = setcol(mxpclk, "clk", n, MAXSAT);
+    std = setcol(mxpclk, "std", n, MAXSAT);
+
+    for (i = 0; i < n; i++) {
+        setepoch(time, n, i, pclk[i].time);
+        index[i] = pclk[i].index;
+        for (j = 0; j < MAXSAT; j++) {
+            clk[i + n * j] = pclk[i].clk[j][0];
+            std[i + n * j] = (double)pclk[i].std[j][0];
+        }
+    }
+    return mxpclk;
+}
+
+/* mxpclkc2pclk -------------------------------------------------------*/
+static void mxpclkc2pclk(const mxArray *mxpclk, const int n, pclk_t *pclk) {
+    int i, j;
+    const double *time, *index, *clk, *std;
+
+    time = getcol(mxpclk, "time", n, 6, 1);
+    index = getcol(mxpclk, "index", n, 1, 1);
+    clk = getcol(mxpclk, "clk", n, MAXSAT, 1);
+    std = getcol(mxpclk, "std", n, MAXSAT, 1);
+
+    for (i = 0; i < n; i++) {
+        pclk[i].time = getepoch(time, n, i);
+        pclk[i].index = (int)index[i];
+        for (j = 0; j < MAXSAT; j++) {
+            pclk[i].clk[j][0] = clk[i + n * j];
+            pclk[i].std[j][0] = (float)std[i + n * j];
+        }
+    }
+}
@@ -0,0 +1,246 @@
+/**
+ * @file ephidx.c
+ * @brief Per-satellite index of broadcast ephemerides
+ * @author Taro Suzuki
+ * @note Ephemerides of each satellite are sorted by toe once, and navigation
+ * data views containing only ephemerides near an epoch are passed to RTKLIB
+ * functions instead of all ephemerides (seleph/selgeph scan all records)
+ * @note Records in view are in the same order as nav->eph/geph and include
+ * all records within the max age of ephemeris, so that ephemerides selected
+ * by seleph/selgeph (including IODE matching) are the same as all records
+ */
+
+#include "mex_utility.h"
+
+#define DTOEMARGIN 600.0 /* margin of ephemeris window (s) */
+
+/* ephemeris record in index */
+typedef struct {
+    double toe; /* toe (s from t0) */
+    int i;      /* record index in nav->eph or nav->geph */
+} ephrec_t;
+
+/* ephemerides of satellites sorted by toe */
+typedef struct {
+    int off[MAXSAT + 1]; /* records of sat: rec[off[sat-1]]...rec[off[sat]-1] */
+    int first[MAXSAT];   /* first record of sat in file order (-1: none) */
+    ephrec_t *rec;       /* records sorted by sat, toe and record index */
+} ephlist_t;
+
+/* ephemeris index */
+struct ephidx_tag {
+    gtime_t t0;     /* reference time of toe */
+    ephlist_t eph;  /* GPS/GAL/QZS/CMP/IRN ephemerides */
+    ephlist_t geph; /* GLONASS ephemerides */
+};
+
+/* navigation data view */
+struct navview_tag {
+    nav_t nav;            /* copy of navigation data (eph/geph replaced) */
+    const nav_t *src;     /* source navigation data */
+    int nmax, ngmax;      /* allocated ephemerides */
+    int *ie, nie, niemax; /* record indexes (work) */
+    int cur[MAXSAT];      /* window start of last query */
+};
+
+/* max age of ephemeris in seleph/selgeph -----------------------------*/
+static double maxdtoe(const int sys) {
+    switch (sys) {
+        case SYS_GLO: return MAXDTOE_GLO;
+        case SYS_GAL: return MAXDTOE_GAL;
+        case SYS_QZS: return MAXDTOE_QZS;
+        case SYS_CMP: return MAXDTOE_CMP;
+        case SYS_IRN: return MAXDTOE_IRN;
+    }
+    return MAXDTOE;
+}
+/* compare ephemeris records ------------------------------------------*/
+static int cmprec(const void *p1, const void *p2) {
+    const ephrec_t *r1 = (const ephrec_t *)p1, *r2 = (const ephrec_t *)p2;
+
+    if (r1->toe != r2->toe) return r1->toe < r2->toe ? -1 : 1;
+    return r1->i - r2->i;
+}
+/* build ephemeris list (eph or geph) --------------------------------*/
+static int buildlist(ephlist_t *list, const eph_t *eph, const geph_t *geph,
+                     const int n, const gtime_t t0) {
+    int i, s, k, cnt[MAXSAT] = {0};
+
+    if (!(list->rec = (ephrec_t *)malloc(sizeof(ephrec_t) * (n + 1)))) {
+        return 0;
+    }
+    for (i = 0; i < MAXSAT; i++) list->first[i] = -1;
+    for (i = 0; i < n; i++) {
+        s = eph ? eph[i].sat : geph[i].sat;
+        if (s >= 1 && s <= MAXSAT) cnt[s - 1]++;
+    }
+    for (list->off[0] = 0, i = 0; i < MAXSAT; i++) {
+        list->off[i + 1] = list->off[i] + cnt[i];
+        cnt[i] = list->off[i];
+    }
+    for (i = 0; i < n; i++) {
+        s = eph ? eph[i].sat : geph[i].sat;
+        if (s < 1 || s > MAXSAT) continue;
+        k = cnt[s - 1]++;
+        list->rec[k].toe = timediff(eph ? eph[i].toe : geph[i].toe, t0);
+        list->rec[k].i = i;
+        if (list->first[s - 1] < 0) list->first[s - 1] = i;
+    }
+    for (i = 0; i < MAXSAT; i++) {
+        if (list->off[i + 1] - list->off[i] > 1) {
+            qsort(list->rec + list->off[i], list->off[i + 1] - list->off[i],
+                  sizeof(ephrec_t), cmprec);
+        }
+    }
+    return 1;
+}
+/* add record indexes in window of satellite --------------------------*/
+static int addwindow(navview_t *view, const ephlist_t *list, const int sat,
+                     const double t, const double tw) {
+    const ephrec_t *rec = list->rec;
+    int k = view->cur[sat - 1], k0 = list->off[sat - 1];
+    int k1 = list->off[sat], n = 0, first = list->first[sat - 1];
+    int *ie;
+
+    if (first < 0) return 1;
+
+    /* walk from window start of last query (O(1) for sorted queries) */
+    if (k < k0 || k > k1) k = k0;
+    while (k > k0 && rec[k - 1].toe >= t - tw) k--;
+    while (k < k1 && rec[k].toe < t - tw) k++;
+    view->cur[sat - 1] = k;
+
+    for (; k + n < k1 && rec[k + n].toe <= t + tw; n++);
+
+    if (view->nie + n + 1 > view->niemax) {
+        view->niemax = 2 * (view->nie + n + 1);
+        if (!(ie = (int *)realloc(view->ie, sizeof(int) * view->niemax))) {
+            return 0;
+        }
+        view->ie = ie;
+    }
+    /* first record in file order for frequency of GLONASS (sat2freq) */
+    view->ie[view->nie++] = first;
+    for (; n > 0; n--, k++) {
+        if (rec[k].i != first) view->ie[view->nie++] = rec[k].i;
+    }
+    return 1;
+}
+/* compare record indexes ---------------------------------------------*/
+static int cmpint(const void *p1, const void *p2) {
+    return *(const int *)p1 - *(const int *)p2;
+}
+/* copy records of indexes to view ------------------------------------*/
+static int copyrecs(navview_t *view, const int glo) {
+    const int n = view->nie, *ie = view->ie;
+    eph_t *eph;
+    geph_t *geph;
+    int i;
+
+    qsort(view->ie, n, sizeof(int), cmpint);
+
+    if (!glo) {
+        if (n > view->nmax) {
+            if (!(eph = (eph_t *)realloc(view->nav.eph, sizeof(eph_t) * n))) {
+                return 0;
+            }
+            view->nav.eph = eph;
+            view->nmax = view->nav.nmax = n;
+        }
+        for (i = 0; i < n; i++) view->nav.eph[i] = view->src->eph[ie[i]];
+        view->nav.n = n;
+    } else {
+        if (n > view->ngmax) {
+            if (!(geph = (geph_t *)realloc(view->nav.geph,
+                                           sizeof(geph_t) * n))) {
+                return 0;
+            }
+            view->nav.geph = geph;
+            view->ngmax = view->nav.ngmax = n;
+        }
+        for (i = 0; i < n; i++) view->nav.geph[i] = view->src->geph[ie[i]];
+        view->nav.ng = n;
+    }
+    return 1;
+}
+
+/* build ephemeris index (NULL: memory allocation error) --------------*/
+extern ephidx_t *newephidx(const nav_t *nav) {
+    ephidx_t *idx;
+
+    if (!(idx = (ephidx_t *)calloc(1, sizeof(ephidx_t)))) return NULL;
+    if (nav->n > 0) {
+        idx->t0 = nav->eph[0].toe;
+    } else if (nav->ng > 0) {
+        idx->t0 = nav->geph[0].toe;
+    }
+    if (!buildlist(&idx->eph, nav->eph, NULL, nav->n, idx->t0) ||
+        !buildlist(&idx->geph, NULL, nav->geph, nav->ng, idx->t0)) {
+        freeephidx(idx);
+        return NULL;
+    }
+    return idx;
+}
+/* free ephemeris index -----------------------------------------------*/
+extern void freeephidx(ephidx_t *idx) {
+    if (!idx) return;
+    free(idx->eph.rec);
+    free(idx->geph.rec);
+    free(idx);
+}
+/* new navigation data view (NULL: memory allocation error) -----------*/
+/* view is a copy of nav, so that one view should be used by one thread  */
+extern navview_t *newnavview(const nav_t *nav) {
+    navview_t *view;
+
+    if (!(view = (navview_t *)calloc(1, sizeof(navview_t)))) return NULL;
+    view->nav = *nav;
+    view->nav.eph = NULL;
+    view->nav.geph = NULL;
+    view->nav.n = view->nav.nmax = view->nav.ng = view->nav.ngmax = 0;
+    view->src = nav;
+    return view;
+}
+/* navigation data view of ephemerides near epoch ---------------------*/
+/* args   : navview_t *view  IO  navigation data view                   */
+/*          ephidx_t  *idx   I   ephemeris index of source nav          */
+/*          gtime_t   time   I   time to select ephemeris (teph)        */
+/*          int       *sat   I   satellite numbers                      */
+/*          int       n      I   number of satellites                   */
+/* return : navigation data with ephemerides of satellites near epoch,  */
+/*          or source navigation data if view or index is not available */
+extern const nav_t *navview(navview_t *view, const ephidx_t *idx,
+                            const gtime_t time, const int *sat, const int n) {
+    uint8_t mark[MAXSAT] = {0};
+    double t;
+    int i, sys, glo;
+
+    if (!view) return NULL;
+    if (!idx) return view->src;
+    t = timediff(time, idx->t0);
+
+    /* GPS/GAL/QZS/CMP/IRN and GLONASS ephemerides */
+    for (glo = 0; glo < 2; glo++) {
+        view->nie = 0;
+        for (i = 0; i < n; i++) {
+            if (sat[i] < 1 || sat[i] > MAXSAT || mark[sat[i] - 1]) continue;
+            sys = satsys(sat[i], NULL);
+            if ((sys == SYS_GLO) != glo || sys == SYS_SBS) continue;
+            mark[sat[i] - 1] = 1;
+            if (!addwindow(view, glo ? &idx->geph : &idx->eph, sat[i], t,
+                           maxdtoe(sys) + DTOEMARGIN)) {
+                return view->src;
+            }
+        }
+        if (!copyrecs(view, glo)) return view->src;
+    }
+    return &view->nav;
+}
+/* free navigation data view ------------------------------------------*/
+extern void freenavview(navview_t *view) {
+    if (!view) return;
+    free(view->nav.eph);
+    free(view->nav.geph);
+    free(view->ie);
+    free(view);
+}
@@ -5,6 +5,8 @@
  * @note Wrapper for "geoidh" in geoid.c
  * @note Change input unit from radian to degree
  * @note Support vector inputs
+ * @note External geoid model is memory-mapped once and kept between calls
+ * (models not supported by geoidmap.c are opened and closed on every call)
  */
 
 #include "mex_utility.h"
@@ -14,15 +16,16 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    char file[512], errmsg[512];
+    const geoidmap_t *map;
+    char file[512], errmsg[600];
     double *lat, *lon, *geoh, pos[2];
-    int i, m, n, model;
+    int i, m, n, model, nthread;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
     mxCheckSameSize(argin[0], argin[1]); /* lat,lon */
     if (nargin == 3) mexErrMsgTxt("geoid type and file path are required");
-    if (nargin == 4) {
+    if (nargin >= 4) {
         mxCheckScalar(argin[2]); /* Geoid type */
         mxCheckChar(argin[3]);   /* Geoid file */
     }
@@ -31,17 +34,25 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     lon = (double *)mxGetPr(argin[1]);
     m = (int)mxGetM(argin[0]);
     n = (int)mxGetN(argin[0]);
-    if (nargin == 4) {
+    if (nargin >= 4) {
         model = (int)mxGetScalar(argin[2]);
         mxGetString(argin[3], file, sizeof(file));
     }
+    nthread = mxGetNumThreads(nargin, argin, 4);
 
     /* output */
     argout[0] = mxCreateDoubleMatrix(m, n, mxREAL);
     geoh = mxGetPr(argout[0]);
 
+    /* mapped geoid model (unmapped at exit unless owned by core) */
+    if (nargin >= 4 && (map = geoidmap(model, file))) {
+        if (!mexIsLocked()) mexAtExit(freegeoidmap);
+        geoidhv(map, lat, lon, m * n, geoh, nthread);
+        return;
+    }
+
     /* call RTKLIB function */
-    if (nargin == 4) {
+    if (nargin >= 4) {
         if (!opengeoid(model, file)) {
             sprintf(errmsg, "geoid model file open error: %s",file);
             mexErrMsgTxt(errmsg);
@@ -52,5 +63,5 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         pos[1] = lon[i] * D2R;
         geoh[i] = geoidh(pos);
     }
-    if (nargin == 4) closegeoid();
+    if (nargin >= 4) closegeoid();
 }
@@ -0,0 +1,181 @@
+/**
+ * @file geoidmap.c
+ * @brief Persistent memory-mapped geoid model grids
+ * @author Taro Suzuki
+ * @note Geoid model file is memory-mapped once per model and path, and kept
+ * until mex file is cleared (or core is freed)
+ * @note Grid layout and bilinear interpolation are the same as "geoidh" in
+ * geoid.c, grids are read-only after mapping, so that geoid heights can be
+ * evaluated by multiple threads
+ */
+
+#include "mex_utility.h"
+
+#include <math.h>
+
+#define MAXGEOIDMAP 4   /* max number of mapped geoid models */
+#define MINPARALLEL 4096 /* min number of points for multithreading */
+
+/* mapped geoid model */
+struct geoidmap_tag {
+    int model;          /* geoid model (GEOID_???) */
+    char path[1024];    /* geoid model file path */
+    const uint8_t *p;   /* mapped grid */
+    size_t size;        /* mapped size (bytes) */
+    void *h;            /* mapping handle */
+    double lon0, lat0;  /* grid origin (deg) */
+    double dlon, dlat;  /* grid interval (deg) */
+    int nlon, nlat;     /* number of grid points */
+    int wrap;           /* longitude wraps around (global model) */
+};
+
+static geoidmap_t maps[MAXGEOIDMAP]; /* mapped geoid models */
+static int nmap = 0;                 /* number of mapped geoid models */
+
+/* grid definition of geoid model (0: not supported) ------------------*/
+static int gridgeoid(geoidmap_t *map) {
+    size_t size;
+
+    switch (map->model) {
+        case GEOID_EGM96_M150: /* 2 byte big-endian integer (cm) */
+            map->lon0 = 0.0;
+            map->lat0 = 90.0;
+            map->dlon = 15.0 / 60.0;
+            map->dlat = -15.0 / 60.0;
+            map->nlon = 1440;
+            map->nlat = 721;
+            map->wrap = 1;
+            size = 2 * (size_t)map->nlon * map->nlat;
+            break;
+        case GEOID_EGM2008_M25: /* 4 byte float with fortran record marks */
+        case GEOID_EGM2008_M10:
+            map->lon0 = 0.0;
+            map->lat0 = 90.0;
+            map->dlon = (map->model == GEOID_EGM2008_M25 ? 2.5 : 1.0) / 60.0;
+            map->dlat = -map->dlon;
+            map->nlon = map->model == GEOID_EGM2008_M25 ? 8640 : 21600;
+            map->nlat = map->model == GEOID_EGM2008_M25 ? 4321 : 10801;
+            map->wrap = 1;
+            size = 4 * (size_t)(map->nlon + 2) * map->nlat;
+            break;
+        case GEOID_GSI2000_M15: /* 4 byte float (999.0: no data) */
+            map->lon0 = 120.0;
+            map->lat0 = 20.0;
+            map->dlon = 1.5 / 60.0;
+            map->dlat = 1.0 / 60.0;
+            map->nlon = 1201;
+            map->nlat = 1801;
+            map->wrap = 0;
+            size = 4 * (size_t)map->nlon * map->nlat;
+            break;
+        default:
+            return 0;
+    }
+    return map->size >= size;
+}
+/* grid value ---------------------------------------------------------*/
+static double gridval(const geoidmap_t *map, int i, int j) {
+    const uint8_t *p;
+    float f;
+
+    if (map->model == GEOID_EGM96_M150) {
+        p = map->p + 2 * ((size_t)i + (size_t)j * map->nlon);
+        return (short)((p[0] << 8) + p[1]) * 1E-2;
+    }
+    if (map->model == GEOID_GSI2000_M15) {
+        p = map->p + 4 * ((size_t)i + (size_t)j * map->nlon);
+    } else {
+        p = map->p + 4 * ((size_t)i + (size_t)j * (map->nlon + 2)) + 4;
+    }
+    memcpy(&f, p, 4);
+    return f;
+}
+/* geoid height by bilinear interpolation (0.0: out of range) ---------*/
+static double geoidhmap(const geoidmap_t *map, double lat, double lon) {
+    double a, b, y[4];
+    int i, i1, i2, j1, j2;
+
+    if (!(lat >= -90.0 && lat <= 90.0) || !(fabs(lon) <= 360.0)) return 0.0;
+    if (lon < 0.0) lon += 360.0;
+
+    a = (lon - map->lon0) / map->dlon;
+    b = (lat - map->lat0) / map->dlat;
+    if (a < 0.0 || b < 0.0 || a > map->nlon - 1.0 + map->wrap ||
+        b > map->nlat - 1.0) {
+        return 0.0;
+    }
+    i1 = (int)a;
+    a -= i1;
+    j1 = (int)b;
+    b -= j1;
+    if (map->wrap) {
+        i1 %= map->nlon;
+        i2 = i1 < map->nlon - 1 ? i1 + 1 : 0;
+    } else {
+        i2 = i1 < map->nlon - 1 ? i1 + 1 : i1;
+    }
+    j2 = j1 < map->nlat - 1 ? j1 + 1 : j1;
+
+    y[0] = gridval(map, i1, j1);
+    y[1] = gridval(map, i2, j1);
+    y[2] = gridval(map, i1, j2);
+    y[3] = gridval(map, i2, j2);
+    if (map->model == GEOID_GSI2000_M15) {
+        for (i = 0; i < 4; i++) {
+            if (y[i] == 999.0) return 0.0;
+        }
+    }
+    return y[0] * (1.0 - a) * (1.0 - b) + y[1] * a * (1.0 - b) +
+           y[2] * (1.0 - a) * b + y[3] * a * b;
+}
+
+/* mapped geoid model (NULL: error or not supported) ------------------*/
+/* models other than EGM96, EGM2008 and GSI2000 are not supported        */
+extern const geoidmap_t *geoidmap(const int model, const char *file) {
+    geoidmap_t *map = NULL;
+    int i;
+
+#pragma omp critical(geoidmap)
+    {
+        for (i = 0; i < nmap; i++) {
+            if (maps[i].model == model && !strcmp(maps[i].path, file)) {
+                map = maps + i;
+                break;
+            }
+        }
+        if (!map && nmap < MAXGEOIDMAP) {
+            map = maps + nmap;
+            memset(map, 0, sizeof(geoidmap_t));
+            map->model = model;
+            strncpy(map->path, file, sizeof(map->path) - 1);
+            if (!(map->p = mapfile(file, &map->size, &map->h))) {
+                map = NULL;
+            } else if (!gridgeoid(map)) {
+                unmapfile(map->p, map->size, map->h);
+                map = NULL;
+            } else {
+                nmap++;
+            }
+        }
+    }
+    return map;
+}
+/* geoid heights of points --------------------------------------------*/
+extern void geoidhv(const geoidmap_t *map, const double *lat,
+                    const double *lon, const int n, double *geoh,
+                    const int nthread) {
+    int i;
+
+#pragma omp parallel for num_threads(nthread) schedule(static) \
+    if (n >= MINPARALLEL)
+    for (i = 0; i < n; i++) {
+        geoh[i] = geoidhmap(map, lat[i], lon[i]);
+    }
+}
+/* unmap all geoid models ---------------------------------------------*/
+extern void freegeoidmap(void) {
+    int i;
+
+    for (i = 0; i < nmap; i++) unmapfile(maps[i].p, maps[i].size, maps[i].h);
+    nmap = 0;
+}
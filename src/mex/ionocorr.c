@@ -15,7 +15,7 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
+    nav_t nav = {0}, *navp;
     gtime_t time;
     int i, j, m, nsat, nllhs, ionoopt;
     double ep[6], llh[3], azel[2], ion, var;
@@ -33,7 +33,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     /* inputs */
     eps = (double *)mxGetPr(argin[0]);
     m = (int)mxGetM(argin[0]);
-    nav = mxnav2nav(argin[1]);
+    navp = mxnav2navp(argin[1], &nav);
     llhs = (double *)mxGetPr(argin[2]);
     nllhs = (int)mxGetM(argin[2]);
     azs = (double *)mxGetPr(argin[3]);
@@ -73,7 +73,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         for (j = 0; j < nsat; j++) {
             azel[0] = azs[i + m * j] * D2R;
             azel[1] = els[i + m * j] * D2R;
-            ionocorr(time, &nav, 0, llh, azel, ionoopt, &ion, &var);
+            ionocorr(time, navp, 0, llh, azel, ionoopt, &ion, &var);
 
             /* frequency compensation */
             ion *= SQR(FREQ1 / frqs[j]);
@@ -83,8 +83,5 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         }
     }
 
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
+    freenavp(navp, &nav);
 }
@@ -3,7 +3,7 @@
  * @brief Transform (lat,lon,ellipsoidal height) to local tangential coordinate
  * @author Taro Suzuki
  * @note Output transformation matrix
- * @note Support vector inputs
+ * @note Support vector inputs (batch transformation in coord.c)
  */
 
 #include "mex_utility.h"
@@ -14,8 +14,8 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     const mwSize dims[3] = {3, 3, 0};
-    int i, j, m;
-    double l[3], x[3], e[3], o[3], Et[9], orgxyz[3], *orgllh, *llh, *enu, *E;
+    int m;
+    double o[3], Et[9], orgxyz[3], *orgllh, *llh, *enu, *E;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -41,18 +41,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     xyz2enu(o, Et);
     transpose_mw(Et, dims, E); /* transpose, ecef -> enu */
 
-    /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        l[0] = llh[i + m * 0] * D2R;
-        l[1] = llh[i + m * 1] * D2R;
-        l[2] = llh[i + m * 2];
-        pos2ecef(l, x);
-        x[0] -= orgxyz[0];
-        x[1] -= orgxyz[1];
-        x[2] -= orgxyz[2];
-        ecef2enu(o, x, e);
-        enu[i + m * 0] = e[0];
-        enu[i + m * 1] = e[1];
-        enu[i + m * 2] = e[2];
-    }
+    /* call RTKLIB function (batch, ecef is transformed in place of enu) */
+    pos2ecefv(llh, m, enu);
+    ecef2enuv(Et, orgxyz, enu, m, enu);
 }
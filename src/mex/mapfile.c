@@ -0,0 +1,70 @@
+/**
+ * @file mapfile.c
+ * @brief Read-only file mapping shared by file caches
+ * @author Taro Suzuki
+ * @note Used by geoid model grids (geoidmap.c) and observation cache
+ * (obscache.c), file is mapped by CreateFileMapping on Windows and mmap on
+ * other platforms
+ */
+
+#include "mex_utility.h"
+
+#include <sys/stat.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* map file read-only (NULL: error or empty file) --------------------*/
+extern const uint8_t *mapfile(const char *path, size_t *size, void **h) {
+#ifdef WIN32
+    HANDLE hf, hm;
+    LARGE_INTEGER li;
+    const uint8_t *p;
+
+    hf = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                     FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hf == INVALID_HANDLE_VALUE) return NULL;
+    if (!GetFileSizeEx(hf, &li) || li.QuadPart <= 0 ||
+        !(hm = CreateFileMappingA(hf, NULL, PAGE_READONLY, 0, 0, NULL))) {
+        CloseHandle(hf);
+        return NULL;
+    }
+    CloseHandle(hf);
+    if (!(p = (const uint8_t *)MapViewOfFile(hm, FILE_MAP_READ, 0, 0, 0))) {
+        CloseHandle(hm);
+        return NULL;
+    }
+    *size = (size_t)li.QuadPart;
+    *h = (void *)hm;
+    return p;
+#else
+    struct stat st;
+    void *p;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0) return NULL;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    *h = NULL;
+    return (const uint8_t *)p;
+#endif
+}
+/* unmap file ---------------------------------------------------------*/
+extern void unmapfile(const uint8_t *p, const size_t size, void *h) {
+#ifdef WIN32
+    UnmapViewOfFile(p);
+    CloseHandle((HANDLE)h);
+#else
+    munmap((void *)p, size);
+#endif
+}
@@ -13,43 +13,257 @@
 
 #include "rtklib.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /* constants/macros from RTKLIB */
 #define SQR(x) ((x) * (x))
 #define ERR_SAAS 0.3  /* Saastamoinen model error Std (m) */
 #define ERR_BRDCI 0.5 /* broadcast ionosphere model error factor */
 #define REL_HUMI 0.7  /* relative humidity for Saastamoinen model */
 
+/* observable selection mask of obs2mxobs */
+#define NOBSTYPE 5       /* number of observables (P,L,D,S,I) */
+#define OBSMASK_P 0x01   /* pseudorange */
+#define OBSMASK_L 0x02   /* carrier phase */
+#define OBSMASK_D 0x04   /* doppler */
+#define OBSMASK_S 0x08   /* SNR */
+#define OBSMASK_I 0x10   /* LLI */
+#define OBSMASK_ALL 0x1F /* all observables */
+
+/* observation data selection of readrnxobs */
+typedef struct {
+    gtime_t ts, te;         /* time span (0: no limit) */
+    double tint;            /* time interval (s) (0: all) */
+    int navsys;             /* navigation system mask */
+    uint8_t exsats[MAXSAT]; /* excluded satellites (1: excluded) */
+    char opt[256];          /* RINEX options (e.g. "-GL1C") */
+} obssel_t;
+
+/* compact satellite status (satellite with non-zero status only) */
+typedef struct {
+    uint16_t sat;                 /* satellite number */
+    uint8_t vs;                   /* valid satellite flag */
+    double azel[2];               /* azimuth/elevation angles {az,el} (rad) */
+    double resp[NFREQ];           /* residuals of pseudorange (m) */
+    double resc[NFREQ];           /* residuals of carrier-phase (m) */
+    uint8_t vsat[NFREQ];          /* valid satellite flag */
+    uint16_t snr[NFREQ];          /* signal strength (*SNR_UNIT dBHz) */
+    uint8_t fix[NFREQ];           /* ambiguity fix flag */
+    uint8_t slip[NFREQ];          /* cycle-slip flag */
+    uint8_t half[NFREQ];          /* half-cycle valid flag */
+    int lock[NFREQ];              /* lock counter of phase */
+    uint32_t outc[NFREQ];         /* obs outage counter of phase */
+    uint32_t slipc[NFREQ];        /* cycle-slip counter */
+    uint32_t rejc[NFREQ];         /* reject counter */
+} ssatc_t;
+
+/* performance counters of wrapper (cumulative since load) */
+#define MAXPERF 64     /* max number of wrappers with counters */
+#define PERF_IN 0      /* input marshalling (mx to RTKLIB) */
+#define PERF_COMP 1    /* RTKLIB compute */
+#define PERF_OUT 2     /* output marshalling (RTKLIB to mx) */
+
+typedef struct {
+    char name[32];  /* wrapper name */
+    double ncall;   /* number of calls */
+    double t[3];    /* time of input/compute/output (s) */
+    double bytes;   /* bytes of temporary buffers allocated */
+    double peak;    /* peak temporary buffer size in a call (bytes) */
+} perfstat_t;
+
+typedef struct {
+    perfstat_t *stat; /* counters of wrapper */
+    double tick;      /* time of last lap (s) */
+    double bytes;     /* temporary buffer size of current call (bytes) */
+} perf_t;
+
+/* kind of resident objects and process-wide objects (registry.c) */
+#define REG_NAV 1     /* navigation data handle */
+#define REG_PPP 2     /* PPP session */
+#define REGOBJ_PERF 0 /* performance counters */
+#define REGOBJ_SATC 1 /* satellite state cache */
+
+/* indexed antenna parameters (pcvidx.c) */
+typedef struct {
+    char file[512];        /* PCV file path */
+    int64_t size, mtime;   /* PCV file size (bytes) and modified time (s) */
+    pcvs_t pcvs;           /* antenna parameters */
+    int first[MAXSAT + 1]; /* first record of satellite (-1: none) */
+    int *next;             /* next record of same satellite (-1: none) */
+    int nhash;             /* size of hash table of antenna types */
+    int *krec;             /* record of antenna type in hash table */
+    int *rec;              /* record found by antenna type (-1: empty) */
+} pcvidx_t;
+
+/* memory-mapped geoid model (geoidmap.c) */
+typedef struct geoidmap_tag geoidmap_t;
+
+/* per-satellite ephemeris index and navigation data view (ephidx.c) */
+typedef struct ephidx_tag ephidx_t;
+typedef struct navview_tag navview_t;
+
+/* satellite state cache (satcache.c) */
+#define SATC_SATPOS 0   /* satpos */
+#define SATC_SATPOSS 1  /* satposs */
+#define SATC_PEPH2POS 2 /* peph2pos */
+#define SATC_NFUNC 3    /* number of wrappers using cache */
+
+typedef struct satcache_tag satcache_t;
+
+typedef struct {
+    uint64_t nav; /* id of navigation data handle */
+    int func;     /* wrapper (SATC_???) */
+    int opt;      /* ephemeris option */
+    int sat;      /* satellite number */
+    gtime_t time; /* epoch (satposs: signal reception time) */
+    double tag;   /* satposs: pseudorange (m), others: 0 */
+} satkey_t;
+
+typedef struct {
+    double rs[6];  /* satellite position/velocity */
+    double dts[2]; /* satellite clock bias/drift */
+    double var;    /* variance */
+    int svh;       /* satellite health */
+    int stat;      /* status (0: no ephemeris) */
+} satstate_t;
+
+/* output mode of rtk struct (rtk2rtk.c) */
+#define RTKOUT_FINAL 0 /* final epoch only (full state) */
+#define RTKOUT_PV -1   /* all epochs (position/velocity block only) */
+                       /* N>0: every N-th and final epoch (full state) */
+
+typedef struct {
+    int n, nmax;     /* number/allocated epochs */
+    int ns, nsmax;   /* number/allocated satellite status records */
+    gtime_t *time;   /* epoch time */
+    int *index;      /* start index of records of each epoch (n+1) */
+    ssatc_t *data;   /* satellite status records */
+} ssatbuf_t;
+
 /* declare functions */
 extern mxArray *obs2mxobs(const obsd_t *obs, const int nobs,
-                          const int *nobslist);
+                          const int *nobslist, const int *obsmask);
 extern obsd_t *mxobs2obs(const mxArray *mxobs, const int rcv, int *nout,
                          int **nobslist);
 extern obsd_t *mxobs2obs_all(const mxArray *mxobs, const int rcv, int *nout,
                              int *nsatout, int *satout);
+extern int useobscache(const char *file);
+extern int readobscache(const char *file, const int *obsmask, mxArray **mxobs,
+                        double *pos, double *glo_fcn);
+extern obsd_t *readobscacheobs(const char *file, const obssel_t *sel,
+                               int *nout, int **nobslist, double *pos,
+                               double *glo_fcn);
+extern void writeobscache(const char *file, const mxArray *mxobs,
+                          const double *pos, const double *glo_fcn);
+extern void pruneobs(mxArray *mxobs, const int *obsmask);
 extern mxArray *nav2mxnav(const nav_t *nav);
+extern mxArray *nav2mxnavc(const nav_t *nav);
+extern int mxgetnavcol(const mxArray *mxopt);
 extern nav_t mxnav2nav(const mxArray *mxnav);
+extern void freenavdata(nav_t *nav);
+extern mxArray *nav2mxnavh(const nav_t *nav);
+extern int mxisnavh(const mxArray *mxnav);
+extern nav_t *mxnavh2nav(const mxArray *mxnavh);
+extern void freemxnavh(const mxArray *mxnavh);
+extern void freenavhs(const void *owner);
+extern nav_t *mxnav2navp(const mxArray *mxnav, nav_t *nav);
+extern void freenavp(nav_t *navp, nav_t *nav);
+extern uint64_t mxnavhid(const mxArray *mxnav);
+extern ephidx_t *mxnav2ephidx(const mxArray *mxnav, const nav_t *navp);
+extern void freeephidxp(ephidx_t *idx, const mxArray *mxnav);
+extern ephidx_t *newephidx(const nav_t *nav);
+extern void freeephidx(ephidx_t *idx);
+extern navview_t *newnavview(const nav_t *nav);
+extern const nav_t *navview(navview_t *view, const ephidx_t *idx,
+                            const gtime_t time, const int *sat, const int n);
+extern void freenavview(navview_t *view);
+extern uint64_t regadd(const int kind, void *ptr, const void *owner);
+extern void *regget(const int kind, const uint64_t id);
+extern void *regdel(const int kind, const uint64_t id);
+extern void regsetowner(const int kind, const uint64_t id, const void *owner);
+extern uint64_t regfirst(const int kind, const void *owner);
+extern int regnum(const int kind, const void *owner);
+extern void *regobj(const int obj);
+extern void regsetobj(const int obj, void *ptr);
+extern const uint8_t *mapfile(const char *path, size_t *size, void **h);
+extern void unmapfile(const uint8_t *p, const size_t size, void *h);
+extern satcache_t *satcacheopen(const int func, const uint64_t nav);
+extern int satcacheget(satcache_t *c, const satkey_t *key, satstate_t *s);
+extern void satcacheput(satcache_t *c, const satkey_t *key,
+                        const satstate_t *s);
+extern int satcacheon(const double budget);
+extern void satcacheoff(void);
+extern void satcachefree(void);
+extern void satcacheclear(void);
+extern mxArray *satcache2mx(void);
 extern mxArray *eph2mxeph(const eph_t *eph, const int n);
 extern mxArray *geph2mxgeph(const geph_t *geph, const int n);
 extern void mxeph2eph(const mxArray *mxeph, const int n, eph_t *eph);
 extern void mxgeph2geph(const mxArray *mxgeph, const int n, geph_t *geph);
+extern mxArray *eph2mxephc(const eph_t *eph, const int n);
+extern mxArray *geph2mxgephc(const geph_t *geph, const int n);
+extern int mxgetnrec(const mxArray *mxs, const char *field);
 extern mxArray *opt2mxopt(const prcopt_t *popt, const solopt_t *sopt);
 extern void mxopt2opt(const mxArray *mxopt, prcopt_t *popt, solopt_t *sopt);
 extern mxArray *sol2mxsol(const sol_t *sol, const int n);
 extern sol_t *mxsol2sol(const mxArray *mxsol);
-extern mxArray *ssat2mxssat(const ssat_t *ssat, const gtime_t *time,
-                            const int n);
+extern int addssat(ssatbuf_t *buf, gtime_t time, const ssat_t *ssat);
+extern int catssatbuf(ssatbuf_t *buf, const ssatbuf_t *src);
+extern int addssatbuf(ssatbuf_t *buf, const ssatbuf_t *src, const int i);
+extern void freessatbuf(ssatbuf_t *buf);
+extern mxArray *ssatbuf2mxssat(const ssatbuf_t *buf);
 extern mxArray *solstat2mxsolstat(const solstat_t *stat, const int nstat);
 extern mxArray *rtk2mxrtk(const rtk_t *rtks, const int n);
+extern mxArray *rtk2mxrtkc(const rtk_t *rtks, const int n);
+extern int mxisrtkc(const mxArray *mxrtk);
+extern int getrtkfmt(const mxArray *mxfmt);
 extern rtk_t mxrtk2rtk(const mxArray *mxrtk, const prcopt_t *popt,
                        const sol_t *sol);
+extern int getrtkout(const mxArray *mxmode);
+extern int isrtkout(const int mode, const int i, const int n);
+extern int rtkcopy(rtk_t *dist, const rtk_t *src, const int nx, const int na);
+extern void freertkcopy(rtk_t *rtks, const int n);
 extern mxArray *peph2mxpeph(const peph_t *peph, const int n);
 extern void mxpeph2peph(const mxArray *mxpeph, const int n, peph_t *peph);
 extern mxArray *pclk2mxpclk(const pclk_t *pclk, const int n);
 extern void mxpclk2pclk(const mxArray *mxpclk, const int n, pclk_t *pclk);
+extern mxArray *peph2mxpephc(const peph_t *peph, const int n);
+extern mxArray *pclk2mxpclkc(const pclk_t *pclk, const int n);
 extern mxArray *pcv2mxpcv(const pcv_t *pcvs, const int n);
 extern void mxpcv2pcv(const mxArray *mxpcvs, const int n, pcv_t *pcvs);
+extern void mxpcv2pcvi(const mxArray *mxpcvs, const int i, pcv_t *pcv);
 extern mxArray *erp2mxerp(const erp_t *erp);
 extern void mxerp2erp(const mxArray *mxerp, erp_t *erp);
+extern void ecef2posv(const double *xyz, const int m, double *llh);
+extern void pos2ecefv(const double *llh, const int m, double *xyz);
+extern void ecef2enuv(const double *E, const double *org, const double *xyz,
+                      const int m, double *enu);
+extern void enu2ecefv(const double *E, const double *org, const double *enu,
+                      const int m, double *xyz);
+extern void peph2posv(const gtime_t *time, const int m, const int *sat,
+                      const int nsat, const nav_t *nav, const int opt,
+                      const int nthread, double **rs, double **dts,
+                      double *var, uint8_t *nodata);
+extern const geoidmap_t *geoidmap(const int model, const char *file);
+extern void geoidhv(const geoidmap_t *map, const double *lat,
+                    const double *lon, const int n, double *geoh,
+                    const int nthread);
+extern void freegeoidmap(void);
+extern const pcvidx_t *pcvindex(const char *file);
+extern const pcv_t *searchpcvidx(const pcvidx_t *idx, const int sat,
+                                 const char *type, const gtime_t time);
+extern int npcvindex(void);
+extern void freepcvindex(void);
+extern void perfstart(perf_t *perf, const char *name);
+extern void perflap(perf_t *perf, int type);
+extern void perfalloc(perf_t *perf, double bytes);
+extern void perfend(perf_t *perf);
+extern double perfobs(const int *nobslist, int n);
+extern double perfnav(const nav_t *navp, const nav_t *nav);
+extern mxArray *perf2mxperf(void);
+extern void perfreset(void);
 
 // /* additional declere functions in rtklib */
 // extern int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
@@ -309,4 +523,26 @@ static inline void int2double(const int *idata, const int n, double *ddata) {
         ddata[i] = (double)idata[i];
     }
 }
+
+/* number of threads for epoch loop: optional argument argin[idx] or */
+/* OpenMP default (OMP_NUM_THREADS), always 1 without OpenMP          */
+static inline int mxGetNumThreads(int nargin, const mxArray *argin[], int idx) {
+    int nthread = 1;
+#ifdef _OPENMP
+    nthread = omp_get_max_threads();
+#endif
+    if (nargin > idx && !mxIsEmpty(argin[idx])) {
+        mxCheckScalar(argin[idx]);
+        nthread = (int)mxGetScalar(argin[idx]);
+        if (nthread < 1) mexErrMsgTxt("Number of threads must be positive");
+    }
+    return nthread;
+}
+/* number of threads for satellite positions by ephemeris option: antenna */
+/* offset of precise ephemeris (satantoff) calls sunmoonpos, whose         */
+/* eci2ecef keeps a static cache, so only broadcast/SBAS ephemeris is      */
+/* computed in parallel                                                    */
+static inline int ephNumThreads(int ephopt, int nthread) {
+    return ephopt == EPHOPT_BRDC || ephopt == EPHOPT_SBAS ? nthread : 1;
+}
 #endif
@@ -6,8 +6,15 @@
 
 #include "mex_utility.h"
 
-/* nav2mxnav ----------------------------------------------------------*/
-extern mxArray *nav2mxnav(const nav_t *nav) {
+/* resident navigation data referred by handle (registry id) */
+typedef struct {
+    nav_t nav;      /* navigation data */
+    ephidx_t *eidx; /* ephemeris index (NULL: not available) */
+} navh_t;
+
+/* nav2mxnavopt -------------------------------------------------------*/
+/* col: output ephemeris as columnar struct (1) or struct array (0)      */
+static mxArray *nav2mxnavopt(const nav_t *nav, const int col) {
     double cbiast[MAXSAT * 3] = {0};
     mxArray *mxnav, *mxeph, *mxgeph, *mxpeph, *mxpclk, *mxcbias, *mxpcvs;
     mxArray *mxerp;
@@ -25,16 +32,19 @@ extern mxArray *nav2mxnav(const nav_t *nav) {
     mxnav = mxCreateStructMatrix(1, 1, 19, navf);
 
     /* eph to mxeph */
-    mxeph = eph2mxeph(nav->eph, nav->n);
+    mxeph = col ? eph2mxephc(nav->eph, nav->n) : eph2mxeph(nav->eph, nav->n);
 
     /* geph to mxgeph */
-    mxgeph = geph2mxgeph(nav->geph, nav->ng);
+    mxgeph = col ? geph2mxgephc(nav->geph, nav->ng)
+                 : geph2mxgeph(nav->geph, nav->ng);
 
     /* peph to mxpeph */
-    mxpeph = peph2mxpeph(nav->peph, nav->ne);
+    mxpeph = col ? peph2mxpephc(nav->peph, nav->ne)
+                 : peph2mxpeph(nav->peph, nav->ne);
 
     /* pclk to mxpclk */
-    mxpclk = pclk2mxpclk(nav->pclk, nav->nc);
+    mxpclk = col ? pclk2mxpclkc(nav->pclk, nav->nc)
+                 : pclk2mxpclk(nav->pclk, nav->nc);
 
     /* pcvs to mxpcvs */
     mxpcvs = pcv2mxpcv(nav->pcvs, MAXSAT);
@@ -110,6 +120,22 @@ extern mxArray *nav2mxnav(const nav_t *nav) {
 
     return mxnav;
 }
+/* nav2mxnav ----------------------------------------------------------*/
+extern mxArray *nav2mxnav(const nav_t *nav) { return nav2mxnavopt(nav, 0); }
+/* nav2mxnavc ---------------------------------------------------------*/
+extern mxArray *nav2mxnavc(const nav_t *nav) { return nav2mxnavopt(nav, 1); }
+/* mxgetnavcol --------------------------------------------------------*/
+/* output ephemeris format option: "column" or "struct" (default)        */
+extern int mxgetnavcol(const mxArray *mxopt) {
+    char opt[16];
+
+    mxCheckChar(mxopt);
+    mxGetString(mxopt, opt, sizeof(opt));
+    if (!strcmp(opt, "column")) return 1;
+    if (!strcmp(opt, "struct")) return 0;
+    mexErrMsgTxt("Navigation data format must be \"column\" or \"struct\"");
+    return 0;
+}
 /* mxnav2nav ----------------------------------------------------------*/
 extern nav_t mxnav2nav(const mxArray *mxnav) {
     double cbiast[MAXSAT * 3] = {0};
@@ -123,10 +149,11 @@ extern nav_t mxnav2nav(const mxArray *mxnav) {
     /* check nav struct */
     mxCheckStruct(mxnav, navf, 19);
 
-    nav.n = (int)mxGetM(mxGetField(mxnav, 0, "eph"));
-    nav.ng = (int)mxGetM(mxGetField(mxnav, 0, "geph"));
-    nav.ne = (int)mxGetM(mxGetField(mxnav, 0, "peph"));
-    nav.nc = (int)mxGetM(mxGetField(mxnav, 0, "pclk"));
+    /* number of records in struct array or columnar struct */
+    nav.n = mxgetnrec(mxGetField(mxnav, 0, "eph"), "sat");
+    nav.ng = mxgetnrec(mxGetField(mxnav, 0, "geph"), "sat");
+    nav.ne = mxgetnrec(mxGetField(mxnav, 0, "peph"), "time");
+    nav.nc = mxgetnrec(mxGetField(mxnav, 0, "pclk"), "time");
 
     if (!(nav.eph = (eph_t *)malloc(sizeof(eph_t) * nav.n)) ||
         !(nav.geph = (geph_t *)malloc(sizeof(geph_t) * nav.ng)) ||
@@ -198,3 +225,116 @@ extern nav_t mxnav2nav(const mxArray *mxnav) {
     uniqnav(&nav);
     return nav;
 }
+
+/* free navigation data arrays ----------------------------------------*/
+extern void freenavdata(nav_t *nav) {
+    if (nav->n > 0) free(nav->eph);
+    if (nav->ng > 0) free(nav->geph);
+    if (nav->ne > 0) free(nav->peph);
+    if (nav->nc > 0) free(nav->pclk);
+    if (nav->erp.n > 0) free(nav->erp.data);
+    nav->eph = NULL;
+    nav->geph = NULL;
+    nav->peph = NULL;
+    nav->pclk = NULL;
+    nav->erp.data = NULL;
+    nav->n = nav->ng = nav->ne = nav->nc = nav->erp.n = 0;
+}
+/* nav2mxnavh ---------------------------------------------------------*/
+extern mxArray *nav2mxnavh(const nav_t *nav) {
+    navh_t *navh;
+    mxArray *mxnavh;
+    uint64_t id;
+
+    if (!(navh = (navh_t *)malloc(sizeof(navh_t)))) {
+        mexErrMsgTxt("nav2mxnavh: memory allocation error");
+    }
+    /* take over ownership of ephemeris arrays */
+    navh->nav = *nav;
+    navh->eidx = newephidx(nav);
+    if (!(id = regadd(REG_NAV, navh, NULL))) {
+        freenavdata(&navh->nav);
+        freeephidx(navh->eidx);
+        free(navh);
+        mexErrMsgTxt("nav2mxnavh: too many navigation data handles");
+    }
+    mxnavh = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *(uint64_t *)mxGetData(mxnavh) = id;
+    return mxnavh;
+}
+/* mxisnavh -----------------------------------------------------------*/
+extern int mxisnavh(const mxArray *mxnav) {
+    return mxIsUint64(mxnav) && mxGetNumberOfElements(mxnav) == 1;
+}
+/* resident navigation data of handle ---------------------------------*/
+static navh_t *mxnavh2navh(const mxArray *mxnavh) {
+    navh_t *navh;
+
+    if (!mxisnavh(mxnavh)) {
+        mexErrMsgTxt("Input argument must be navigation data handle");
+    }
+    if (!(navh = (navh_t *)regget(REG_NAV, *(uint64_t *)mxGetData(mxnavh)))) {
+        mexErrMsgTxt("Invalid or freed navigation data handle");
+    }
+    return navh;
+}
+/* free resident navigation data of id (0: invalid or freed) ----------*/
+static int freenavh(const uint64_t id) {
+    navh_t *navh;
+
+    if (!(navh = (navh_t *)regdel(REG_NAV, id))) return 0;
+    freenavdata(&navh->nav);
+    freeephidx(navh->eidx);
+    free(navh);
+    return 1;
+}
+/* free resident navigation data owned by module ----------------------*/
+extern void freenavhs(const void *owner) {
+    uint64_t id;
+
+    while ((id = regfirst(REG_NAV, owner))) freenavh(id);
+}
+/* mxnavh2nav ---------------------------------------------------------*/
+extern nav_t *mxnavh2nav(const mxArray *mxnavh) {
+    return &mxnavh2navh(mxnavh)->nav;
+}
+/* freemxnavh ---------------------------------------------------------*/
+extern void freemxnavh(const mxArray *mxnavh) {
+    mxnavh2navh(mxnavh); /* check handle */
+    freenavh(*(uint64_t *)mxGetData(mxnavh));
+}
+/* mxnav2navp ---------------------------------------------------------*/
+/* navigation data from nav struct or handle. nav struct is converted to */
+/* nav and nav is returned, handle returns resident data without copy    */
+extern nav_t *mxnav2navp(const mxArray *mxnav, nav_t *nav) {
+    if (mxisnavh(mxnav)) {
+        return mxnavh2nav(mxnav);
+    }
+    *nav = mxnav2nav(mxnav);
+    return nav;
+}
+/* freenavp -----------------------------------------------------------*/
+/* free navigation data returned by mxnav2navp (resident data is kept) */
+extern void freenavp(nav_t *navp, nav_t *nav) {
+    if (navp == nav) freenavdata(nav);
+}
+/* mxnavhid -----------------------------------------------------------*/
+/* id of navigation data handle (0: nav struct), id is not reused after  */
+/* handle is freed                                                       */
+extern uint64_t mxnavhid(const mxArray *mxnav) {
+    if (!mxisnavh(mxnav)) return 0;
+    mxnavh2navh(mxnav); /* check handle */
+    return *(uint64_t *)mxGetData(mxnav);
+}
+/* mxnav2ephidx -------------------------------------------------------*/
+/* ephemeris index of nav struct or handle. handle returns resident index */
+/* built at loading, index of nav struct is built (free by freeephidxp)  */
+extern ephidx_t *mxnav2ephidx(const mxArray *mxnav, const nav_t *navp) {
+    if (mxisnavh(mxnav)) return mxnavh2navh(mxnav)->eidx;
+    return newephidx(navp);
+}
+/* freeephidxp --------------------------------------------------------*/
+/* free ephemeris index returned by mxnav2ephidx (resident index is kept) */
+extern void freeephidxp(ephidx_t *idx, const mxArray *mxnav) {
+    if (!mxisnavh(mxnav)) freeephidx(idx);
+}
@@ -0,0 +1,20 @@
+/**
+ * @file navfree.c
+ * @brief Free navigation data loaded by navload
+ * @author Taro Suzuki
+ * @note New development function
+ */
+
+#include "mex_utility.h"
+
+#define NIN 1
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+
+    /* free resident navigation data */
+    freemxnavh(argin[0]);
+}
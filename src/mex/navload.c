@@ -0,0 +1,31 @@
+/**
+ * @file navload.c
+ * @brief Load navigation data to resident memory and return handle
+ * @author Taro Suzuki
+ * @note New development function
+ * @note Use "navfree" to release the navigation data
+ */
+
+#include "mex_utility.h"
+
+#define NIN 1
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    nav_t nav = {0};
+    perf_t perf;
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+    perfstart(&perf, "navload");
+
+    /* input */
+    nav = mxnav2nav(argin[0]);
+    perfalloc(&perf, perfnav(&nav, &nav));
+    perflap(&perf, PERF_IN);
+
+    /* output */
+    argout[0] = nav2mxnavh(&nav);
+    perfend(&perf);
+}
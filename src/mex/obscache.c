@@ -0,0 +1,479 @@
+/**
+ * @file obscache.c
+ * @brief Binary cache of RINEX observation data in obs2mxobs layout
+ * @author Taro Suzuki
+ * @note Cache file is keyed by source file path, size and modified time, and
+ * payload is verified by checksum in header. On load, cache file is mapped
+ * read-only and sections are copied into new mxArrays (one copy, no parsing)
+ * @note Cache is disabled by default, it is enabled by environment variable
+ * MATRTKLIB_CACHE (cache directory, "on": temporary directory)
+ * @note Cache file is written to unique temporary file and renamed, so that
+ * concurrent writers (MATLAB sessions) never read partially written file
+ */
+
+#include "mex_utility.h"
+
+#include <sys/stat.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define OBSCACHE_MAGIC "MRTKOBS"
+#define OBSCACHE_VER 2
+
+/* cache file header (size must be multiple of 8 bytes) */
+typedef struct {
+    char magic[8];      /* magic string */
+    int32_t version;    /* cache format version */
+    int32_t n, nsat;    /* number of epochs and satellites */
+    uint32_t frqmask;   /* frequencies in cache (bit k: FTYPE[k]) */
+    int64_t size;       /* source file size (bytes) */
+    int64_t mtime;      /* source file modified time (s) */
+    double pos[3];      /* station position (ecef) (m) */
+    double glo_fcn[32]; /* glonass fcn+8 */
+    char path[1024];    /* source file path */
+    uint64_t checksum;  /* checksum of data sections */
+} obsch_t;
+
+/* data sections following header (doubles, column-major):
+ *   sat (nsat), ep (n*6), tow (n), week (n),
+ *   for each frequency in frqmask:
+ *     P,L,D,S,I (n*nsat each), ctype (nsat bytes padded to 8 bytes) */
+
+static const char *FTYPE[NFREQ] = {"L1", "L2", "L5", "L6", "L7", "L8", "L9"};
+static const char *OTYPE[NOBSTYPE] = {"P", "L", "D", "S", "I"};
+
+/* size of ctype section ----------------------------------------------*/
+static size_t ctypesize(const int nsat) {
+    return ((size_t)nsat + 7) / 8 * 8;
+}
+/* source file size and modified time ---------------------------------*/
+static int getfileinfo(const char *file, int64_t *size, int64_t *mtime) {
+#ifdef WIN32
+    struct _stat64 st;
+    if (_stat64(file, &st) != 0) return 0;
+#else
+    struct stat st;
+    if (stat(file, &st) != 0) return 0;
+#endif
+    *size = (int64_t)st.st_size;
+    *mtime = (int64_t)st.st_mtime;
+    return 1;
+}
+/* checksum of data (FNV-1a of 64-bit words) -------------------------*/
+static uint64_t checksum(uint64_t hash, const void *data, const size_t size) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t w;
+    size_t i;
+
+    for (i = 0; i + 8 <= size; i += 8) {
+        memcpy(&w, p + i, 8);
+        hash = (hash ^ w) * 1099511628211ULL;
+    }
+    for (; i < size; i++) hash = (hash ^ p[i]) * 1099511628211ULL;
+    return hash;
+}
+/* cache file path of source file (0: cache disabled) -----------------*/
+static int cachepath(const char *file, char *path, const int len) {
+    const char *dir;
+    uint64_t hash = 1469598103934665603ULL; /* FNV-1a */
+    const char *p;
+
+    /* cache is enabled only by MATRTKLIB_CACHE (opt-in) */
+    if (!(dir = getenv("MATRTKLIB_CACHE")) || !*dir || !strcmp(dir, "off") ||
+        !strcmp(dir, "0")) {
+        return 0;
+    }
+    if (!strcmp(dir, "on") || !strcmp(dir, "1")) {
+        if (!(dir = getenv("TMPDIR")) && !(dir = getenv("TEMP")) &&
+            !(dir = getenv("TMP"))) {
+            dir = "/tmp";
+        }
+    }
+    for (p = file; *p; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 1099511628211ULL;
+    }
+    snprintf(path, len, "%s%cmatrtklib_obs_%016llx.bin", dir, FILEPATHSEP,
+             (unsigned long long)hash);
+    return 1;
+}
+/* write data to file and update checksum ----------------------------*/
+static int writedata(const void *data, const size_t size, const size_t n,
+                     FILE *fp, uint64_t *hash) {
+    if (n == 0) return 1;
+    *hash = checksum(*hash, data, size * n);
+    return fwrite(data, size, n, fp) == n;
+}
+/* open unique temporary file of cache file ---------------------------*/
+static FILE *opentmp(const char *path, char *tmppath, const int len) {
+#ifdef WIN32
+    snprintf(tmppath, len, "%s.%lu.tmp", path,
+             (unsigned long)GetCurrentProcessId());
+    return fopen(tmppath, "wb");
+#else
+    FILE *fp;
+    int fd;
+
+    snprintf(tmppath, len, "%s.XXXXXX", path);
+    if ((fd = mkstemp(tmppath)) < 0) return NULL;
+    if (!(fp = fdopen(fd, "wb"))) {
+        close(fd);
+        remove(tmppath);
+    }
+    return fp;
+#endif
+}
+/* create double matrix from cache data -------------------------------*/
+static mxArray *mxcachemat(const uint8_t **p, const int m, const int n) {
+    mxArray *mx = mxCreateUninitNumericMatrix(m, n, mxDOUBLE_CLASS, mxREAL);
+    memcpy(mxGetPr(mx), *p, sizeof(double) * m * n);
+    *p += sizeof(double) * m * n;
+    return mx;
+}
+
+/* cache is available for source file or not -------------------------*/
+extern int useobscache(const char *file) {
+    char path[1024];
+    int64_t size, mtime;
+
+    return cachepath(file, path, sizeof(path)) &&
+           getfileinfo(file, &size, &mtime) && strlen(file) < 1024;
+}
+/* open and validate cache file --------------------------------------*/
+/* return mapped cache file, NULL if no valid cache exists              */
+static const uint8_t *openobscache(const char *file, obsch_t *hd,
+                                   size_t *mapsize, void **h) {
+    const uint8_t *map;
+    char path[1024];
+    int64_t size, mtime;
+    size_t need;
+    int k, nfrq = 0;
+
+    if (!cachepath(file, path, sizeof(path))) return NULL;
+    if (!getfileinfo(file, &size, &mtime)) return NULL;
+    if (!(map = mapfile(path, mapsize, h))) return NULL;
+
+    /* validate cache key */
+    if (*mapsize < sizeof(obsch_t)) {
+        unmapfile(map, *mapsize, *h);
+        return NULL;
+    }
+    memcpy(hd, map, sizeof(obsch_t));
+    hd->path[sizeof(hd->path) - 1] = '\0';
+    if (strcmp(hd->magic, OBSCACHE_MAGIC) || hd->version != OBSCACHE_VER ||
+        hd->size != size || hd->mtime != mtime || strcmp(hd->path, file)) {
+        unmapfile(map, *mapsize, *h);
+        return NULL;
+    }
+    for (k = 0; k < NFREQ; k++) {
+        if (hd->frqmask & (1u << k)) nfrq++;
+    }
+    need = sizeof(obsch_t) + sizeof(double) * (hd->nsat + hd->n * 8) +
+           (sizeof(double) * NOBSTYPE * hd->n * hd->nsat +
+            ctypesize(hd->nsat)) * nfrq;
+    if (*mapsize != need ||
+        checksum(1469598103934665603ULL, map + sizeof(obsch_t),
+                 need - sizeof(obsch_t)) != hd->checksum) {
+        unmapfile(map, *mapsize, *h);
+        return NULL;
+    }
+    return map;
+}
+/* read observation data from cache -----------------------------------*/
+/* return 1 and set outputs if valid cache exists, 0 otherwise          */
+extern int readobscache(const char *file, const int *obsmask, mxArray **mxobs,
+                        double *pos, double *glo_fcn) {
+    obsch_t hd;
+    const uint8_t *map, *p;
+    char satstr[16];
+    size_t mapsize;
+    void *h;
+    int i, k, o, n, nsat, sel, prn;
+    double *sats, *prns, *syss;
+    mxArray *mxfrq, *mxctype, *mxsat, *mxprn, *mxsys, *mxsatstr;
+    const char *obsf[] = {"n",  "nsat", "sat",  "prn", "sys", "satstr",
+                          "ep", "tow",  "week"};
+
+    if (!(map = openobscache(file, &hd, &mapsize, &h))) return 0;
+    n = hd.n;
+    nsat = hd.nsat;
+    p = map + sizeof(obsch_t);
+
+    /* satellites */
+    mxsat = mxcachemat(&p, 1, nsat);
+    sats = mxGetPr(mxsat);
+    mxprn = mxCreateDoubleMatrix(1, nsat, mxREAL);
+    prns = mxGetPr(mxprn);
+    mxsys = mxCreateDoubleMatrix(1, nsat, mxREAL);
+    syss = mxGetPr(mxsys);
+    mxsatstr = mxCreateCellMatrix(1, nsat);
+    for (i = 0; i < nsat; i++) {
+        syss[i] = (double)satsys((int)sats[i], &prn);
+        prns[i] = (double)prn;
+        satno2id((int)sats[i], satstr);
+        mxSetCell(mxsatstr, i, mxCreateString(satstr));
+    }
+    *mxobs = mxCreateStructMatrix(1, 1, 9, obsf);
+    mxSetField(*mxobs, 0, "n", mxCreateDoubleScalar(n));
+    mxSetField(*mxobs, 0, "nsat", mxCreateDoubleScalar(nsat));
+    mxSetField(*mxobs, 0, "sat", mxsat);
+    mxSetField(*mxobs, 0, "prn", mxprn);
+    mxSetField(*mxobs, 0, "sys", mxsys);
+    mxSetField(*mxobs, 0, "satstr", mxsatstr);
+
+    /* time */
+    mxSetField(*mxobs, 0, "ep", mxcachemat(&p, n, 6));
+    mxSetField(*mxobs, 0, "tow", mxcachemat(&p, n, 1));
+    mxSetField(*mxobs, 0, "week", mxcachemat(&p, n, 1));
+
+    /* selected frequencies and observables */
+    for (k = 0; k < NFREQ; k++) {
+        if (!(hd.frqmask & (1u << k))) continue;
+        sel = obsmask ? obsmask[k] & OBSMASK_ALL : OBSMASK_ALL;
+        if (!sel) {
+            p += sizeof(double) * NOBSTYPE * n * nsat + ctypesize(nsat);
+            continue;
+        }
+        mxfrq = mxCreateStructMatrix(1, 1, 0, NULL);
+        for (o = 0; o < NOBSTYPE; o++) {
+            if (!(sel & (1 << o))) {
+                p += sizeof(double) * n * nsat;
+                continue;
+            }
+            mxAddField(mxfrq, OTYPE[o]);
+            mxSetField(mxfrq, 0, OTYPE[o], mxcachemat(&p, n, nsat));
+        }
+        mxctype = mxCreateCellMatrix(1, nsat);
+        for (i = 0; i < nsat; i++) {
+            mxSetCell(mxctype, i, mxCreateString(code2obs(p[i])));
+        }
+        p += ctypesize(nsat);
+        mxAddField(mxfrq, "ctype");
+        mxSetField(mxfrq, 0, "ctype", mxctype);
+        mxAddField(*mxobs, FTYPE[k]);
+        mxSetField(*mxobs, 0, FTYPE[k], mxfrq);
+    }
+    memcpy(pos, hd.pos, sizeof(double) * 3);
+    memcpy(glo_fcn, hd.glo_fcn, sizeof(double) * 32);
+
+    unmapfile(map, mapsize, h);
+    return 1;
+}
+/* cached value to observation data (NaN: no data) -------------------*/
+static double cacheval(const double *p, const int idx) {
+    return p && !mxIsNaN(p[idx]) ? p[idx] : 0.0;
+}
+/* observation record exists in cache or not (any of P,L,D,S) --------*/
+static int hasrecord(const double *od[NFREQ][NOBSTYPE], const int idx) {
+    int k, o;
+
+    for (k = 0; k < NFREQ; k++) {
+        for (o = 0; o < 4; o++) {
+            if (od[k][o] && !mxIsNaN(od[k][o][idx])) return 1;
+        }
+    }
+    return 0;
+}
+/* read observation records from cache --------------------------------*/
+/* records of selected epochs and satellites are restored from cache.   */
+/* return observation data (NULL if no valid cache exists)              */
+extern obsd_t *readobscacheobs(const char *file, const obssel_t *sel,
+                               int *nout, int **nobslist, double *pos,
+                               double *glo_fcn) {
+    obsch_t hd;
+    obsd_t *obs = NULL, *data;
+    const uint8_t *map, *p, *ctype[NFREQ] = {0};
+    const double *sat, *tow, *week, *od[NFREQ][NOBSTYPE] = {{0}};
+    uint8_t *valid;
+    size_t mapsize;
+    void *h;
+    int i, j, k, o, n, nsat, nobs = 0, ne = 0, iobs = 0, *ns, l;
+    double v;
+
+    if (!(map = openobscache(file, &hd, &mapsize, &h))) return NULL;
+    n = hd.n;
+    nsat = hd.nsat;
+    p = map + sizeof(obsch_t);
+    sat = (const double *)p;
+    p += sizeof(double) * (nsat + n * 6);
+    tow = (const double *)p;
+    week = tow + n;
+    p += sizeof(double) * n * 2;
+    for (k = 0; k < NFREQ; k++) {
+        if (!(hd.frqmask & (1u << k))) continue;
+        for (o = 0; o < NOBSTYPE; o++) {
+            od[k][o] = (const double *)p;
+            p += sizeof(double) * n * nsat;
+        }
+        ctype[k] = p;
+        p += ctypesize(nsat);
+    }
+    if (!(valid = (uint8_t *)calloc(nsat + 1, sizeof(uint8_t))) ||
+        !(ns = (int *)calloc(n + 1, sizeof(int)))) {
+        free(valid);
+        unmapfile(map, mapsize, h);
+        return NULL;
+    }
+    /* selected satellites */
+    for (j = 0; j < nsat; j++) {
+        valid[j] = (satsys((int)sat[j], NULL) & sel->navsys) &&
+                   !sel->exsats[(int)sat[j] - 1];
+    }
+    /* count records of selected epochs */
+    for (i = 0; i < n; i++) {
+        if (!screent(gpst2time((int)week[i], tow[i]), sel->ts, sel->te,
+                     sel->tint)) {
+            ns[i] = -1;
+            continue;
+        }
+        for (j = 0; j < nsat; j++) {
+            if (valid[j] && hasrecord(od, i + n * j)) ns[i]++;
+        }
+        if (ns[i] > 0) {
+            nobs += ns[i];
+            ne++;
+        }
+    }
+    if (!(obs = (obsd_t *)calloc(nobs + 1, sizeof(obsd_t))) ||
+        !(*nobslist = (int *)calloc(ne + 1, sizeof(int)))) {
+        free(obs);
+        free(valid);
+        free(ns);
+        unmapfile(map, mapsize, h);
+        return NULL;
+    }
+    /* restore records */
+    for (i = 0, ne = 0; i < n; i++) {
+        if (ns[i] <= 0) continue;
+        (*nobslist)[ne++] = ns[i];
+        for (j = 0; j < nsat; j++) {
+            if (!valid[j] || !hasrecord(od, i + n * j)) continue;
+            data = obs + iobs;
+            l = i + n * j;
+            for (k = 0; k < NFREQ; k++) {
+                if (!od[k][0]) continue;
+                data->P[k] = cacheval(od[k][0], l);
+                data->L[k] = cacheval(od[k][1], l);
+                data->D[k] = (float)cacheval(od[k][2], l);
+                v = cacheval(od[k][3], l);
+                data->SNR[k] = (uint16_t)(v / SNR_UNIT + 0.5);
+                data->LLI[k] = (uint8_t)cacheval(od[k][4], l);
+                data->code[k] = ctype[k][j];
+            }
+            data->time = gpst2time((int)week[i], tow[i]);
+            data->sat = (int)sat[j];
+            data->rcv = 1;
+            iobs++;
+        }
+    }
+    *nout = ne;
+    memcpy(pos, hd.pos, sizeof(double) * 3);
+    memcpy(glo_fcn, hd.glo_fcn, sizeof(double) * 32);
+
+    free(valid);
+    free(ns);
+    unmapfile(map, mapsize, h);
+    return obs;
+}
+/* write observation data to cache ------------------------------------*/
+/* mxobs must be output of obs2mxobs with all observables selected      */
+extern void writeobscache(const char *file, const mxArray *mxobs,
+                          const double *pos, const double *glo_fcn) {
+    FILE *fp;
+    obsch_t hd = {{0}};
+    char path[1024], tmppath[1040], code[8];
+    uint8_t *ctype;
+    int i, k, o, n, nsat;
+    const mxArray *mxfrq, *mxod;
+    uint64_t hash = 1469598103934665603ULL;
+    int ok = 1;
+
+    if (!cachepath(file, path, sizeof(path))) return;
+    if (strlen(file) >= sizeof(hd.path)) return;
+
+    strcpy(hd.magic, OBSCACHE_MAGIC);
+    hd.version = OBSCACHE_VER;
+    if (!getfileinfo(file, &hd.size, &hd.mtime)) return;
+    hd.n = n = (int)mxGetScalar(mxGetField(mxobs, 0, "n"));
+    hd.nsat = nsat = (int)mxGetScalar(mxGetField(mxobs, 0, "nsat"));
+    memcpy(hd.pos, pos, sizeof(double) * 3);
+    memcpy(hd.glo_fcn, glo_fcn, sizeof(double) * 32);
+    strcpy(hd.path, file);
+    for (k = 0; k < NFREQ; k++) {
+        if (!(mxfrq = mxGetField(mxobs, 0, FTYPE[k]))) continue;
+        for (o = 0; o < NOBSTYPE; o++) {
+            if (!mxGetField(mxfrq, 0, OTYPE[o])) return;
+        }
+        hd.frqmask |= 1u << k;
+    }
+    if (!(ctype = (uint8_t *)calloc(ctypesize(nsat) + 1, sizeof(uint8_t)))) {
+        return;
+    }
+    /* write to unique temporary file and rename */
+    if (!(fp = opentmp(path, tmppath, sizeof(tmppath)))) {
+        free(ctype);
+        return;
+    }
+    ok &= fwrite(&hd, sizeof(obsch_t), 1, fp) == 1; /* checksum written later */
+    ok &= writedata(mxGetPr(mxGetField(mxobs, 0, "sat")), sizeof(double),
+                      nsat, fp, &hash);
+    ok &= writedata(mxGetPr(mxGetField(mxobs, 0, "ep")), sizeof(double),
+                      n * 6, fp, &hash);
+    ok &= writedata(mxGetPr(mxGetField(mxobs, 0, "tow")), sizeof(double),
+                      n, fp, &hash);
+    ok &= writedata(mxGetPr(mxGetField(mxobs, 0, "week")), sizeof(double),
+                      n, fp, &hash);
+    for (k = 0; k < NFREQ; k++) {
+        if (!(hd.frqmask & (1u << k))) continue;
+        mxfrq = mxGetField(mxobs, 0, FTYPE[k]);
+        for (o = 0; o < NOBSTYPE; o++) {
+            mxod = mxGetField(mxfrq, 0, OTYPE[o]);
+            ok &= writedata(mxGetPr(mxod), sizeof(double), n * nsat, fp,
+                            &hash);
+        }
+        memset(ctype, 0, ctypesize(nsat));
+        for (i = 0; i < nsat; i++) {
+            mxGetString(mxGetCell(mxGetField(mxfrq, 0, "ctype"), i), code,
+                        sizeof(code));
+            ctype[i] = obs2code(code);
+        }
+        ok &= writedata(ctype, 1, ctypesize(nsat), fp, &hash);
+    }
+    hd.checksum = hash;
+    ok &= fseek(fp, 0, SEEK_SET) == 0 &&
+          fwrite(&hd, sizeof(obsch_t), 1, fp) == 1;
+    ok &= fclose(fp) == 0;
+    free(ctype);
+
+    if (!ok) {
+        remove(tmppath);
+        return;
+    }
+#ifdef WIN32
+    remove(path); /* rename does not replace existing file */
+#endif
+    if (rename(tmppath, path) != 0) remove(tmppath);
+}
+/* remove unselected observables from obs2mxobs output ----------------*/
+extern void pruneobs(mxArray *mxobs, const int *obsmask) {
+    mxArray *mxfrq;
+    int k, o;
+
+    if (!obsmask) return;
+    for (k = 0; k < NFREQ; k++) {
+        if (!(mxfrq = mxGetField(mxobs, 0, FTYPE[k]))) continue;
+        if (!(obsmask[k] & OBSMASK_ALL)) {
+            mxDestroyArray(mxfrq);
+            mxRemoveField(mxobs, mxGetFieldNumber(mxobs, FTYPE[k]));
+            continue;
+        }
+        for (o = 0; o < NOBSTYPE; o++) {
+            if (obsmask[k] & (1 << o)) continue;
+            mxDestroyArray(mxGetField(mxfrq, 0, OTYPE[o]));
+            mxRemoveField(mxfrq, mxGetFieldNumber(mxfrq, OTYPE[o]));
+        }
+    }
+}
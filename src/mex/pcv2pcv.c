@@ -48,6 +48,26 @@ extern mxArray *pcv2mxpcv(const pcv_t *pcvs, const int n) {
     return mxpcvs;
 }
 
+/* mxpcv2pcv (i-th element) ------------------------------------------*/
+extern void mxpcv2pcvi(const mxArray *mxpcvs, const int i, pcv_t *pcv) {
+    /* sat */
+    pcv->sat = (int)mxGetScalar(mxGetField(mxpcvs, i, "sat"));
+
+    /* type,code */
+    mxGetString(mxGetField(mxpcvs, i, "type"), pcv->type, sizeof(pcv->type));
+    mxGetString(mxGetField(mxpcvs, i, "code"), pcv->code, sizeof(pcv->code));
+
+    /* ts,te */
+    pcv->ts = epoch2time((double *)mxGetPr(mxGetField(mxpcvs, i, "ts")));
+    pcv->te = epoch2time((double *)mxGetPr(mxGetField(mxpcvs, i, "te")));
+
+    /* off,var */
+    memcpy(pcv->off, (double *)mxGetPr(mxGetField(mxpcvs, i, "off")),
+           NFREQ * 3 * sizeof(double));
+    memcpy(pcv->var, (double *)mxGetPr(mxGetField(mxpcvs, i, "var")),
+           NFREQ * 19 * sizeof(double));
+}
+
 /* mxpcv2pcv ----------------------------------------------------------*/
 extern void mxpcv2pcv(const mxArray *mxpcvs, const int n, pcv_t *pcvs) {
     int i;
@@ -56,24 +76,5 @@ extern void mxpcv2pcv(const mxArray *mxpcvs, const int n, pcv_t *pcvs) {
     /* check nav struct */
     mxCheckStruct(mxpcvs, pcvf, 7);
 
-    for (i = 0; i < n; i++) {
-        /* sat */
-        pcvs[i].sat = (int)mxGetScalar(mxGetField(mxpcvs, i, "sat"));
-
-        /* type,code */
-        mxGetString(mxGetField(mxpcvs, i, "type"), pcvs[i].type,
-                    sizeof(pcvs[i].type));
-        mxGetString(mxGetField(mxpcvs, i, "code"), pcvs[i].code,
-                    sizeof(pcvs[i].code));
-
-        /* ts,te */
-        pcvs[i].ts = epoch2time((double *)mxGetPr(mxGetField(mxpcvs, i, "ts")));
-        pcvs[i].te = epoch2time((double *)mxGetPr(mxGetField(mxpcvs, i, "te")));
-
-        /* off,var */
-        memcpy(pcvs[i].off, (double *)mxGetPr(mxGetField(mxpcvs, i, "off")),
-               NFREQ * 3 * sizeof(double));
-        memcpy(pcvs[i].var, (double *)mxGetPr(mxGetField(mxpcvs, i, "var")),
-               NFREQ * 19 * sizeof(double));
-    }
+    for (i = 0; i < n; i++) mxpcv2pcvi(mxpcvs, i, pcvs + i);
 }
\ No newline at end of file
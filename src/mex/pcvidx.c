@@ -0,0 +1,212 @@
+/**
+ * @file pcvidx.c
+ * @brief Persistent index of antenna parameters (ANTEX/NGS PCV file)
+ * @author Taro Suzuki
+ * @note PCV file is parsed once per path (re-parsed if modified) and kept
+ * until mex file is cleared (or core is freed)
+ * @note Satellite antennas are indexed by satellite number and receiver
+ * antennas by antenna type (first two words), results of lookup are the
+ * same as "searchpcv" in rtkcmn.c
+ */
+
+#include "mex_utility.h"
+
+#include <sys/stat.h>
+
+#define MAXPCVIDX 16 /* max number of indexed PCV files */
+
+static pcvidx_t *idxs[MAXPCVIDX]; /* indexed PCV files */
+static int nidx = 0;              /* number of indexed PCV files */
+
+/* PCV file size and modified time ------------------------------------*/
+static int getfileinfo(const char *file, int64_t *size, int64_t *mtime) {
+#ifdef WIN32
+    struct _stat64 st;
+    if (_stat64(file, &st) != 0) return 0;
+#else
+    struct stat st;
+    if (stat(file, &st) != 0) return 0;
+#endif
+    *size = (int64_t)st.st_size;
+    *mtime = (int64_t)st.st_mtime;
+    return 1;
+}
+/* antenna type key (first two words separated by spaces) -------------*/
+/* same words as strtok in searchpcv, but reentrant                      */
+static int typekey(const char *type, char *key, char **words) {
+    char *p;
+    int n = 0;
+
+    strncpy(key, type, MAXANT - 1);
+    key[MAXANT - 1] = '\0';
+    for (p = key; *p && n < 2;) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        words[n++] = p;
+        while (*p && *p != ' ') p++;
+        if (*p) *p++ = '\0';
+    }
+    return n;
+}
+/* hash of key (FNV-1a) -----------------------------------------------*/
+static uint32_t hashkey(char *const *words, const int n) {
+    uint32_t hash = 2166136261U;
+    const char *p;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        for (p = words[i]; *p; p++) {
+            hash ^= (uint8_t)*p;
+            hash *= 16777619U;
+        }
+        hash ^= (uint8_t)' ';
+        hash *= 16777619U;
+    }
+    return hash;
+}
+/* hash table slot of key (empty slot if not found) -------------------*/
+static int findslot(const pcvidx_t *idx, char *const *words, const int n) {
+    const pcv_t *pcv;
+    char key[MAXANT], *w[2];
+    int i, j;
+
+    i = (int)(hashkey(words, n) & (uint32_t)(idx->nhash - 1));
+    for (; idx->rec[i] >= 0; i = (i + 1) & (idx->nhash - 1)) {
+        pcv = idx->pcvs.pcv + idx->krec[i];
+        if (typekey(pcv->type, key, w) != n) continue;
+        for (j = 0; j < n; j++) {
+            if (strcmp(w[j], words[j])) break;
+        }
+        if (j >= n) break;
+    }
+    return i;
+}
+/* build index --------------------------------------------------------*/
+static int buildindex(pcvidx_t *idx) {
+    const pcv_t *pcv;
+    char key[MAXANT], *words[2];
+    int i, j, k, r, n;
+
+    for (i = 0; i <= MAXSAT; i++) idx->first[i] = -1;
+    idx->nhash = 16;
+    while (idx->nhash < 2 * idx->pcvs.n) idx->nhash *= 2;
+    if (!(idx->next = (int *)malloc(sizeof(int) * (idx->pcvs.n + 1))) ||
+        !(idx->krec = (int *)malloc(sizeof(int) * idx->nhash)) ||
+        !(idx->rec = (int *)malloc(sizeof(int) * idx->nhash))) {
+        return 0;
+    }
+    for (i = 0; i < idx->nhash; i++) idx->rec[i] = -1;
+
+    /* satellite antennas (linked in file order) */
+    for (i = idx->pcvs.n - 1; i >= 0; i--) {
+        pcv = idx->pcvs.pcv + i;
+        idx->next[i] = -1;
+        if (pcv->sat <= 0 || pcv->sat > MAXSAT) continue;
+        idx->next[i] = idx->first[pcv->sat];
+        idx->first[pcv->sat] = i;
+    }
+    /* antenna types (first record containing all words of type) */
+    for (i = 0; i < idx->pcvs.n; i++) {
+        if ((n = typekey(idx->pcvs.pcv[i].type, key, words)) <= 0) continue;
+        if (idx->rec[k = findslot(idx, words, n)] >= 0) continue;
+        for (r = 0; r <= i; r++) {
+            for (j = 0; j < n; j++) {
+                if (!strstr(idx->pcvs.pcv[r].type, words[j])) break;
+            }
+            if (j >= n) break;
+        }
+        idx->krec[k] = i;
+        idx->rec[k] = r;
+    }
+    return 1;
+}
+/* free index ---------------------------------------------------------*/
+static void freeindex(pcvidx_t *idx) {
+    free(idx->pcvs.pcv);
+    free(idx->next);
+    free(idx->krec);
+    free(idx->rec);
+    free(idx);
+}
+/* read PCV file and build index --------------------------------------*/
+static pcvidx_t *readindex(const char *file, int64_t size, int64_t mtime) {
+    pcvidx_t *idx;
+
+    if (!(idx = (pcvidx_t *)calloc(1, sizeof(pcvidx_t)))) return NULL;
+    strncpy(idx->file, file, sizeof(idx->file) - 1);
+    idx->size = size;
+    idx->mtime = mtime;
+    if (!readpcv(file, &idx->pcvs) || !buildindex(idx)) {
+        freeindex(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+/* indexed PCV file (NULL: read error) --------------------------------*/
+extern const pcvidx_t *pcvindex(const char *file) {
+    pcvidx_t *idx = NULL;
+    int64_t size = 0, mtime = 0;
+    int i;
+
+    getfileinfo(file, &size, &mtime);
+
+#pragma omp critical(pcvindex)
+    {
+        for (i = 0; i < nidx; i++) {
+            if (strcmp(idxs[i]->file, file)) continue;
+            if (idxs[i]->size == size && idxs[i]->mtime == mtime) {
+                idx = idxs[i];
+            } else { /* modified */
+                freeindex(idxs[i]);
+                memmove(idxs + i, idxs + i + 1,
+                        sizeof(pcvidx_t *) * (nidx - i - 1));
+                nidx--;
+            }
+            break;
+        }
+        if (!idx && (idx = readindex(file, size, mtime))) {
+            if (nidx >= MAXPCVIDX) { /* replace oldest index */
+                freeindex(idxs[0]);
+                memmove(idxs, idxs + 1, sizeof(pcvidx_t *) * (MAXPCVIDX - 1));
+                nidx--;
+            }
+            idxs[nidx++] = idx;
+        }
+    }
+    return idx;
+}
+/* search antenna parameter (same as searchpcv) -----------------------*/
+extern const pcv_t *searchpcvidx(const pcvidx_t *idx, const int sat,
+                                 const char *type, const gtime_t time) {
+    const pcv_t *pcv;
+    char key[MAXANT], *words[2];
+    int i, n;
+
+    if (sat) { /* satellite antenna */
+        if (sat < 0 || sat > MAXSAT) return NULL;
+        for (i = idx->first[sat]; i >= 0; i = idx->next[i]) {
+            pcv = idx->pcvs.pcv + i;
+            if (pcv->ts.time != 0 && timediff(pcv->ts, time) > 0.0) continue;
+            if (pcv->te.time != 0 && timediff(pcv->te, time) < 0.0) continue;
+            return pcv;
+        }
+        return NULL;
+    }
+    /* receiver antenna (linear search if type is not in index) */
+    if ((n = typekey(type, key, words)) <= 0) return NULL;
+    if ((i = idx->rec[findslot(idx, words, n)]) >= 0) return idx->pcvs.pcv + i;
+    return searchpcv(0, type, time, &idx->pcvs);
+}
+/* number of indexed PCV files ----------------------------------------*/
+extern int npcvindex(void) { return nidx; }
+
+/* free all indexes ---------------------------------------------------*/
+extern void freepcvindex(void) {
+    int i;
+
+    for (i = 0; i < nidx; i++) freeindex(idxs[i]);
+    nidx = 0;
+}
@@ -4,6 +4,9 @@
  * @author Taro Suzuki
  * @note Wrapper for "peph2pos" in preeph.c
  * @note Support vector inputs
+ * @note Computed by batch version of "peph2pos" (pephv.c), satellites are
+ * processed in parallel by OpenMP (single thread with antenna offset, opt=1)
+ * @note States in satellite state cache are not computed (satcache.c)
  */
 
 #include "mex_utility.h"
@@ -13,25 +16,35 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
-    gtime_t time;
-    int i, j, m, nsat, opt;
-    double ep[6], *eps, *sats, rs[6], dts[2], var;
-    double *x, *y, *z, *vx, *vy, *vz, *dtss, *ddtss, *vars;
+    nav_t nav = {0}, *navp;
+    satcache_t *cache;
+    satkey_t key = {0};
+    satstate_t st = {0};
+    gtime_t *times;
+    int i, j, k, l, n, m, nsat, opt, nthread, *isats, *jsat;
+    uint8_t *nodata, *hit = NULL, *nodatas;
+    perf_t perf;
+    double ep[6], *eps, *sats, *buf, *tmp[9];
+    double *x, *y, *z, *vx, *vy, *vz, *dtss, *ddtss, *vars, *rs[6], *dts[2];
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
     mxCheckSizeOfColumns(argin[0], 6); /* epochs*/
     mxCheckSizeOfRows(argin[1], 1);    /* sats */
     mxCheckScalar(argin[3]);           /* opt */
+    perfstart(&perf, "peph2pos");
 
     /* inputs */
     eps = (double *)mxGetPr(argin[0]);
     m = (int)mxGetM(argin[0]);
     sats = (double *)mxGetPr(argin[1]);
     nsat = (int)mxGetN(argin[1]);
-    nav = mxnav2nav(argin[2]);
+    navp = mxnav2navp(argin[2], &nav);
     opt = (int)mxGetScalar(argin[3]);
+    nthread = mxGetNumThreads(nargin, argin, 4);
+    if (opt) nthread = 1; /* satantoff is not thread-safe (ephNumThreads) */
+    perfalloc(&perf, perfnav(navp, &nav) + (double)m * nsat);
+    perflap(&perf, PERF_IN);
 
     /* outputs */
     argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
@@ -62,37 +75,122 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     vars = mxGetPr(argout[8]);
     mxSetNaN(vars, m * nsat);
 
-    /* call RTKLIB function */
+    /* satellites without precise ephemeris (printed after parallel loop) */
+    nodata = (uint8_t *)calloc((size_t)m * nsat + 1, 1);
+    times = (gtime_t *)malloc(sizeof(gtime_t) * (m + 1));
+    isats = (int *)malloc(sizeof(int) * (nsat + 1));
+    jsat = (int *)malloc(sizeof(int) * (nsat + 1));
+    if (!nodata || !times || !isats || !jsat) {
+        free(nodata);
+        free(times);
+        free(isats);
+        free(jsat);
+        freenavp(navp, &nav);
+        mexErrMsgTxt("peph2pos: memory allocation error");
+    }
     for (i = 0; i < m; i++) {
-        ep[0] = eps[i + m * 0];
-        ep[1] = eps[i + m * 1];
-        ep[2] = eps[i + m * 2];
-        ep[3] = eps[i + m * 3];
-        ep[4] = eps[i + m * 4];
-        ep[5] = eps[i + m * 5];
-        time = epoch2time(ep);
+        for (k = 0; k < 6; k++) ep[k] = eps[i + m * k];
+        times[i] = epoch2time(ep);
+    }
+    for (j = 0; j < nsat; j++) isats[j] = (int)sats[j];
+    rs[0] = x;
+    rs[1] = y;
+    rs[2] = z;
+    rs[3] = vx;
+    rs[4] = vy;
+    rs[5] = vz;
+    dts[0] = dtss;
+    dts[1] = ddtss;
+    perflap(&perf, PERF_OUT);
 
-        for (j = 0; j < nsat; j++) {
-            /* satellite position/clock by precise ephemeris/clock */
-            if (!peph2pos(time, (int)sats[j], &nav, opt, rs, dts, &var)) {
-                mexPrintf("no precise ephemeris %s sat=%2d\n",
-                          time_str(time, 3), (int)sats[j]);
-                continue;
+    /* satellite states in cache */
+    key.nav = mxnavhid(argin[2]);
+    key.func = SATC_PEPH2POS;
+    key.opt = opt;
+    if ((cache = satcacheopen(SATC_PEPH2POS, key.nav)) &&
+        (hit = (uint8_t *)calloc((size_t)m * nsat + 1, 1))) {
+        for (i = 0; i < m; i++) {
+            key.time = times[i];
+            for (j = 0; j < nsat; j++) {
+                key.sat = isats[j];
+                if (!(hit[i + m * j] = satcacheget(cache, &key, &st))) continue;
+                if (!st.stat) {
+                    nodata[i + m * j] = 1;
+                    continue;
+                }
+                for (k = 0; k < 6; k++) rs[k][i + m * j] = st.rs[k];
+                dts[0][i + m * j] = st.dts[0];
+                dts[1][i + m * j] = st.dts[1];
+                vars[i + m * j] = st.var;
             }
+        }
+    }
+    /* satellites with states not in cache */
+    for (j = n = 0; j < nsat; j++) {
+        for (i = 0; hit && i < m && hit[i + m * j]; i++);
+        if (hit && i >= m) continue;
+        isats[n] = isats[j];
+        jsat[n++] = j;
+    }
+    /* satellite position/clock by precise ephemeris/clock */
+    if (n == nsat) {
+        peph2posv(times, m, isats, nsat, navp, opt, nthread, rs, dts, vars,
+                  nodata);
+    } else if (n > 0) { /* computed in buffer and copied except cached */
+        if (!(buf = (double *)malloc(sizeof(double) * 9 * m * n)) ||
+            !(nodatas = (uint8_t *)calloc((size_t)m * n, 1))) {
+            free(buf);
+            mexErrMsgTxt("peph2pos: memory allocation error");
+        }
+        for (k = 0; k < 9; k++) {
+            tmp[k] = buf + (size_t)k * m * n;
+            mxSetNaN(tmp[k], m * n);
+        }
+        peph2posv(times, m, isats, n, navp, opt, nthread, tmp, tmp + 6, tmp[8],
+                  nodatas);
+        for (k = 0; k < n; k++) {
+            j = jsat[k];
+            for (i = 0; i < m; i++) {
+                if (hit[i + m * j]) continue;
+                for (l = 0; l < 6; l++) rs[l][i + m * j] = tmp[l][i + m * k];
+                dts[0][i + m * j] = tmp[6][i + m * k];
+                dts[1][i + m * j] = tmp[7][i + m * k];
+                vars[i + m * j] = tmp[8][i + m * k];
+                nodata[i + m * j] = nodatas[i + m * k];
+            }
+        }
+        free(buf);
+        free(nodatas);
+    }
+    /* computed satellite states to cache */
+    for (j = 0; hit && j < nsat; j++) {
+        key.sat = (int)sats[j];
+        for (i = 0; i < m; i++) {
+            if (hit[i + m * j]) continue;
+            key.time = times[i];
+            st.stat = !nodata[i + m * j];
+            for (k = 0; k < 6; k++) st.rs[k] = rs[k][i + m * j];
+            st.dts[0] = dts[0][i + m * j];
+            st.dts[1] = dts[1][i + m * j];
+            st.var = vars[i + m * j];
+            satcacheput(cache, &key, &st);
+        }
+    }
+    perflap(&perf, PERF_COMP);
 
-            x[i + m * j] = rs[0];
-            y[i + m * j] = rs[1];
-            z[i + m * j] = rs[2];
-            vx[i + m * j] = rs[3];
-            vy[i + m * j] = rs[4];
-            vz[i + m * j] = rs[5];
-            dtss[i + m * j] = dts[0];
-            ddtss[i + m * j] = dts[1];
-            vars[i + m * j] = var;
+    /* messages in order of serial loop */
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < nsat; j++) {
+            if (!nodata[i + m * j]) continue;
+            mexPrintf("no precise ephemeris %s sat=%2d\n",
+                      time_str(times[i], 3), (int)sats[j]);
         }
     }
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
+    free(nodata);
+    free(hit);
+    free(times);
+    free(isats);
+    free(jsat);
+    freenavp(navp, &nav);
+    perfend(&perf);
 }
@@ -0,0 +1,317 @@
+/**
+ * @file pephv.c
+ * @brief Batch satellite position/clock by precise ephemeris/clock
+ * @author Taro Suzuki
+ * @note Batch version of "peph2pos" in preceph.c with the same windows,
+ * earth rotation correction, clock interpolation and variances
+ * @note Query epochs are sorted and SP3/clock indexes are walked from the
+ * previous query per satellite instead of binary search, series of each
+ * satellite are copied to contiguous arrays, and satellites are processed in
+ * parallel by OpenMP
+ * @note Orbit is interpolated by Neville's algorithm with the same node time
+ * differences (timediff), earth rotation correction and operation order as
+ * pephpos, so that positions and finite-difference velocities are identical
+ * to peph2pos
+ * @note Satellites are processed by one thread with antenna offset (opt=1),
+ * since satantoff (sunmoonpos) is not thread-safe
+ */
+
+#include "mex_utility.h"
+
+#include <math.h>
+
+#define NMAX 10          /* order of polynomial interpolation */
+#define MAXDTE 900.0     /* max time difference to ephem time (s) */
+#define EXTERR_CLK 1E-3  /* extrapolation error for clock (m/s) */
+#define EXTERR_EPH 5E-7  /* extrapolation error for ephem (m/s^2) */
+#define TTVEL 1E-3       /* time difference for velocity/drift (s) */
+
+/* shared tables of precise ephemeris/clock epochs */
+typedef struct {
+    int ne, nc;          /* number of ephemeris/clock epochs */
+    const gtime_t *te;   /* ephemeris epochs */
+    const gtime_t *tc;   /* clock epochs */
+} pephtbl_t;
+
+/* series of a satellite */
+typedef struct {
+    double *pos;         /* ephemeris x,y,z,clk (pos[k*4+i]) */
+    double *std;         /* ephemeris std x,y,z,clk (std[k*4+i]) */
+    int *nout;           /* number of outages before epoch k (ne+1) */
+    double *clk, *cstd;  /* precise clock and std */
+    int ie, ic;          /* current index of ephemeris/clock (lower bound) */
+} pephser_t;
+
+/* copy series of satellite -------------------------------------------*/
+static int getseries(const nav_t *nav, const int sat, pephser_t *s) {
+    const double *pos;
+    int k, i;
+
+    if (!(s->pos = (double *)malloc(sizeof(double) * 4 * (nav->ne + 1))) ||
+        !(s->std = (double *)malloc(sizeof(double) * 4 * (nav->ne + 1))) ||
+        !(s->nout = (int *)malloc(sizeof(int) * (nav->ne + 1))) ||
+        !(s->clk = (double *)malloc(sizeof(double) * (nav->nc + 1))) ||
+        !(s->cstd = (double *)malloc(sizeof(double) * (nav->nc + 1)))) {
+        return 0;
+    }
+    s->nout[0] = 0;
+    for (k = 0; k < nav->ne; k++) {
+        pos = nav->peph[k].pos[sat - 1];
+        for (i = 0; i < 4; i++) {
+            s->pos[k * 4 + i] = pos[i];
+            s->std[k * 4 + i] = nav->peph[k].std[sat - 1][i];
+        }
+        s->nout[k + 1] = s->nout[k] + (norm(pos, 3) <= 0.0);
+    }
+    for (k = 0; k < nav->nc; k++) {
+        s->clk[k] = nav->pclk[k].clk[sat - 1][0];
+        s->cstd[k] = nav->pclk[k].std[sat - 1][0];
+    }
+    s->ie = s->ic = 0;
+    return 1;
+}
+/* free series --------------------------------------------------------*/
+static void freeseries(pephser_t *s) {
+    free(s->pos);
+    free(s->std);
+    free(s->nout);
+    free(s->clk);
+    free(s->cstd);
+    s->pos = s->std = s->clk = s->cstd = NULL;
+    s->nout = NULL;
+}
+/* lower bound of sorted epochs by walk from current index (same as
+ * binary search in pephpos/pephclk, last index if all are before t) ----*/
+static int walkindex(const gtime_t *te, const int n, int i, const gtime_t t) {
+    while (i > 0 && timediff(te[i - 1], t) >= 0.0) i--;
+    while (i < n - 1 && timediff(te[i], t) < 0.0) i++;
+    return i;
+}
+/* polynomial interpolation by Neville's algorithm (same as interppol) -*/
+static double interppolv(const double *x, double *y, const int n) {
+    int i, j;
+
+    for (j = 1; j < n; j++) {
+        for (i = 0; i < n - j; i++) {
+            y[i] = (x[i + j] * y[i] - x[i] * y[i + 1]) / (x[i + j] - x[i]);
+        }
+    }
+    return y[0];
+}
+/* satellite position by precise ephemeris (same as pephpos) ----------*/
+static int pephposv(const pephtbl_t *tbl, pephser_t *s, const gtime_t t,
+                    double *rs, double *dts, double *vare, double *varc) {
+    const double *p;
+    double dt[NMAX + 1], y[3][NMAX + 1], c[2], tc[2], cosl, sinl;
+    double std = 0.0, sd[3];
+    int i, j, k, index;
+
+    rs[0] = rs[1] = rs[2] = dts[0] = 0.0;
+
+    if (tbl->ne < NMAX + 1 || timediff(t, tbl->te[0]) < -MAXDTE ||
+        timediff(t, tbl->te[tbl->ne - 1]) > MAXDTE) {
+        return 0;
+    }
+    s->ie = walkindex(tbl->te, tbl->ne, s->ie, t);
+    index = s->ie <= 0 ? 0 : s->ie - 1;
+
+    /* window of polynomial interpolation for orbit */
+    i = index - (NMAX + 1) / 2;
+    if (i < 0) i = 0;
+    else if (i + NMAX >= tbl->ne) i = tbl->ne - NMAX - 1;
+    if (s->nout[i + NMAX + 1] - s->nout[i] > 0) return 0; /* outage */
+
+    /* earth rotation correction */
+    for (j = 0; j <= NMAX; j++) {
+        k = i + j;
+        dt[j] = timediff(tbl->te[k], t);
+        p = s->pos + k * 4;
+        sinl = sin(OMGE * dt[j]);
+        cosl = cos(OMGE * dt[j]);
+        y[0][j] = cosl * p[0] - sinl * p[1];
+        y[1][j] = sinl * p[0] + cosl * p[1];
+        y[2][j] = p[2];
+    }
+    for (k = 0; k < 3; k++) rs[k] = interppolv(dt, y[k], NMAX + 1);
+
+    if (vare) {
+        for (k = 0; k < 3; k++) sd[k] = s->std[index * 4 + k];
+        std = norm(sd, 3);
+
+        /* extrapolation error for orbit */
+        if (dt[0] > 0.0) std += EXTERR_EPH * SQR(dt[0]) / 2.0;
+        else if (dt[NMAX] < 0.0) std += EXTERR_EPH * SQR(dt[NMAX]) / 2.0;
+        *vare = SQR(std);
+    }
+    /* linear interpolation for clock */
+    tc[0] = timediff(t, tbl->te[index]);
+    tc[1] = timediff(t, tbl->te[index + 1]);
+    c[0] = s->pos[index * 4 + 3];
+    c[1] = s->pos[(index + 1) * 4 + 3];
+
+    if (tc[0] <= 0.0) {
+        if ((dts[0] = c[0]) != 0.0) {
+            std = s->std[index * 4 + 3] * CLIGHT - EXTERR_CLK * tc[0];
+        }
+    } else if (tc[1] >= 0.0) {
+        if ((dts[0] = c[1]) != 0.0) {
+            std = s->std[(index + 1) * 4 + 3] * CLIGHT + EXTERR_CLK * tc[1];
+        }
+    } else if (c[0] != 0.0 && c[1] != 0.0) {
+        dts[0] = (c[1] * tc[0] - c[0] * tc[1]) / (tc[0] - tc[1]);
+        i = tc[0] < -tc[1] ? 0 : 1;
+        std = s->std[(index + i) * 4 + 3] + EXTERR_CLK * fabs(tc[i]);
+    } else {
+        dts[0] = 0.0;
+    }
+    if (varc) *varc = SQR(std);
+    return 1;
+}
+/* satellite clock by precise clock (same as pephclk) -----------------*/
+static int pephclkv(const pephtbl_t *tbl, pephser_t *s, const gtime_t t,
+                    double *dts, double *varc) {
+    double tc[2], c[2], std;
+    int i, index;
+
+    if (tbl->nc < 2 || timediff(t, tbl->tc[0]) < -MAXDTE ||
+        timediff(t, tbl->tc[tbl->nc - 1]) > MAXDTE) {
+        return 1;
+    }
+    s->ic = walkindex(tbl->tc, tbl->nc, s->ic, t);
+    index = s->ic <= 0 ? 0 : s->ic - 1;
+
+    /* linear interpolation for clock */
+    tc[0] = timediff(t, tbl->tc[index]);
+    tc[1] = timediff(t, tbl->tc[index + 1]);
+    c[0] = s->clk[index];
+    c[1] = s->clk[index + 1];
+
+    if (tc[0] <= 0.0) {
+        if ((dts[0] = c[0]) == 0.0) return 0;
+        std = s->cstd[index] * CLIGHT - EXTERR_CLK * tc[0];
+    } else if (tc[1] >= 0.0) {
+        if ((dts[0] = c[1]) == 0.0) return 0;
+        std = s->cstd[index + 1] * CLIGHT + EXTERR_CLK * tc[1];
+    } else if (c[0] != 0.0 && c[1] != 0.0) {
+        dts[0] = (c[1] * tc[0] - c[0] * tc[1]) / (tc[0] - tc[1]);
+        i = tc[0] < -tc[1] ? 0 : 1;
+        std = s->cstd[index + i] * CLIGHT + EXTERR_CLK * fabs(tc[i]);
+    } else {
+        return 0;
+    }
+    if (varc) *varc = SQR(std);
+    return 1;
+}
+/* sort query epochs --------------------------------------------------*/
+static const double *sorttq;
+static int cmpepoch(const void *p1, const void *p2) {
+    int i1 = *(const int *)p1, i2 = *(const int *)p2;
+    double d = sorttq[i1] - sorttq[i2];
+    return d < 0.0 ? -1 : (d > 0.0 ? 1 : i1 - i2);
+}
+
+/* satellite positions/clocks by precise ephemeris/clock ---------------
+ * args   : gtime_t *time    I   query epochs (m)
+ *          int    m         I   number of query epochs
+ *          int    *sat      I   satellite numbers (nsat)
+ *          int    nsat      I   number of satellites
+ *          nav_t  *nav      I   navigation data
+ *          int    opt       I   sat position option (same as peph2pos)
+ *          int    nthread   I   number of threads for satellite loop
+ *                               (1 if opt is not 0)
+ *          double **rs      O   x,y,z,vx,vy,vz (6 arrays of m x nsat)
+ *          double **dts     O   clock bias and drift (2 arrays of m x nsat)
+ *          double *var      O   variance (m x nsat)
+ *          uint8_t *nodata  O   no precise ephemeris flag (m x nsat)
+ * return : none (outputs of no precise ephemeris are not changed)
+ *---------------------------------------------------------------------*/
+extern void peph2posv(const gtime_t *time, const int m, const int *sat,
+                      const int nsat, const nav_t *nav, const int opt,
+                      const int nthread, double **rs, double **dts,
+                      double *var, uint8_t *nodata) {
+    pephtbl_t tbl = {0};
+    gtime_t *te, *tc;
+    double *tq;
+    int i, j, k, *order;
+
+    if (m <= 0 || nsat <= 0) return;
+    te = (gtime_t *)malloc(sizeof(gtime_t) * (nav->ne + 1));
+    tc = (gtime_t *)malloc(sizeof(gtime_t) * (nav->nc + 1));
+    tq = (double *)malloc(sizeof(double) * m);
+    order = (int *)malloc(sizeof(int) * m);
+    if (!te || !tc || !tq || !order) {
+        free(te);
+        free(tc);
+        free(tq);
+        free(order);
+        mexErrMsgTxt("peph2pos: memory allocation error");
+    }
+    /* epochs of ephemeris/clock and query epochs in time order */
+    for (k = 0; k < nav->ne; k++) te[k] = nav->peph[k].time;
+    for (k = 0; k < nav->nc; k++) tc[k] = nav->pclk[k].time;
+    for (i = 0; i < m; i++) {
+        tq[i] = timediff(time[i], time[0]);
+        order[i] = i;
+    }
+    sorttq = tq;
+    qsort(order, m, sizeof(int), cmpepoch);
+
+    tbl.ne = nav->ne;
+    tbl.nc = nav->nc;
+    tbl.te = te;
+    tbl.tc = tc;
+
+#pragma omp parallel for num_threads(opt ? 1 : nthread) private(i, k) \
+    schedule(dynamic)
+    for (j = 0; j < nsat; j++) {
+        pephser_t s = {0};
+        gtime_t tt;
+        double rss[3], rst[3], dtss[1], dtst[1], dant[3], r[6];
+        double vare, varc;
+        int ii, ok = sat[j] > 0 && sat[j] <= MAXSAT;
+
+        if (ok) ok = getseries(nav, sat[j], &s);
+
+        for (k = 0; k < m; k++) {
+            ii = order[k];
+            if (!ok) {
+                nodata[ii + m * j] = 1;
+                continue;
+            }
+            /* satellite position and clock bias */
+            vare = varc = 0.0;
+            tt = timeadd(time[ii], TTVEL);
+            if (!pephposv(&tbl, &s, time[ii], rss, dtss, &vare, &varc) ||
+                !pephclkv(&tbl, &s, time[ii], dtss, &varc) ||
+                !pephposv(&tbl, &s, tt, rst, dtst, NULL, NULL) ||
+                !pephclkv(&tbl, &s, tt, dtst, NULL)) {
+                nodata[ii + m * j] = 1;
+                continue;
+            }
+            /* satellite antenna offset correction */
+            dant[0] = dant[1] = dant[2] = 0.0;
+            if (opt) satantoff(time[ii], rss, sat[j], nav, dant);
+
+            for (i = 0; i < 3; i++) {
+                r[i] = rss[i] + dant[i];
+                r[i + 3] = (rst[i] - rss[i]) / TTVEL;
+            }
+            for (i = 0; i < 6; i++) rs[i][ii + m * j] = r[i];
+
+            /* relativistic effect correction */
+            if (dtss[0] != 0.0) {
+                dts[0][ii + m * j] =
+                    dtss[0] - 2.0 * dot(r, r + 3, 3) / CLIGHT / CLIGHT;
+                dts[1][ii + m * j] = (dtst[0] - dtss[0]) / TTVEL;
+            } else { /* no precise clock */
+                dts[0][ii + m * j] = dts[1][ii + m * j] = 0.0;
+            }
+            var[ii + m * j] = vare + varc;
+        }
+        freeseries(&s);
+    }
+    free(te);
+    free(tc);
+    free(tq);
+    free(order);
+}
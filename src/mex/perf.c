@@ -0,0 +1,136 @@
+/**
+ * @file perf.c
+ * @brief Performance counters of wrappers
+ * @author Taro Suzuki
+ * @note Counters are kept in one table per MATLAB process, which is shared
+ * by all mex files through the registry (registry.c), not through a MATLAB
+ * variable
+ * @note Table has fixed size and is created only once per process, mex files
+ * cleared and loaded again use the same table, so it is not freed
+ */
+
+#include "mex_utility.h"
+
+#ifndef WIN32
+#include <time.h>
+#endif
+
+/* table of counters */
+typedef struct {
+    int n;                    /* number of wrappers */
+    perfstat_t stat[MAXPERF]; /* counters */
+} perftbl_t;
+
+/* current time (s) ---------------------------------------------------*/
+static double perftime(void) {
+#ifdef WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+#endif
+}
+/* table of counters (created on first use) ---------------------------*/
+static perftbl_t *perftbl(void) {
+    perftbl_t *tbl;
+
+    if ((tbl = (perftbl_t *)regobj(REGOBJ_PERF))) return tbl;
+    if (!(tbl = (perftbl_t *)calloc(1, sizeof(perftbl_t)))) return NULL;
+    regsetobj(REGOBJ_PERF, tbl);
+    return tbl;
+}
+/* start counters of wrapper call -------------------------------------*/
+extern void perfstart(perf_t *perf, const char *name) {
+    perftbl_t *tbl = perftbl();
+    int i;
+
+    perf->stat = NULL;
+    perf->bytes = 0.0;
+    perf->tick = perftime();
+    if (!tbl) return;
+
+    for (i = 0; i < tbl->n; i++) {
+        if (!strcmp(tbl->stat[i].name, name)) break;
+    }
+    if (i >= tbl->n) {
+        if (tbl->n >= MAXPERF) return;
+        strncpy(tbl->stat[i].name, name, sizeof(tbl->stat[i].name) - 1);
+        tbl->n++;
+    }
+    perf->stat = tbl->stat + i;
+    perf->stat->ncall += 1.0;
+}
+/* add time since last lap to input/compute/output --------------------*/
+extern void perflap(perf_t *perf, int type) {
+    double tick = perftime();
+
+    if (perf->stat) perf->stat->t[type] += tick - perf->tick;
+    perf->tick = tick;
+}
+/* add temporary buffer size ------------------------------------------*/
+extern void perfalloc(perf_t *perf, double bytes) {
+    perf->bytes += bytes;
+}
+/* end counters of wrapper call (output marshalling) ------------------*/
+extern void perfend(perf_t *perf) {
+    perflap(perf, PERF_OUT);
+    if (!perf->stat) return;
+    perf->stat->bytes += perf->bytes;
+    if (perf->bytes > perf->stat->peak) perf->stat->peak = perf->bytes;
+}
+/* buffer size of observation data converted by mxobs2obs -------------*/
+extern double perfobs(const int *nobslist, int n) {
+    double bytes = sizeof(int) * (double)n;
+    int i;
+
+    for (i = 0; i < n; i++) bytes += sizeof(obsd_t) * (double)nobslist[i];
+    return bytes;
+}
+/* buffer size of navigation data converted by mxnav2navp -------------*/
+/* navigation data handle is not copied                                 */
+extern double perfnav(const nav_t *navp, const nav_t *nav) {
+    if (navp != nav) return 0.0;
+    return sizeof(eph_t) * (double)nav->n + sizeof(geph_t) * (double)nav->ng +
+           sizeof(seph_t) * (double)nav->ns + sizeof(peph_t) * (double)nav->ne +
+           sizeof(pclk_t) * (double)nav->nc;
+}
+/* counters to mx struct ----------------------------------------------*/
+extern mxArray *perf2mxperf(void) {
+    const char *f[] = {"ncall", "tin", "tcomp", "tout", "ttotal", "bytes",
+                       "peak"};
+    perftbl_t *tbl = perftbl();
+    perfstat_t *s;
+    mxArray *mx, *mxs;
+    int i;
+
+    mx = mxCreateStructMatrix(1, 1, 0, NULL);
+    for (i = 0; tbl && i < tbl->n; i++) {
+        s = tbl->stat + i;
+        mxs = mxCreateStructMatrix(1, 1, 7, f);
+        mxSetField(mxs, 0, "ncall", mxCreateDoubleScalar(s->ncall));
+        mxSetField(mxs, 0, "tin", mxCreateDoubleScalar(s->t[PERF_IN]));
+        mxSetField(mxs, 0, "tcomp", mxCreateDoubleScalar(s->t[PERF_COMP]));
+        mxSetField(mxs, 0, "tout", mxCreateDoubleScalar(s->t[PERF_OUT]));
+        mxSetField(mxs, 0, "ttotal",
+                   mxCreateDoubleScalar(s->t[0] + s->t[1] + s->t[2]));
+        mxSetField(mxs, 0, "bytes", mxCreateDoubleScalar(s->bytes));
+        mxSetField(mxs, 0, "peak", mxCreateDoubleScalar(s->peak));
+        mxAddField(mx, s->name);
+        mxSetField(mx, 0, s->name, mxs);
+    }
+    return mx;
+}
+/* reset counters -----------------------------------------------------*/
+extern void perfreset(void) {
+    perftbl_t *tbl = perftbl();
+    int i;
+
+    for (i = 0; tbl && i < tbl->n; i++) {
+        tbl->stat[i].ncall = tbl->stat[i].bytes = tbl->stat[i].peak = 0.0;
+        tbl->stat[i].t[0] = tbl->stat[i].t[1] = tbl->stat[i].t[2] = 0.0;
+    }
+}
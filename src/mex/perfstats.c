@@ -0,0 +1,33 @@
+/**
+ * @file perfstats.c
+ * @brief Performance counters of wrappers
+ * @author Taro Suzuki
+ * @note New development function
+ * @note Counters are shared by all mex files (see perf.c)
+ */
+
+#include "mex_utility.h"
+
+#define NIN 0
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    char cmd[16] = "";
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > 0) {
+        mxCheckChar(argin[0]); /* command */
+        mxGetString(argin[0], cmd, sizeof(cmd));
+        if (strcmp(cmd, "reset")) {
+            mexErrMsgTxt("perfstats: command must be \"reset\"");
+        }
+    }
+
+    /* output (counters before reset) */
+    if (nargout > 0 || nargin == 0) argout[0] = perf2mxperf();
+
+    /* reset counters */
+    if (nargin > 0) perfreset();
+}
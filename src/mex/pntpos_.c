@@ -5,94 +5,257 @@
  * @author Taro Suzuki
  * @note Wrapper for "pntpos" in pntpos.c
  * @note Due to a conflict, file name was changed from pntpos.c to pntpos_.c
+ * @note Ephemerides are selected from ephemerides near epoch by per-satellite
+ * index (ephidx.c)
+ * @note Blocks of epochs are processed in parallel by OpenMP from reset
+ * initial position, then epochs at the start of each block are recomputed in
+ * order from the previous solution of serial loop until the solution is the
+ * same as that of the block, so that solutions are identical to serial loop
  */
 
 #include "mex_utility.h"
 
 #define NIN 2
+#define NBLK 64 /* number of epochs of block */
+
+/* inputs of epochs */
+typedef struct {
+    const obsd_t *obss;   /* observation data of all epochs */
+    const int *nobslist;  /* number of observation data of epochs */
+    const int *iobs;      /* index of first observation data of epochs */
+    const nav_t *navp;    /* navigation data */
+    const ephidx_t *eidx; /* ephemeris index */
+    const prcopt_t *popt; /* processing options */
+} pntin_t;
+
+/* work buffers of thread */
+typedef struct {
+    navview_t *view; /* navigation data view */
+    obsd_t *obs;     /* observation data of epoch */
+    ssat_t *ssat;    /* satellite status of epoch */
+} pntwork_t;
+
+/* new/free work buffers ----------------------------------------------*/
+static int newpntwork(pntwork_t *w, const nav_t *navp) {
+    w->view = newnavview(navp);
+    w->obs = (obsd_t *)malloc(sizeof(obsd_t) * MAXOBS);
+    w->ssat = (ssat_t *)malloc(sizeof(ssat_t) * MAXSAT);
+    return w->obs && w->ssat;
+}
+static void freepntwork(pntwork_t *w) {
+    freenavview(w->view);
+    free(w->obs);
+    free(w->ssat);
+}
+/* single-point positioning of epoch (0: memory allocation error) -------*/
+/* sol is previous solution and is updated, satellite status is added to */
+/* ssatbuf and no-solution message is output to msg (NULL: solution)     */
+static int pntepoch(const pntin_t *in, pntwork_t *w, const int i, sol_t *sol,
+                    ssatbuf_t *ssatbuf, char **msg) {
+    const prcopt_t *popt = in->popt;
+    const obsd_t *obss = in->obss;
+    const nav_t *navv;
+    gtime_t time;
+    char buff[128] = "";
+    int j, nobs, sats[MAXOBS];
+
+    time = in->nobslist[i] > 0 ? obss[in->iobs[i]].time : sol->time;
+
+    /* exclude satellites */
+    for (nobs = 0, j = in->iobs[i]; j < in->iobs[i + 1] && nobs < MAXOBS; j++) {
+        if ((satsys(obss[j].sat, NULL) & popt->navsys) &&
+            popt->exsats[obss[j].sat - 1] != 1) {
+            w->obs[nobs++] = obss[j];
+        }
+    }
+    /* ephemerides of satellites near epoch */
+    for (j = 0; j < nobs; j++) sats[j] = w->obs[j].sat;
+    navv = w->view ? navview(w->view, in->eidx, time, sats, nobs) : in->navp;
+
+    memset(w->ssat, 0, sizeof(ssat_t) * MAXSAT);
+    *msg = NULL;
+    if (!pntpos(w->obs, nobs, navv, popt, sol, NULL, w->ssat, buff)) {
+        if ((*msg = (char *)malloc(strlen(buff) + 1))) strcpy(*msg, buff);
+    }
+    /* visible satellites only */
+    return addssat(ssatbuf, time, w->ssat);
+}
+/* compare solutions (1: same) ----------------------------------------*/
+static int samesol(const sol_t *s1, const sol_t *s2) {
+    return !memcmp(&s1->time, &s2->time, sizeof(gtime_t)) &&
+           !memcmp(s1->rr, s2->rr, sizeof(s1->rr)) &&
+           !memcmp(s1->qr, s2->qr, sizeof(s1->qr)) &&
+           !memcmp(s1->qv, s2->qv, sizeof(s1->qv)) &&
+           !memcmp(s1->dtr, s2->dtr, sizeof(s1->dtr)) &&
+           s1->type == s2->type && s1->stat == s2->stat && s1->ns == s2->ns &&
+           !memcmp(&s1->age, &s2->age, sizeof(float)) &&
+           !memcmp(&s1->ratio, &s2->ratio, sizeof(float));
+}
 
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    obsd_t *obss, *obs;
-    nav_t nav = {0};
+    obsd_t *obss;
+    nav_t nav = {0}, *navp;
+    ephidx_t *eidx;
     prcopt_t popt = prcopt_default;
     solopt_t sopt = solopt_default;
-    solbuf_t solbuf = {0};
-    sol_t sol = {0};
-    ssat_t *ssats;
-    gtime_t *times;
-    int i, j, n, nobs = 0, iobs = 0, *nobslist = NULL;
-    char msg[128] = "";
+    pntin_t in;
+    pntwork_t work = {0};
+    sol_t *sols, sol;
+    ssatbuf_t ssatbuf = {0}, *ssatblk, rep;
+    int i, j, b, n, nb, nblk, nthread, same, err = 0, *nobslist = NULL, *iobs;
+    char **msgs;
     char tracefile[] = "pntpos.trace";
+    perf_t perf;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    perfstart(&perf, "pntpos");
 
     /* options */
     popt.ionoopt = IONOOPT_BRDC;
     popt.tropopt = TROPOPT_SAAS;
-    if (nargin == 3) {
+    if (nargin > 2 && !mxIsEmpty(argin[2])) {
         mxopt2opt(argin[2], &popt, &sopt);
     }
+    nthread = ephNumThreads(popt.sateph, mxGetNumThreads(nargin, argin, 3));
     if (sopt.trace > 0) {
         mexPrintf("trace level=%d\n", sopt.trace);
         traceopen(tracefile);
         tracelevel(sopt.trace);
+        nthread = 1; /* trace file is not thread safe */
     }
 
     /* inputs */
     obss = mxobs2obs(argin[0], 1, &n, &nobslist);
-    nav = mxnav2nav(argin[1]);
-    
-    initsolbuf(&solbuf, 0, n);
-    
-    /* ssats */
-    if (!(ssats = (ssat_t *)calloc(MAXSAT*n, sizeof(ssat_t)))) {
-        mexErrMsgTxt("pntpos: memory allocation error");
-    }
-    /* times */
-    if (!(times = (gtime_t *)calloc(n, sizeof(gtime_t)))) {
+    navp = mxnav2navp(argin[1], &nav);
+    eidx = mxnav2ephidx(argin[1], navp);
+    perfalloc(&perf, perfobs(nobslist, n) + perfnav(navp, &nav));
+    perflap(&perf, PERF_IN);
+
+    /* buffers of epochs and blocks (one block by single thread) */
+    nb = nthread > 1 ? NBLK : (n > 0 ? n : 1);
+    nblk = (n + nb - 1) / nb;
+    sols = (sol_t *)calloc(n + 1, sizeof(sol_t));
+    msgs = (char **)calloc(n + 1, sizeof(char *));
+    iobs = (int *)malloc(sizeof(int) * (n + 1));
+    ssatblk = (ssatbuf_t *)calloc(nblk + 1, sizeof(ssatbuf_t));
+    if (!sols || !msgs || !iobs || !ssatblk) {
+        free(sols);
+        free(msgs);
+        free(iobs);
+        free(ssatblk);
+        free(obss);
+        free(nobslist);
+        freeephidxp(eidx, argin[1]);
+        freenavp(navp, &nav);
         mexErrMsgTxt("pntpos: memory allocation error");
     }
+    for (iobs[0] = 0, i = 0; i < n; i++) iobs[i + 1] = iobs[i] + nobslist[i];
+    in.obss = obss;
+    in.nobslist = nobslist;
+    in.iobs = iobs;
+    in.navp = navp;
+    in.eidx = eidx;
+    in.popt = &popt;
+
+    /* call RTKLIB function (blocks from reset initial position) */
+#pragma omp parallel num_threads(nthread) private(i, b)
+    {
+        pntwork_t w;
+        int stat = newpntwork(&w, navp);
 
-    /* call RTKLIB function */
-    for (i = 0; i < n; i++) {
-        obs = &obss[iobs];
+#pragma omp for schedule(dynamic)
+        for (b = 0; b < nblk; b++) {
+            sol_t solb = {0};
 
-        /* exclude satellites */
-        for (j = 0; j < nobslist[i]; j++) {
-            if ((satsys(obs[j].sat, NULL) & popt.navsys) &&
-                popt.exsats[obs[j].sat - 1] != 1) {
-                obs[nobs++] = obs[j];
+            for (i = b * nb; stat && i < n && i < (b + 1) * nb; i++) {
+                stat = pntepoch(&in, &w, i, &solb, &ssatblk[b], &msgs[i]);
+                sols[i] = solb;
+            }
+            if (!stat) {
+#pragma omp atomic write
+                err = 1;
             }
         }
-        //mexPrintf("nobslist=%d nobs=%d\n", nobslist[i], nobs);
-        if (!pntpos(obs, nobs, &nav, &popt, &sol, NULL, &ssats[i*MAXSAT], msg)) {
-            mexPrintf("pntpos: no solution: %s %s\n", time_str(obs->time, 3), msg);
+        freepntwork(&w);
+    }
+    /* epochs at start of blocks from previous solution of serial loop */
+    if (!err && nblk > 1 && !newpntwork(&work, navp)) err = 1;
+    for (b = 1; !err && b < nblk; b++) {
+        memset(&rep, 0, sizeof(rep));
+        sol = sols[b * nb - 1];
+        for (i = b * nb; i < n && i < (b + 1) * nb; i++) {
+            free(msgs[i]);
+            if (!pntepoch(&in, &work, i, &sol, &rep, &msgs[i])) {
+                err = 1;
+                break;
+            }
+            same = samesol(&sol, &sols[i]);
+            sols[i] = sol;
+            if (same) break; /* following epochs of block are the same */
         }
-        memcpy(&times[i], &obs[0].time, sizeof(gtime_t));
-
-        //mexPrintf("sol.stat=%d\n", sol.stat);
-        //mexPrintf("msg=%s\n", msg);
-        addsol(&solbuf, &sol);
+        /* satellite status of recomputed epochs and rest of block */
+        for (j = rep.n; !err && j < ssatblk[b].n; j++) {
+            if (!addssatbuf(&rep, &ssatblk[b], j)) err = 1;
+        }
+        freessatbuf(&ssatblk[b]);
+        ssatblk[b] = rep;
+    }
+    freepntwork(&work);
 
-        iobs += nobslist[i];
-        nobs = 0;
+    /* reassemble satellite status of blocks in order */
+    for (b = 0; b < nblk; b++) {
+        if (!err && !catssatbuf(&ssatbuf, &ssatblk[b])) err = 1;
+        freessatbuf(&ssatblk[b]);
     }
+    free(ssatblk);
+    if (err) {
+        for (i = 0; i < n; i++) free(msgs[i]);
+        free(msgs);
+        free(sols);
+        free(iobs);
+        free(obss);
+        free(nobslist);
+        freessatbuf(&ssatbuf);
+        freeephidxp(eidx, argin[1]);
+        freenavp(navp, &nav);
+        if (sopt.trace > 0) traceclose();
+        mexErrMsgTxt("pntpos: memory allocation error");
+    }
+    perfalloc(&perf, sizeof(sol_t) * (double)n +
+                         sizeof(ssatc_t) * (double)ssatbuf.nsmax);
+    perflap(&perf, PERF_COMP);
+
     /* outputs */
-    argout[0] = sol2mxsol(solbuf.data, solbuf.n);
-    argout[1] = ssat2mxssat(ssats, times, n);
+    argout[0] = sol2mxsol(sols, n);
+    argout[1] = ssatbuf2mxssat(&ssatbuf);
+    if (nargout > 2) {
+        /* no-solution diagnostics of epochs ('': solution) */
+        argout[2] = mxCreateCellMatrix(n, 1);
+        for (i = 0; i < n; i++) {
+            mxSetCell(argout[2], i, mxCreateString(msgs[i] ? msgs[i] : ""));
+        }
+    } else {
+        for (i = 0; i < n; i++) {
+            if (!msgs[i]) continue;
+            mexPrintf("pntpos: no solution: %s %s\n",
+                      time_str(ssatbuf.time[i], 3), msgs[i]);
+        }
+    }
+    perflap(&perf, PERF_OUT);
 
+    for (i = 0; i < n; i++) free(msgs[i]);
+    free(msgs);
+    free(sols);
+    free(iobs);
     free(obss);
     free(nobslist);
-    freesolbuf(&solbuf);
-    free(ssats); free(times);
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
-    if (nav.erp.n > 0) free(nav.erp.data);
-    
+    freessatbuf(&ssatbuf);
+    freeephidxp(eidx, argin[1]);
+    freenavp(navp, &nav);
+
     if (sopt.trace > 0) traceclose();
-}
\ No newline at end of file
+    perfend(&perf);
+}
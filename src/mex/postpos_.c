@@ -0,0 +1,354 @@
+/**
+ * @file postpos_.c
+ * @brief Post-processing positioning (forward/backward/combined solution)
+ * @author Taro Suzuki
+ * @note Wrapper for "postpos" in postpos.c, observation and navigation data
+ * are input as structs instead of files and solutions are output as structs
+ * instead of solution files
+ * @note Due to a conflict, file name was changed from postpos.c to postpos_.c
+ * @note Forward and backward filters of combined solution are run
+ * concurrently by OpenMP (two threads) sharing observation/navigation data
+ * in DGPS/RTK modes with broadcast ephemeris and without tide correction and
+ * trace, otherwise they are run in order by single thread. Solutions are
+ * combined by the same rules as combres in postpos.c
+ * @note Ephemerides are selected from ephemerides near epoch by per-satellite
+ * index (ephidx.c)
+ */
+
+#include "mex_utility.h"
+
+#define NIN 3
+
+/* input data of filter */
+typedef struct {
+    const obsd_t *obsr, *obsb; /* rover/base observation data */
+    const int *nobsr, *nobsb;  /* number of observations of epochs */
+    const int *ir, *ib;        /* start index of observations of epochs */
+    int n;                     /* number of epochs */
+    const nav_t *nav;          /* navigation data */
+    const ephidx_t *eidx;      /* ephemeris index */
+    const prcopt_t *popt;      /* processing options */
+} postin_t;
+
+/* filter pass */
+typedef struct {
+    int rev;        /* backward (reverse time order) */
+    sol_t *sol;     /* solutions of epochs (epoch order) */
+    double *rb;     /* base positions of epochs (epoch order) */
+    ssatbuf_t ssat; /* satellite status (processing order) */
+    int stat;       /* status (0: memory allocation error) */
+} postpass_t;
+
+/* get solution type --------------------------------------------------*/
+static int getsoltype(const mxArray *mxtype) {
+    char str[16];
+    int type;
+
+    if (mxIsChar(mxtype)) {
+        mxGetString(mxtype, str, sizeof(str));
+        if (!strcmp(str, "forward")) return 0;
+        if (!strcmp(str, "backward")) return 1;
+        if (!strcmp(str, "combined")) return 2;
+    } else if (mxIsNumeric(mxtype) && mxGetNumberOfElements(mxtype) == 1) {
+        if ((type = (int)mxGetScalar(mxtype)) >= 0 && type <= 2) return type;
+    }
+    mexErrMsgTxt("postpos: solution type must be \"forward\", \"backward\", "
+                 "\"combined\" or 0-2");
+    return 2;
+}
+/* number of threads of filter passes --------------------------------*/
+/* passes are run concurrently only if RTKLIB functions called by rtkpos */
+/* use no static buffers: sun/moon position (precise/SSR ephemeris, tide */
+/* correction and PPP models) and trace file are not thread safe         */
+static int passthreads(const prcopt_t *popt, const solopt_t *sopt,
+                       const int npass) {
+    if (popt->mode > PMODE_FIXED || popt->tidecorr || sopt->trace > 0) {
+        return 1;
+    }
+    return ephNumThreads(popt->sateph, npass);
+}
+/* run forward or backward filter -------------------------------------*/
+static void procpass(postpass_t *pass, const postin_t *in) {
+    obsd_t *obs;
+    rtk_t rtk;
+    navview_t *view;
+    const nav_t *navv;
+    gtime_t time;
+    int i, j, k, nobs, sats[MAXOBS * 2];
+
+    if (!(obs = (obsd_t *)malloc(sizeof(obsd_t) * MAXOBS * 2))) {
+        pass->stat = 0;
+        return;
+    }
+    rtkinit(&rtk, in->popt);
+    view = newnavview(in->nav);
+    pass->stat = 1;
+
+    for (k = 0; k < in->n; k++) {
+        i = pass->rev ? in->n - 1 - k : k;
+
+        /* reset variables */
+        rtk.neb = 0;
+        memset(rtk.errbuf, 0, MAXERRMSG);
+
+        /* exclude satellites */
+        time = in->nobsr[i] > 0 ? in->obsr[in->ir[i]].time : rtk.sol.time;
+        for (nobs = 0, j = in->ir[i]; j < in->ir[i + 1] && nobs < MAXOBS; j++) {
+            if ((satsys(in->obsr[j].sat, NULL) & in->popt->navsys) &&
+                in->popt->exsats[in->obsr[j].sat - 1] != 1) {
+                obs[nobs++] = in->obsr[j];
+            }
+        }
+        for (j = 0; in->obsb && j < in->nobsb[i] && nobs < MAXOBS * 2; j++) {
+            obs[nobs++] = in->obsb[in->ib[i] + j];
+        }
+        /* ephemerides of satellites near epoch */
+        for (j = 0; j < nobs; j++) sats[j] = obs[j].sat;
+        navv = view && nobs > 0 ? navview(view, in->eidx, obs[0].time, sats, nobs)
+                                : in->nav;
+
+        rtkpos(&rtk, obs, nobs, navv);
+
+        pass->sol[i] = rtk.sol;
+        memcpy(pass->rb + i * 3, rtk.rb, sizeof(double) * 3);
+        if (!addssat(&pass->ssat, time, rtk.ssat)) {
+            pass->stat = 0;
+            break;
+        }
+    }
+    free(obs);
+    freenavview(view);
+    rtkfree(&rtk);
+}
+/* covariance of solution (qr/qv) to matrix ---------------------------*/
+static void sol2cov(const float *q, double *Q) {
+    Q[0] = q[0];
+    Q[4] = q[1];
+    Q[8] = q[2];
+    Q[1] = Q[3] = q[3];
+    Q[5] = Q[7] = q[4];
+    Q[2] = Q[6] = q[5];
+}
+/* matrix to covariance of solution (qr/qv) ---------------------------*/
+static void cov2sol(const double *Q, float *q) {
+    q[0] = (float)Q[0];
+    q[1] = (float)Q[4];
+    q[2] = (float)Q[8];
+    q[3] = (float)Q[1];
+    q[4] = (float)Q[5];
+    q[5] = (float)Q[2];
+}
+/* validate fix of forward/backward solutions (same as postpos.c) -----*/
+static int valcomb(const sol_t *solf, const sol_t *solb) {
+    double dr, var;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        dr = solf->rr[i] - solb->rr[i];
+        var = solf->qr[i] + solb->qr[i];
+        if (dr * dr > 16.0 * var) return 0; /* 4-sigma */
+    }
+    return 1;
+}
+/* combine forward/backward solutions of epoch (0: no solution) -------*/
+static int combsol(const sol_t *solf, const sol_t *solb, const double *rbf,
+                   const double *rbb, const prcopt_t *popt, sol_t *sol) {
+    double Qf[9], Qb[9], Qs[9], rrf[3], rrb[3], rrs[3];
+    int k;
+
+    *sol = *solf;
+    sol->time = timeadd(solf->time, -timediff(solf->time, solb->time) / 2.0);
+
+    /* degrade fix to float if validation failed */
+    if ((popt->mode == PMODE_KINEMA || popt->mode == PMODE_MOVEB) &&
+        sol->stat == SOLQ_FIX && !valcomb(solf, solb)) {
+        sol->stat = SOLQ_FLOAT;
+    }
+    sol2cov(solf->qr, Qf);
+    sol2cov(solb->qr, Qb);
+    if (popt->mode == PMODE_MOVEB) { /* baseline of moving base */
+        for (k = 0; k < 3; k++) {
+            rrf[k] = solf->rr[k] - rbf[k];
+            rrb[k] = solb->rr[k] - rbb[k];
+        }
+        if (smoother(rrf, Qf, rrb, Qb, 3, rrs, Qs)) return 0;
+        for (k = 0; k < 3; k++) sol->rr[k] = rbf[k] + rrs[k];
+    } else if (smoother(solf->rr, Qf, solb->rr, Qb, 3, sol->rr, Qs)) {
+        return 0;
+    }
+    cov2sol(Qs, sol->qr);
+
+    /* smoother for velocity solution */
+    if (popt->dynamics) {
+        sol2cov(solf->qv, Qf);
+        sol2cov(solb->qv, Qb);
+        if (smoother(solf->rr + 3, Qf, solb->rr + 3, Qb, 3, sol->rr + 3, Qs)) {
+            return 0;
+        }
+        cov2sol(Qs, sol->qv);
+    }
+    return 1;
+}
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    obsd_t *obsr, *obsb = NULL;
+    nav_t nav = {0}, *navp;
+    ephidx_t *eidx;
+    prcopt_t popt = prcopt_default;
+    solopt_t sopt = solopt_default;
+    postin_t in = {0};
+    postpass_t pass[2] = {{0}}, *pf, *pb;
+    ssatbuf_t ssatbuf = {0};
+    sol_t *sols;
+    int i, p, nr, nb = 0, ns = 0, npass, nthread, base, err = 0;
+    int *nobsrlist = NULL, *nobsblist = NULL, *ir, *ib = NULL;
+    char tracefile[] = "postpos.trace";
+    perf_t perf;
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+    perfstart(&perf, "postpos");
+
+    /* input opt struct */
+    mxopt2opt(argin[2], &popt, &sopt);
+
+    /* base observation (can be empty) and solution type */
+    base = nargin > 3 && !mxIsEmpty(argin[3]);
+    popt.soltype = nargin > 4 && !mxIsEmpty(argin[4]) ? getsoltype(argin[4]) : 2;
+
+    /* input obs struct */
+    obsr = mxobs2obs(argin[0], 1, &nr, &nobsrlist);
+    if (base) {
+        obsb = mxobs2obs(argin[3], 2, &nb, &nobsblist);
+        if (nr != nb) {
+            free(obsr); free(nobsrlist);
+            free(obsb); free(nobsblist);
+            mexErrMsgTxt("postpos: size of rover and base observations must be same");
+        }
+    }
+    /* input nav struct */
+    navp = mxnav2navp(argin[1], &nav);
+    eidx = mxnav2ephidx(argin[1], navp);
+    perfalloc(&perf, perfobs(nobsrlist, nr) + perfnav(navp, &nav));
+    if (base) perfalloc(&perf, perfobs(nobsblist, nb));
+
+    /* start index of observations of epochs */
+    ir = (int *)malloc(sizeof(int) * (nr + 1));
+    if (base) ib = (int *)malloc(sizeof(int) * (nb + 1));
+    if (!ir || (base && !ib)) {
+        err = 1;
+    } else {
+        for (ir[0] = 0, i = 0; i < nr; i++) ir[i + 1] = ir[i] + nobsrlist[i];
+        if (base) {
+            for (ib[0] = 0, i = 0; i < nb; i++) ib[i + 1] = ib[i] + nobsblist[i];
+        }
+    }
+
+    in.obsr = obsr;
+    in.nobsr = nobsrlist;
+    in.ir = ir;
+    in.obsb = obsb;
+    in.nobsb = nobsblist;
+    in.ib = ib;
+    in.n = nr;
+    in.nav = navp;
+    in.eidx = eidx;
+    in.popt = &popt;
+
+    /* filter passes (forward: 0, backward: 1, combined: 2) */
+    npass = popt.soltype == 2 ? 2 : 1;
+    for (p = 0; p < npass; p++) {
+        pass[p].rev = popt.soltype == 1 || p == 1;
+        pass[p].sol = (sol_t *)calloc(nr + 1, sizeof(sol_t));
+        pass[p].rb = (double *)calloc(3 * nr + 1, sizeof(double));
+        if (!pass[p].sol || !pass[p].rb) err = 1;
+    }
+    if (!(sols = (sol_t *)calloc(nr + 1, sizeof(sol_t)))) err = 1;
+    perfalloc(&perf, (sizeof(sol_t) + 3 * sizeof(double)) * (double)nr * npass +
+                         sizeof(sol_t) * (double)nr);
+    perflap(&perf, PERF_IN);
+
+    /* trace file */
+    if (sopt.trace > 0) {
+        mexPrintf("trace level=%d\n", sopt.trace);
+        traceopen(tracefile);
+        tracelevel(sopt.trace);
+    }
+    /* forward and backward filters (skipped by allocation error) */
+    nthread = passthreads(&popt, &sopt, npass);
+#pragma omp parallel for num_threads(nthread) schedule(static, 1)
+    for (p = 0; p < npass; p++) {
+        if (!err) procpass(&pass[p], &in);
+    }
+    for (p = 0; p < npass; p++) {
+        if (!pass[p].stat) err = 1;
+    }
+    /* solutions and satellite status of epochs with solution */
+    pf = &pass[0];
+    pb = &pass[npass - 1];
+    for (i = 0; !err && i < nr; i++) {
+        const sol_t *solf = &pf->sol[i], *solb = &pb->sol[i];
+        int fwd;
+
+        if (npass == 1) {
+            if (solf->stat == SOLQ_NONE) continue;
+            sols[ns] = *solf;
+            fwd = !pf->rev;
+        } else if (solf->stat == SOLQ_NONE && solb->stat == SOLQ_NONE) {
+            continue;
+        } else if (solb->stat == SOLQ_NONE ||
+                   (solf->stat != SOLQ_NONE && solf->stat < solb->stat)) {
+            sols[ns] = *solf;
+            fwd = 1;
+        } else if (solf->stat == SOLQ_NONE || solf->stat > solb->stat) {
+            sols[ns] = *solb;
+            fwd = 0;
+        } else {
+            if (!combsol(solf, solb, pf->rb + i * 3, pb->rb + i * 3, &popt,
+                         &sols[ns])) {
+                continue;
+            }
+            fwd = 1;
+        }
+        /* satellite status of backward filter is in reverse order */
+        if (!addssatbuf(&ssatbuf, fwd ? &pf->ssat : &pb->ssat,
+                        fwd ? i : nr - 1 - i)) {
+            err = 1;
+        }
+        ns++;
+    }
+    perfalloc(&perf, sizeof(ssatc_t) * ((double)pf->ssat.nsmax +
+                                        (npass > 1 ? pb->ssat.nsmax : 0) +
+                                        ssatbuf.nsmax));
+    perflap(&perf, PERF_COMP);
+
+    /* output */
+    if (!err) {
+        argout[0] = sol2mxsol(sols, ns);
+        argout[1] = ssatbuf2mxssat(&ssatbuf);
+    }
+    perflap(&perf, PERF_OUT);
+
+    /* free memory */
+    for (p = 0; p < npass; p++) {
+        free(pass[p].sol);
+        free(pass[p].rb);
+        freessatbuf(&pass[p].ssat);
+    }
+    free(sols);
+    freessatbuf(&ssatbuf);
+    free(ir); free(ib);
+    free(obsr); free(nobsrlist);
+    if (base) {
+        free(obsb); free(nobsblist);
+    }
+    freeephidxp(eidx, argin[1]);
+    freenavp(navp, &nav);
+
+    /* trace file */
+    if (sopt.trace > 0) traceclose();
+    perfend(&perf);
+    if (err) mexErrMsgTxt("postpos: memory allocation error");
+}
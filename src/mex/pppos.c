@@ -0,0 +1,257 @@
+/**
+ * @file pppos.c
+ * @brief Compute rover position by precise point positioning (PPP session)
+ * @author Taro Suzuki
+ * @note Wrapper for "pppos" in ppp.c (called through rtkpos)
+ * @note rtk_t of PPP session is kept in memory referred by session handle
+ * between calls, so that rtk struct (x/P of ionosphere and ambiguity states)
+ * is not converted from/to mxArray at every call
+ * @note Session handle is registry id (registry.c), sessions opened by this
+ * mex file are freed when it is cleared (or by "free" of core)
+ * @note Trace file is shared by sessions, it is opened by the first session
+ * with trace and closed when the last session with trace is closed
+ * @note Output rtk struct is compact struct (active states only) if session is
+ * opened with compact rtk struct
+ * @note Ephemerides are selected from ephemerides near epoch by per-satellite
+ * index (ephidx.c)
+ */
+
+#include "mex_utility.h"
+
+#define NIN 1
+
+/* PPP session referred by handle (registry id) */
+typedef struct {
+    rtk_t rtk;   /* rtk control struct */
+    int trace;   /* trace level */
+    int compact; /* output compact rtk struct */
+} ppph_t;
+
+static const int pppowner = 0; /* owner of sessions opened by mex file */
+static int ntrace = 0;         /* number of sessions with trace */
+
+/* PPP session of handle ----------------------------------------------*/
+static ppph_t *mxppph2ppph(const mxArray *mxppph) {
+    ppph_t *ppph;
+
+    if (!mxIsUint64(mxppph) || mxGetNumberOfElements(mxppph) != 1) {
+        mexErrMsgTxt("pppos: input argument must be PPP session handle");
+    }
+    if (!(ppph = (ppph_t *)regget(REG_PPP, *(uint64_t *)mxGetData(mxppph)))) {
+        mexErrMsgTxt("pppos: invalid or closed PPP session handle");
+    }
+    return ppph;
+}
+/* free PPP session of id ---------------------------------------------*/
+static void freeppph(const uint64_t id) {
+    ppph_t *ppph;
+
+    if (!(ppph = (ppph_t *)regdel(REG_PPP, id))) return;
+    if (ppph->trace > 0 && --ntrace == 0) traceclose();
+    rtkfree(&ppph->rtk);
+    free(ppph);
+}
+/* free all PPP sessions opened by mex file ---------------------------*/
+static void freeppphs(void) {
+    uint64_t id;
+
+    while ((id = regfirst(REG_PPP, &pppowner))) freeppph(id);
+}
+/* open PPP session ---------------------------------------------------*/
+static mxArray *openppph(int nargin, const mxArray *argin[]) {
+    prcopt_t popt = prcopt_default;
+    solopt_t sopt = solopt_default;
+    const mxArray *mxnx;
+    ppph_t *ppph;
+    mxArray *mxppph;
+    uint64_t id;
+    int i, init = nargin > 2 && !mxIsEmpty(argin[2]);
+
+    mxCheckNumberOfArguments(nargin, 2);
+    mxopt2opt(argin[1], &popt, &sopt);
+    if (popt.mode < PMODE_PPP_KINEMA) {
+        mexErrMsgTxt("pppos: positioning mode must be PPP");
+    }
+    /* initial state from rtk struct (e.g. converged state) */
+    if (init) {
+        if (!mxIsStruct(argin[2]) || mxGetNumberOfElements(argin[2]) != 1 ||
+            !(mxnx = mxGetField(argin[2], 0, "nx")) || !mxIsNumeric(mxnx) ||
+            mxIsEmpty(mxnx)) {
+            mexErrMsgTxt("pppos: initial state must be 1x1 rtk struct");
+        }
+        if ((int)mxGetScalar(mxnx) != pppnx(&popt)) {
+            mexErrMsgTxt("pppos: common opt struct must be used in rtkinit");
+        }
+    }
+    if (!(ppph = (ppph_t *)malloc(sizeof(ppph_t)))) {
+        mexErrMsgTxt("pppos: memory allocation error");
+    }
+    if (init) {
+        ppph->rtk = mxrtk2rtk(argin[2], &popt, NULL);
+    } else {
+        rtkinit(&ppph->rtk, &popt);
+        for (i = 0; i < 3; i++) ppph->rtk.rb[i] = popt.rb[i];
+    }
+    ppph->trace = sopt.trace;
+    ppph->compact = init && mxisrtkc(argin[2]);
+    if (!(id = regadd(REG_PPP, ppph, &pppowner))) {
+        rtkfree(&ppph->rtk);
+        free(ppph);
+        mexErrMsgTxt("pppos: too many PPP sessions");
+    }
+    /* free sessions when mex file is cleared (core frees them by "free") */
+    if (!mexIsLocked()) mexAtExit(freeppphs);
+
+    if (sopt.trace > 0 && ntrace++ == 0) {
+        mexPrintf("trace level=%d\n", sopt.trace);
+        traceopen("pppos.trace");
+        tracelevel(sopt.trace);
+    }
+    mxppph = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *(uint64_t *)mxGetData(mxppph) = id;
+    return mxppph;
+}
+/* close PPP session --------------------------------------------------*/
+static void closeppph(const mxArray *mxppph) {
+    mxppph2ppph(mxppph); /* check handle */
+    freeppph(*(uint64_t *)mxGetData(mxppph));
+}
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    obsd_t *obss, obs[MAXOBS];
+    nav_t nav = {0}, *navp;
+    const nav_t *navv;
+    ephidx_t *eidx;
+    navview_t *view;
+    ppph_t *ppph;
+    rtk_t *rtk, *rtks = NULL;
+    const rtk_t *rtkp;
+    mxArray *mxmsg = NULL;
+    ssatbuf_t ssatbuf = {0};
+    sol_t *sols;
+    gtime_t time;
+    int i, j, n, nobs, iobs = 0, *nobslist = NULL, sats[MAXOBS];
+    int nrtk = 0, np, stat, compact, outmode = RTKOUT_FINAL;
+    char cmd[16];
+    perf_t perf;
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+
+    /* session commands */
+    if (mxIsChar(argin[0])) {
+        mxGetString(argin[0], cmd, sizeof(cmd));
+        if (!strcmp(cmd, "open")) {
+            argout[0] = openppph(nargin, argin);
+        } else if (!strcmp(cmd, "close")) {
+            mxCheckNumberOfArguments(nargin, 2);
+            closeppph(argin[1]);
+        } else if (!strcmp(cmd, "state")) {
+            mxCheckNumberOfArguments(nargin, 2);
+            ppph = mxppph2ppph(argin[1]);
+            compact = nargin > 2 ? getrtkfmt(argin[2]) : ppph->compact;
+            argout[0] = compact ? rtk2mxrtkc(&ppph->rtk, 1)
+                                : rtk2mxrtk(&ppph->rtk, 1);
+        } else {
+            mexErrMsgTxt("pppos: command must be \"open\", \"close\" or "
+                         "\"state\"");
+        }
+        return;
+    }
+    /* observation batch */
+    mxCheckNumberOfArguments(nargin, 3);
+    perfstart(&perf, "pppos");
+    ppph = mxppph2ppph(argin[0]);
+    rtk = &ppph->rtk;
+    if (nargin > 3) outmode = getrtkout(argin[3]);
+
+    /* inputs */
+    obss = mxobs2obs(argin[1], 1, &n, &nobslist);
+    navp = mxnav2navp(argin[2], &nav);
+    eidx = mxnav2ephidx(argin[2], navp);
+    view = newnavview(navp);
+    perfalloc(&perf, perfobs(nobslist, n) + perfnav(navp, &nav));
+
+    /* outputs (rtk struct of selected epochs only if requested) */
+    if (!(sols = (sol_t *)calloc(n + 1, sizeof(sol_t)))) {
+        mexErrMsgTxt("pppos: memory allocation error");
+    }
+    np = rtk->opt.dynamics == 0 ? 3 : 9; /* position/velocity states */
+    if (nargout > 2) {
+        for (i = 0; i < n; i++) nrtk += isrtkout(outmode, i, n);
+        if (!(rtks = (rtk_t *)calloc(nrtk + 1, sizeof(rtk_t)))) {
+            mexErrMsgTxt("pppos: memory allocation error");
+        }
+        nrtk = 0;
+    }
+    if (nargout > 3) mxmsg = mxCreateCellMatrix(n, 1);
+    perfalloc(&perf, sizeof(sol_t) * (double)n);
+    perflap(&perf, PERF_IN);
+
+    /* PPP processing */
+    for (i = 0; i < n; i++) {
+        /* reset variables */
+        rtk->neb = 0;
+        memset(rtk->errbuf, 0, MAXERRMSG);
+
+        /* exclude satellites */
+        time = nobslist[i] > 0 ? obss[iobs].time : rtk->sol.time;
+        for (nobs = 0, j = iobs; j < iobs + nobslist[i] && nobs < MAXOBS; j++) {
+            if ((satsys(obss[j].sat, NULL) & rtk->opt.navsys) &&
+                rtk->opt.exsats[obss[j].sat - 1] != 1) {
+                obs[nobs++] = obss[j];
+            }
+        }
+        iobs += nobslist[i];
+
+        /* ephemerides of satellites near epoch */
+        for (j = 0; j < nobs; j++) sats[j] = obs[j].sat;
+        navv = view && nobs > 0 ? navview(view, eidx, obs[0].time, sats, nobs)
+                                : navp;
+
+        /* no solution: status of sol is none, message is output */
+        stat = rtkpos(rtk, obs, nobs, navv);
+
+        /* copy to output */
+        sols[i] = rtk->sol;
+        if (mxmsg) {
+            mxSetCell(mxmsg, i, mxCreateString(stat ? "" : rtk->errbuf));
+        }
+        if (!addssat(&ssatbuf, time, rtk->ssat)) {
+            mexErrMsgTxt("pppos: memory allocation error");
+        }
+        if (rtks && isrtkout(outmode, i, n) &&
+            !rtkcopy(&rtks[nrtk++], rtk,
+                     outmode == RTKOUT_PV && i < n - 1 ? np : rtk->nx,
+                     outmode == RTKOUT_PV && i < n - 1 ? np : rtk->na)) {
+            mexErrMsgTxt("pppos: memory allocation error");
+        }
+    }
+    perfalloc(&perf, sizeof(ssatc_t) * (double)ssatbuf.nsmax);
+    perflap(&perf, PERF_COMP);
+
+    /* output */
+    argout[0] = sol2mxsol(sols, n);
+    argout[1] = ssatbuf2mxssat(&ssatbuf);
+    /* current state is returned if there is no epoch */
+    if (nargout > 2) {
+        rtkp = nrtk > 0 ? rtks : rtk;
+        argout[2] = ppph->compact ? rtk2mxrtkc(rtkp, nrtk > 0 ? nrtk : 1)
+                                  : rtk2mxrtk(rtkp, nrtk > 0 ? nrtk : 1);
+    }
+    if (mxmsg) argout[3] = mxmsg;
+    perflap(&perf, PERF_OUT);
+
+    /* free memory */
+    free(sols);
+    free(obss);
+    free(nobslist);
+    if (rtks) freertkcopy(rtks, nrtk);
+    freessatbuf(&ssatbuf);
+    freenavview(view);
+    freeephidxp(eidx, argin[2]);
+    freenavp(navp, &nav);
+    perfend(&perf);
+}
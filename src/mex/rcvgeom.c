@@ -0,0 +1,168 @@
+/**
+ * @file rcvgeom.c
+ * @brief Receiver-satellite geometry, tropospheric and ionospheric delays
+ * @author Taro Suzuki
+ * @note New development function
+ * @note Fused "geodist", "satazel", "tropmodel" and "ionmodel" in rtkcmn.c
+ * @note Receiver geodetic position, time and rotation matrix are computed
+ * once per epoch and epochs are processed in parallel by OpenMP
+ * @note Change output unit from radian to degree
+ * @note Support vector inputs
+ */
+
+#include "mex_utility.h"
+
+#define NIN 7
+
+/* zenith delays of saastamoinen model --------------------------------*/
+/* mirrors tropmodel in rtkcmn.c exactly (humi=REL_HUMI), split into     */
+/* hydrostatic/wet zenith delays zd computed once per receiver position  */
+static void tropzenith(const double *pos, double *zd) {
+    double hgt, pres, temp, e;
+
+    hgt = pos[2] < 0.0 ? 0.0 : pos[2];
+    pres = 1013.25 * pow(1.0 - 2.2557E-5 * hgt, 5.2568);
+    temp = 15.0 - 6.5E-3 * hgt + 273.16;
+    e = 6.108 * REL_HUMI * exp((17.15 * temp - 4684.0) / (temp - 38.45));
+    zd[0] = 0.0022768 * pres /
+            (1.0 - 0.00266 * cos(2.0 * pos[0]) - 0.00028 * hgt / 1E3);
+    zd[1] = 0.002277 * (1255.0 / temp + 0.05) * e;
+}
+/* slant delay of saastamoinen model ----------------------------------*/
+/* mirrors tropmodel in rtkcmn.c exactly with zenith delays by           */
+/* tropzenith (same operations, so the result is bit-identical)          */
+static double tropslant(const double *pos, const double *azel,
+                        const double *zd) {
+    double z;
+
+    if (pos[2] < -100.0 || 1E4 < pos[2] || azel[1] <= 0) return 0.0;
+    z = PI / 2.0 - azel[1];
+    return zd[0] / cos(z) + zd[1] / cos(z);
+}
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    mwSize dims[3];
+    int i, j, m, nsat, neps, nrs, nrr, nf, nthread;
+    double *eps, *rsx, *rsy, *rsz, *rrs, *ionprm, *frqs;
+    double *d, *ex, *ey, *ez, *azs, *els, *trps, *ions, nan = mxGetNaN();
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+    mxCheckSizeOfColumns(argin[0], 6);     /* epoch */
+    mxCheckSameSize(argin[1], argin[2]);   /* rsx,rsy */
+    mxCheckSameSize(argin[2], argin[3]);   /* rsy,rsz */
+    mxCheckSizeOfColumns(argin[4], 3);     /* rr */
+    mxCheckSizeOfArgument(argin[5], 1, 8); /* ionprm */
+    mxCheckSameColumns(argin[1], argin[6]); /* frequency */
+
+    /* inputs */
+    eps = (double *)mxGetPr(argin[0]);
+    neps = (int)mxGetM(argin[0]);
+    rsx = (double *)mxGetPr(argin[1]);
+    rsy = (double *)mxGetPr(argin[2]);
+    rsz = (double *)mxGetPr(argin[3]);
+    nrs = (int)mxGetM(argin[1]);
+    nsat = (int)mxGetN(argin[1]);
+    rrs = (double *)mxGetPr(argin[4]);
+    nrr = (int)mxGetM(argin[4]);
+    ionprm = (double *)mxGetPr(argin[5]);
+    frqs = (double *)mxGetPr(argin[6]);
+    nf = (int)mxGetM(argin[6]);
+    nthread = mxGetNumThreads(nargin, argin, 7);
+
+    m = neps >= nrs ? neps : nrs;
+    m = m >= nrr ? m : nrr;
+    if ((neps != 1 && neps != m) || (nrs != 1 && nrs != m) ||
+        (nrr != 1 && nrr != m)) {
+        mexErrMsgTxt("Either the number of epochs, satellite positions or "
+                     "receiver positions must be 1 or the same");
+    }
+
+    /* outputs */
+    argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    d = mxGetPr(argout[0]);
+    argout[1] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    ex = mxGetPr(argout[1]);
+    argout[2] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    ey = mxGetPr(argout[2]);
+    argout[3] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    ez = mxGetPr(argout[3]);
+    argout[4] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    azs = mxGetPr(argout[4]);
+    argout[5] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    els = mxGetPr(argout[5]);
+    argout[6] = mxCreateDoubleMatrix(m, nsat, mxREAL);
+    trps = mxGetPr(argout[6]);
+    dims[0] = m;
+    dims[1] = nsat;
+    dims[2] = nf;
+    argout[7] = mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+    ions = mxGetPr(argout[7]);
+
+    /* call RTKLIB functions (no mx API calls in parallel region) */
+#pragma omp parallel for num_threads(nthread) private(j) schedule(static)
+    for (i = 0; i < m; i++) {
+        gtime_t time;
+        double ep[6], rr[3], rs[3], e[3], enu[3], pos[3], E[9], azel[2];
+        double zd[2], ion;
+        int k, ie = neps == 1 ? 0 : i, is = nrs == 1 ? 0 : i,
+               ir = nrr == 1 ? 0 : i;
+
+        for (k = 0; k < 6; k++) ep[k] = eps[ie + neps * k];
+        for (k = 0; k < 3; k++) rr[k] = rrs[ir + nrr * k];
+        time = epoch2time(ep);
+
+        if (isnan(rr[0]) || isnan(rr[1]) || isnan(rr[2])) {
+            for (j = 0; j < nsat; j++) {
+                d[i + m * j] = ex[i + m * j] = ey[i + m * j] = nan;
+                ez[i + m * j] = azs[i + m * j] = els[i + m * j] = nan;
+                trps[i + m * j] = nan;
+                for (k = 0; k < nf; k++) ions[i + m * j + m * nsat * k] = nan;
+            }
+            continue;
+        }
+        ecef2pos(rr, pos);
+        xyz2enu(pos, E);
+
+        tropzenith(pos, zd);
+
+        for (j = 0; j < nsat; j++) {
+            rs[0] = rsx[is + nrs * j];
+            rs[1] = rsy[is + nrs * j];
+            rs[2] = rsz[is + nrs * j];
+
+            /* geometric distance and line-of-sight vector */
+            if ((d[i + m * j] = geodist(rs, rr, e)) < 0.0) {
+                e[0] = e[1] = e[2] = nan;
+            }
+            ex[i + m * j] = e[0];
+            ey[i + m * j] = e[1];
+            ez[i + m * j] = e[2];
+
+            /* azimuth/elevation angle (same as satazel) */
+            azel[0] = 0.0;
+            azel[1] = PI / 2.0;
+            if (pos[2] > -RE_WGS84) {
+                enu[0] = E[0] * e[0] + E[3] * e[1] + E[6] * e[2];
+                enu[1] = E[1] * e[0] + E[4] * e[1] + E[7] * e[2];
+                enu[2] = E[2] * e[0] + E[5] * e[1] + E[8] * e[2];
+                azel[0] = dot(enu, enu, 2) < 1E-12 ? 0.0 : atan2(enu[0], enu[1]);
+                if (azel[0] < 0.0) azel[0] += 2.0 * PI;
+                azel[1] = asin(enu[2]);
+            }
+            azs[i + m * j] = azel[0] * R2D;
+            els[i + m * j] = azel[1] * R2D;
+
+            /* tropospheric delay */
+            trps[i + m * j] = tropslant(pos, azel, zd);
+
+            /* ionospheric delay with frequency compensation */
+            ion = ionmodel(time, ionprm, pos, azel);
+            for (k = 0; k < nf; k++) {
+                ions[i + m * j + m * nsat * k] =
+                    ion * SQR(FREQ1 / frqs[k + nf * j]);
+            }
+        }
+    }
+}
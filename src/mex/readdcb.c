@@ -13,10 +13,14 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     nav_t nav = {0};
+    int col = 0;
     char file[512], errmsg[512];
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > NIN && mxIsChar(argin[nargin - 1])) {
+        col = mxgetnavcol(argin[--nargin]); /* output format */
+    }
     mxCheckChar(argin[0]); /* DCB file name */
 
     /* input */
@@ -33,7 +37,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     //mexPrintf("%f\n", nav.cbias[0][1]);
     
     /* output */
-    argout[0] = nav2mxnav(&nav);
+    argout[0] = col ? nav2mxnavc(&nav) : nav2mxnav(&nav);
 
     if (nav.n > 0) free(nav.eph);
     if (nav.ng > 0) free(nav.geph);
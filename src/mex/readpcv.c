@@ -3,6 +3,7 @@
  * @brief Read antenna parameters
  * @author Taro Suzuki
  * @note Wrapper for "readpcb" in rtkcmn.c
+ * @note PCV file is parsed once and kept between calls (pcvidx.c)
  */
 
 #include "mex_utility.h"
@@ -12,8 +13,8 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    pcvs_t pcvs = {0};
-    char file[512], errmsg[512];
+    const pcvidx_t *idx;
+    char file[512], errmsg[600];
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -23,13 +24,12 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     mxGetString(argin[0], file, sizeof(file)); /* PCV file path */
 
     /* call RTKLIB function */
-    if (!readpcv(file, &pcvs)) {
+    if (!(idx = pcvindex(file))) {
         sprintf(errmsg, "readpcv: Invalid PCV file: %s", file);
         mexErrMsgTxt(errmsg);
     }
+    if (!mexIsLocked()) mexAtExit(freepcvindex);
 
     /* output */
-    argout[0] = pcv2mxpcv(pcvs.pcv, pcvs.n);
-
-    free(pcvs.pcv);
+    argout[0] = pcv2mxpcv(idx->pcvs.pcv, idx->pcvs.n);
 }
@@ -13,11 +13,15 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     nav_t nav = {0};
+    int col = 0;
     char file[512], errmsg[512];
     gtime_t t = {0};
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > NIN && mxIsChar(argin[nargin - 1])) {
+        col = mxgetnavcol(argin[--nargin]); /* output format */
+    }
     mxCheckChar(argin[0]);
 
     /* input */
@@ -38,7 +42,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     }
 
     /* output */
-    argout[0] = nav2mxnav(&nav);
+    argout[0] = col ? nav2mxnavc(&nav) : nav2mxnav(&nav);
 
     if (nav.n > 0) free(nav.eph);
     if (nav.ng > 0) free(nav.geph);
@@ -13,18 +13,25 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     nav_t nav = {0};
+    int col = 0;
     char file[512], errmsg[512];
     gtime_t t = {0};
+    perf_t perf;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > NIN && mxIsChar(argin[nargin - 1])) {
+        col = mxgetnavcol(argin[--nargin]); /* output format */
+    }
     mxCheckChar(argin[0]);
+    perfstart(&perf, "readrnxnav");
 
     /* input */
     mxGetString(argin[0], file, sizeof(file)); /* rinex file name */
     if (nargin == 2) {
         nav = mxnav2nav(argin[1]);
     }
+    perflap(&perf, PERF_IN);
 
     /* call RTKLIB function */
     if (readrnxt(file, 1, t, t, 0, "", NULL, &nav, NULL) <= 0) {
@@ -32,13 +39,16 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         mexErrMsgTxt(errmsg);
     }
     uniqnav(&nav);
+    perfalloc(&perf, perfnav(&nav, &nav));
+    perflap(&perf, PERF_COMP);
 
     /* output */
-    argout[0] = nav2mxnav(&nav);
+    argout[0] = col ? nav2mxnavc(&nav) : nav2mxnav(&nav);
 
     if (nav.n > 0) free(nav.eph);
     if (nav.ng > 0) free(nav.geph);
     if (nav.ne > 0) free(nav.peph);
     if (nav.nc > 0) free(nav.pclk);
     if (nav.erp.n > 0) free(nav.erp.data);
+    perfend(&perf);
 }
@@ -0,0 +1,292 @@
+/**
+ * @file readrnxnavs.c
+ * @brief Read multiple RINEX navigation files
+ * @author Taro Suzuki
+ * @note New development function
+ * @note Each file is read by "readrnxt" in rinex.c on worker threads and the
+ * navigation data are merged and "uniqnav" is called once
+ */
+
+#include "mex_utility.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#define NIN 1
+#define MAXNAVTHREAD 16 /* max number of worker threads */
+
+/* navigation file read by worker thread */
+typedef struct {
+    char file[1024]; /* file path */
+    nav_t nav;       /* navigation data of file */
+    int stat;        /* status (1:ok,0:no data,-1:error) */
+} navfile_t;
+
+/* worker thread queue */
+typedef struct {
+    navfile_t *files; /* navigation files */
+    int n;            /* number of files */
+    int next;         /* index of next file */
+    lock_t lock;      /* lock of next */
+} navqueue_t;
+
+/* number of processors -----------------------------------------------*/
+static int nproc(void) {
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+/* read navigation files in queue -------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI readnavthread(void *arg)
+#else
+static void *readnavthread(void *arg)
+#endif
+{
+    navqueue_t *queue = (navqueue_t *)arg;
+    navfile_t *f;
+    gtime_t t = {0};
+    int i;
+
+    for (;;) {
+        lock(&queue->lock);
+        i = queue->next++;
+        unlock(&queue->lock);
+        if (i >= queue->n) break;
+
+        f = queue->files + i;
+        f->stat = readrnxt(f->file, 1, t, t, 0, "", NULL, &f->nav, NULL);
+    }
+    return 0;
+}
+/* read navigation files on worker threads ----------------------------*/
+static void readnavfiles(navfile_t *files, int n, int nthread) {
+    navqueue_t queue = {0};
+    thread_t thread[MAXNAVTHREAD];
+    int i, m = 0;
+
+    queue.files = files;
+    queue.n = n;
+    initlock(&queue.lock);
+
+    for (i = 1; i < nthread; i++) {
+#ifdef WIN32
+        thread[m] = CreateThread(NULL, 0, readnavthread, &queue, 0, NULL);
+        if (!thread[m]) break;
+#else
+        if (pthread_create(&thread[m], NULL, readnavthread, &queue)) break;
+#endif
+        m++;
+    }
+    readnavthread(&queue); /* calling thread also reads files */
+
+    for (i = 0; i < m; i++) {
+#ifdef WIN32
+        WaitForSingleObject(thread[i], INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i], NULL);
+#endif
+    }
+#ifdef WIN32
+    DeleteCriticalSection(&queue.lock);
+#else
+    pthread_mutex_destroy(&queue.lock);
+#endif
+}
+/* copy header parameters if set in file ------------------------------*/
+static void mergeprm(double *dst, const double *src, int n) {
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (src[i] != 0.0) break;
+    }
+    if (i < n) memcpy(dst, src, sizeof(double) * n);
+}
+/* merge navigation data of files in order of input -------------------*/
+static int mergenav(const navfile_t *files, int n, nav_t *nav) {
+    const nav_t *f;
+    int i, j, ne = 0, ng = 0;
+
+    for (i = 0; i < n; i++) {
+        ne += files[i].nav.n;
+        ng += files[i].nav.ng;
+    }
+    if ((ne > 0 && !(nav->eph = (eph_t *)malloc(sizeof(eph_t) * ne))) ||
+        (ng > 0 && !(nav->geph = (geph_t *)malloc(sizeof(geph_t) * ng)))) {
+        free(nav->eph);
+        nav->eph = NULL;
+        return 0;
+    }
+    nav->nmax = ne;
+    nav->ngmax = ng;
+
+    for (i = 0; i < n; i++) {
+        f = &files[i].nav;
+        if (f->n > 0) {
+            memcpy(nav->eph + nav->n, f->eph, sizeof(eph_t) * f->n);
+            nav->n += f->n;
+        }
+        if (f->ng > 0) {
+            memcpy(nav->geph + nav->ng, f->geph, sizeof(geph_t) * f->ng);
+            nav->ng += f->ng;
+        }
+        /* header parameters of later file overwrite as sequential read */
+        mergeprm(nav->utc_gps, f->utc_gps, 8);
+        mergeprm(nav->utc_glo, f->utc_glo, 8);
+        mergeprm(nav->utc_gal, f->utc_gal, 8);
+        mergeprm(nav->utc_qzs, f->utc_qzs, 8);
+        mergeprm(nav->utc_cmp, f->utc_cmp, 8);
+        mergeprm(nav->utc_irn, f->utc_irn, 9);
+        mergeprm(nav->utc_sbs, f->utc_sbs, 4);
+        mergeprm(nav->ion_gps, f->ion_gps, 8);
+        mergeprm(nav->ion_gal, f->ion_gal, 4);
+        mergeprm(nav->ion_qzs, f->ion_qzs, 8);
+        mergeprm(nav->ion_cmp, f->ion_cmp, 8);
+        mergeprm(nav->ion_irn, f->ion_irn, 8);
+        for (j = 0; j < 32; j++) {
+            if (f->glo_fcn[j]) nav->glo_fcn[j] = f->glo_fcn[j];
+        }
+    }
+    return 1;
+}
+/* free navigation data of files --------------------------------------*/
+static void freenavfiles(navfile_t *files, int n) {
+    int i;
+
+    for (i = 0; i < n; i++) {
+        free(files[i].nav.eph);
+        free(files[i].nav.geph);
+        free(files[i].nav.seph);
+    }
+    free(files);
+}
+/* file paths from char or cell array (wild-cards are expanded) -------*/
+static navfile_t *getnavfiles(const mxArray *mxfiles, int *n) {
+    navfile_t *files = NULL, *p;
+    char path[1024], *paths[MAXEXFILE] = {0};
+    int i, j, m, nfile, nmax = 0;
+
+    if (mxIsChar(mxfiles)) {
+        nfile = 1;
+    } else if (mxIsCell(mxfiles)) {
+        nfile = (int)mxGetNumberOfElements(mxfiles);
+    } else {
+        mexErrMsgTxt("readrnxnavs: file must be char or cell array of char");
+        return NULL;
+    }
+    for (i = 0; i < MAXEXFILE; i++) {
+        if (!(paths[i] = (char *)malloc(1024))) {
+            for (i--; i >= 0; i--) free(paths[i]);
+            mexErrMsgTxt("readrnxnavs: memory allocation error");
+        }
+    }
+    *n = 0;
+    for (i = 0; i < nfile; i++) {
+        if (mxIsChar(mxfiles)) {
+            mxGetString(mxfiles, path, sizeof(path));
+        } else {
+            mxCheckChar(mxGetCell(mxfiles, i));
+            mxGetString(mxGetCell(mxfiles, i), path, sizeof(path));
+        }
+        m = expath(path, paths, MAXEXFILE);
+
+        if (*n + m > nmax) {
+            nmax = *n + m + 16;
+            if (!(p = (navfile_t *)realloc(files, sizeof(navfile_t) * nmax))) {
+                free(files);
+                for (j = 0; j < MAXEXFILE; j++) free(paths[j]);
+                mexErrMsgTxt("readrnxnavs: memory allocation error");
+            }
+            files = p;
+        }
+        for (j = 0; j < m; j++) {
+            memset(files + *n, 0, sizeof(navfile_t));
+            strncpy(files[*n].file, paths[j], sizeof(files[*n].file) - 1);
+            (*n)++;
+        }
+    }
+    for (i = 0; i < MAXEXFILE; i++) free(paths[i]);
+    return files;
+}
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    nav_t nav = {0};
+    navfile_t *files;
+    char fmt[16] = "struct", errmsg[1100];
+    int i, n, nread = 0, nthread;
+    double *stat;
+    perf_t perf;
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+    perfstart(&perf, "readrnxnavs");
+    if (nargin > 1) {
+        mxCheckChar(argin[1]); /* output format */
+        mxGetString(argin[1], fmt, sizeof(fmt));
+        if (strcmp(fmt, "struct") && strcmp(fmt, "column") &&
+            strcmp(fmt, "handle")) {
+            mexErrMsgTxt("Output format must be \"struct\", \"column\" or "
+                         "\"handle\"");
+        }
+    }
+    if (nargin > 2) {
+        mxCheckScalar(argin[2]); /* number of threads */
+        nthread = (int)mxGetScalar(argin[2]);
+    } else {
+        nthread = nproc();
+    }
+
+    /* input */
+    files = getnavfiles(argin[0], &n);
+    if (nthread > n) nthread = n;
+    if (nthread > MAXNAVTHREAD) nthread = MAXNAVTHREAD;
+    if (nthread < 1) nthread = 1;
+    perflap(&perf, PERF_IN);
+
+    /* call RTKLIB function on worker threads */
+    readnavfiles(files, n, nthread);
+
+    for (i = 0; i < n; i++) {
+        if (files[i].stat > 0) nread++;
+        perfalloc(&perf, perfnav(&files[i].nav, &files[i].nav));
+    }
+    if (nread == 0) {
+        sprintf(errmsg, "Invalid RINEX navigation file: %s",
+                n > 0 ? files[0].file : "");
+        freenavfiles(files, n);
+        mexErrMsgTxt(errmsg);
+    }
+    if (!mergenav(files, n, &nav)) {
+        freenavfiles(files, n);
+        mexErrMsgTxt("readrnxnavs: memory allocation error");
+    }
+    uniqnav(&nav);
+    perfalloc(&perf, perfnav(&nav, &nav));
+    perflap(&perf, PERF_COMP);
+
+    /* output */
+    if (!strcmp(fmt, "handle")) {
+        argout[0] = nav2mxnavh(&nav); /* handle takes over nav */
+    } else {
+        argout[0] = strcmp(fmt, "column") ? nav2mxnav(&nav) : nav2mxnavc(&nav);
+        freenavdata(&nav);
+    }
+
+    /* read status of each file */
+    if (nargout > 1) {
+        argout[1] = mxCreateDoubleMatrix(1, n, mxREAL);
+        stat = mxGetPr(argout[1]);
+        for (i = 0; i < n; i++) stat[i] = files[i].stat > 0 ? 1.0 : 0.0;
+    }
+    freenavfiles(files, n);
+    perfend(&perf);
+}
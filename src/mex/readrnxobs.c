@@ -3,6 +3,10 @@
  * @brief Read RINEX observation file
  * @author Taro Suzuki
  * @note Wrapper for "readrnxt" in rinex.c
+ * @note Selected frequencies/observables can be read
+ * @note Parsed observation data is cached in binary format if enabled by
+ * MATRTKLIB_CACHE (see obscache.c)
+ * @note Time span, systems, satellites and signals can be selected
  */
 
 #include "mex_utility.h"
@@ -23,57 +27,208 @@ static int nextobsf(const obs_t *obs, int *i, int rcv) {
     return n;
 }
 
+/* observable selection mask from frequency and observable types */
+static void getobsmask(int nargin, const mxArray *argin[], int *obsmask) {
+    const char *FTYPE[NFREQ] = {"L1", "L2", "L5", "L6", "L7", "L8", "L9"};
+    const char OTYPE[NOBSTYPE] = {'P', 'L', 'D', 'S', 'I'};
+    char str[16], otype[16] = "";
+    int i, j, k, n, freq = 0, mask = OBSMASK_ALL;
+    const mxArray *mxf;
+
+    /* observable types {"PLDSI"} */
+    if (nargin > 2 && !mxIsEmpty(argin[2])) {
+        mxCheckChar(argin[2]);
+        mxGetString(argin[2], otype, sizeof(otype));
+        for (i = 0, mask = 0; otype[i]; i++) {
+            for (j = 0; j < NOBSTYPE; j++) {
+                if (otype[i] == OTYPE[j]) mask |= 1 << j;
+            }
+        }
+    }
+    /* frequencies {"L1","L2",...} */
+    if (nargin > 1 && !mxIsEmpty(argin[1])) {
+        n = mxIsCell(argin[1]) ? (int)mxGetNumberOfElements(argin[1]) : 1;
+        for (i = 0; i < n; i++) {
+            mxf = mxIsCell(argin[1]) ? mxGetCell(argin[1], i) : argin[1];
+            mxCheckChar(mxf);
+            mxGetString(mxf, str, sizeof(str));
+            for (k = 0; k < NFREQ; k++) {
+                if (!strcmp(str, FTYPE[k])) freq |= 1 << k;
+            }
+        }
+    } else {
+        freq = (1 << NFREQ) - 1;
+    }
+    for (k = 0; k < NFREQ; k++) {
+        obsmask[k] = (freq & (1 << k)) ? mask : 0;
+    }
+}
+
+/* observation data selection from optional arguments ----------------*/
+/* return 1 if any epoch/satellite selection is specified               */
+static int getobssel(int nargin, const mxArray *argin[], obssel_t *sel) {
+    const double *sats;
+    int i, n, sat, stat = 0;
+
+    memset(sel, 0, sizeof(obssel_t));
+    sel->navsys = SYS_ALL;
+
+    if (nargin > 3 && !mxIsEmpty(argin[3])) { /* start time */
+        mxCheckSizeOfArgument(argin[3], 1, 6);
+        sel->ts = epoch2time(mxGetPr(argin[3]));
+        stat = 1;
+    }
+    if (nargin > 4 && !mxIsEmpty(argin[4])) { /* end time */
+        mxCheckSizeOfArgument(argin[4], 1, 6);
+        sel->te = epoch2time(mxGetPr(argin[4]));
+        stat = 1;
+    }
+    if (nargin > 5 && !mxIsEmpty(argin[5])) { /* time interval */
+        mxCheckScalar(argin[5]);
+        if ((sel->tint = mxGetScalar(argin[5])) > 0.0) stat = 1;
+    }
+    if (nargin > 6 && !mxIsEmpty(argin[6])) { /* navigation system */
+        mxCheckScalar(argin[6]);
+        sel->navsys = (int)mxGetScalar(argin[6]);
+        if ((sel->navsys & SYS_ALL) != SYS_ALL) stat = 1;
+    }
+    if (nargin > 7 && !mxIsEmpty(argin[7])) { /* excluded satellites */
+        mxCheckDouble(argin[7]);
+        sats = mxGetPr(argin[7]);
+        n = (int)mxGetNumberOfElements(argin[7]);
+        for (i = 0; i < n; i++) {
+            if ((sat = (int)sats[i]) < 1 || sat > MAXSAT) {
+                mexErrMsgTxt("readrnxobs: invalid satellite number in exsats");
+            }
+            sel->exsats[sat - 1] = 1;
+            stat = 1;
+        }
+    }
+    if (nargin > 8 && !mxIsEmpty(argin[8])) { /* RINEX options */
+        mxCheckChar(argin[8]);
+        mxGetString(argin[8], sel->opt, sizeof(sel->opt));
+    }
+    return stat;
+}
+/* RINEX options with system mask of navsys ---------------------------*/
+static void rnxopt(const obssel_t *sel, char *opt) {
+    const int sys[] = {SYS_GPS, SYS_GLO, SYS_GAL, SYS_QZS,
+                       SYS_CMP, SYS_IRN, SYS_SBS};
+    const char id[] = "GREJCIS";
+    char *p = opt;
+    int i;
+
+    p += sprintf(p, "%s", sel->opt);
+    if ((sel->navsys & SYS_ALL) == SYS_ALL) return;
+    p += sprintf(p, " -SYS=");
+    for (i = 0; i < 7; i++) {
+        if (!(sel->navsys & sys[i])) continue;
+        p += sprintf(p, "%s%c", p[-1] == '=' ? "" : ",", id[i]);
+    }
+}
+/* set station position and glo_fcn outputs ---------------------------*/
+static void setoutputs(mxArray *argout[], const double *pos,
+                       const double *fcn) {
+    argout[1] = mxCreateDoubleMatrix(1, 3, mxREAL);
+    memcpy(mxGetPr(argout[1]), pos, 3 * sizeof(double));
+    argout[2] = mxCreateDoubleMatrix(1, 32, mxREAL);
+    memcpy(mxGetPr(argout[2]), fcn, 32 * sizeof(double));
+}
+
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     obs_t obs = {0};
     nav_t nav = {0};
     sta_t sta = {0};
-    gtime_t t = {0};
-    char file[512], errmsg[512];
-    int i, n, m, iobs, *nobslist;
-    double *xyz, *glo_fcn;
+    obssel_t sel;
+    obsd_t *data;
+    char file[512], errmsg[512], opt[320];
+    int i, n, m, iobs, *nobslist, obsmask[NFREQ], cache, filt;
+    double pos[3], fcn[32];
+    perf_t perf;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
     mxCheckChar(argin[0]); /* rinex file name */
+    perfstart(&perf, "readrnxobs");
 
     /* input */
     mxGetString(argin[0], file, sizeof(file)); /* rinex file name */
+    getobsmask(nargin, argin, obsmask);        /* selected observables */
+    filt = getobssel(nargin, argin, &sel);     /* selected epochs/satellites */
+    perflap(&perf, PERF_IN);
+
+    /* outputs from valid cache (RINEX options need to parse file) */
+    cache = useobscache(file) && !sel.opt[0];
+    if (cache && !filt && readobscache(file, obsmask, &argout[0], pos, fcn)) {
+        perflap(&perf, PERF_COMP);
+        setoutputs(argout, pos, fcn);
+        perfend(&perf);
+        return;
+    }
+    if (cache && filt &&
+        (data = readobscacheobs(file, &sel, &n, &nobslist, pos, fcn))) {
+        perfalloc(&perf, perfobs(nobslist, n));
+        perflap(&perf, PERF_COMP);
+        argout[0] = obs2mxobs(data, n, nobslist, obsmask);
+        setoutputs(argout, pos, fcn);
+        free(data);
+        free(nobslist);
+        perfend(&perf);
+        return;
+    }
 
-    /* call RTKLIB function */
-    if (readrnxt(file, 1, t, t, 0, "", &obs, &nav, &sta) <= 0) {
+    /* call RTKLIB function (time span and systems are selected in reader) */
+    rnxopt(&sel, opt);
+    if (readrnxt(file, 1, sel.ts, sel.te, sel.tint, opt, &obs, &nav, &sta) <=
+        0) {
 		sprintf(errmsg, "Invalid RINEX observation file: %s", file);
         mexErrMsgTxt(errmsg);
     }
     // mexPrintf("%f,%f,%f\n",sta.pos[0],sta.pos[1],sta.pos[2]);
 
+    /* exclude satellites */
+    if (filt) {
+        for (i = n = 0; i < obs.n; i++) {
+            if (!(satsys(obs.data[i].sat, NULL) & sel.navsys) ||
+                sel.exsats[obs.data[i].sat - 1]) {
+                continue;
+            }
+            obs.data[n++] = obs.data[i];
+        }
+        obs.n = n;
+    }
+
     /* count epochs */
     for (iobs = 0, n = 0; (m = nextobsf(&obs, &iobs, 1)) > 0; iobs += m) {
         n++;
     }
 
     /* count each number of observations */
-    if (!(nobslist = (int *)calloc(n, sizeof(int)))) {
+    if (!(nobslist = (int *)calloc(n + 1, sizeof(int)))) {
         mexErrMsgTxt("readrnxobs: memory allocation error");
     }
     for (iobs = 0, i = 0; (m = nextobsf(&obs, &iobs, 1)) > 0; iobs += m, i++) {
         nobslist[i] = m;
     }
 
-    /* outputs */
-    argout[0] = obs2mxobs(obs.data, n, nobslist);
-
-    /* station position in ECEF */
-    argout[1] = mxCreateDoubleMatrix(1, 3, mxREAL);
-    xyz = mxGetPr(argout[1]);
-    memcpy(xyz, sta.pos, 3 * sizeof(double));
+    /* station position in ECEF and glo_fcn */
+    memcpy(pos, sta.pos, 3 * sizeof(double));
+    int2double(nav.glo_fcn, 32, fcn);
+    perfalloc(&perf, sizeof(obsd_t) * (double)obs.nmax + sizeof(int) * (n + 1.0));
+    perflap(&perf, PERF_COMP);
 
-    /* glo_fcn */
-    argout[2] = mxCreateDoubleMatrix(1, 32, mxREAL);
-    glo_fcn = mxGetPr(argout[2]);
-    int2double(nav.glo_fcn, 32, glo_fcn);
+    /* outputs (all observables of whole file are converted if cached) */
+    cache = cache && !filt;
+    argout[0] = obs2mxobs(obs.data, n, nobslist, cache ? NULL : obsmask);
+    if (cache) {
+        writeobscache(file, argout[0], pos, fcn);
+        pruneobs(argout[0], obsmask);
+    }
+    setoutputs(argout, pos, fcn);
 
     free(nobslist);
     freeobs(&obs);
-}
\ No newline at end of file
+    perfend(&perf);
+}
@@ -3,6 +3,7 @@
  * @brief Read satellite antenna parameters
  * @author Taro Suzuki
  * @note Wrapper for "readsap" in rinex.c
+ * @note ANTEX file is indexed once and kept between calls (pcvidx.c)
  */
 
 #include "mex_utility.h"
@@ -12,12 +13,19 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
+    const pcvidx_t *idx;
+    const pcv_t *pcv;
     nav_t nav = {0};
-    char file[512], errmsg[512];
+    pcv_t pcv0 = {0};
+    int i, col = 0;
+    char file[512], errmsg[600];
     gtime_t time;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > NIN && mxIsChar(argin[nargin - 1])) {
+        col = mxgetnavcol(argin[--nargin]); /* output format */
+    }
     mxCheckChar(argin[0]);                 /* antex file name */
     mxCheckSizeOfArgument(argin[1], 1, 6); /* epoch */
 
@@ -29,14 +37,19 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         nav = mxnav2nav(argin[2]);
     }
 
-    /* call RTKLIB function */
-    if (!readsap(file, time, &nav)) {
+    /* call RTKLIB function (same as readsap) */
+    if (!(idx = pcvindex(file))) {
         sprintf(errmsg, "readsap: invalid ANTEX file: %s", file);
         mexErrMsgTxt(errmsg);
     }
+    if (!mexIsLocked()) mexAtExit(freepcvindex);
+    for (i = 0; i < MAXSAT; i++) {
+        pcv = searchpcvidx(idx, i + 1, "", time);
+        nav.pcvs[i] = pcv ? *pcv : pcv0;
+    }
 
     /* output */
-    argout[0] = nav2mxnav(&nav);
+    argout[0] = col ? nav2mxnavc(&nav) : nav2mxnav(&nav);
 
     if (nav.n > 0) free(nav.eph);
     if (nav.ng > 0) free(nav.geph);
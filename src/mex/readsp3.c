@@ -13,11 +13,15 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     nav_t nav = {{0}};
+    int col = 0;
     char file[512];
     gtime_t t = {0};
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > NIN && mxIsChar(argin[nargin - 1])) {
+        col = mxgetnavcol(argin[--nargin]); /* output format */
+    }
     mxCheckChar(argin[0]); /* SP3 file name */
 
     /* input */
@@ -36,7 +40,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     readsp3(file, &nav, 0);
 
     /* output */
-    argout[0] = nav2mxnav(&nav);
+    argout[0] = col ? nav2mxnavc(&nav) : nav2mxnav(&nav);
 
     if (nav.n > 0) free(nav.eph);
     if (nav.ng > 0) free(nav.geph);
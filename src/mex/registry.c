@@ -0,0 +1,196 @@
+/**
+ * @file registry.c
+ * @brief Registry of resident objects shared by all mex files
+ * @author Taro Suzuki
+ * @note Resident objects (navigation data, PPP sessions) are referred from
+ * MATLAB by registry id (kind, generation and slot), not by address, and every
+ * id passed from MATLAB is validated against the registry before use, so that
+ * garbage, freed or stale handles are rejected
+ * @note Registry is one table per process, which is shared by mex files
+ * (separate shared libraries) through environment variable MATRTKLIB_REGISTRY
+ * ("pid:address"). The variable is written only by this file and the registry
+ * is never unmapped until MATLAB exits, so the address is valid if the process
+ * id is the current process (variable inherited by child process or set
+ * before MATLAB is ignored). The registry header (signature, version, process
+ * id, self address and size) is checked before use
+ * @note Registry is accessed only from MATLAB thread (outside of parallel
+ * loops)
+ */
+
+#include "mex_utility.h"
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define REG_VAR "MATRTKLIB_REGISTRY"        /* environment variable */
+#define REG_SIGNATURE 0x4D52545245474953ULL /* signature of registry */
+#define REG_VERSION 2                       /* version of registry layout */
+#define MAXREG 4096                         /* max number of objects */
+#define REGOBJ_MAX 8                        /* max number of singletons */
+
+/* registry entry */
+typedef struct {
+    uint64_t id;       /* id (0: empty) */
+    void *ptr;         /* object */
+    const void *owner; /* owner module (NULL: freed by caller) */
+} regent_t;
+
+/* registry */
+typedef struct {
+    uint64_t signature;    /* signature of registry */
+    uint64_t version;      /* version of registry layout */
+    uint64_t pid;          /* process id */
+    const void *self;      /* address of registry */
+    uint64_t size;         /* size of registry (layout check) */
+    uint64_t gen;          /* generation counter */
+    void *obj[REGOBJ_MAX]; /* process-wide objects */
+    regent_t ent[MAXREG];  /* entries */
+} registry_t;
+
+static registry_t *reg = NULL; /* registry (cached in each mex file) */
+
+/* current process id -----------------------------------------------*/
+static uint64_t getpid_(void) {
+#ifdef WIN32
+    return (uint64_t)GetCurrentProcessId();
+#else
+    return (uint64_t)getpid();
+#endif
+}
+/* check registry header ----------------------------------------------*/
+static int isregistry(const registry_t *r) {
+    return r->signature == REG_SIGNATURE && r->version == REG_VERSION &&
+           r->pid == getpid_() && r->self == (const void *)r &&
+           r->size == sizeof(registry_t);
+}
+/* registry of process (created on first use) -------------------------*/
+static registry_t *getreg(void) {
+    unsigned long long pid = 0, addr = 0;
+    char buff[64] = "";
+    registry_t *r;
+
+    if (reg) return reg;
+#ifdef WIN32
+    GetEnvironmentVariableA(REG_VAR, buff, sizeof(buff));
+#else
+    if (getenv(REG_VAR)) {
+        strncpy(buff, getenv(REG_VAR), sizeof(buff) - 1);
+    }
+#endif
+    /* address is dereferenced only if it was set by current process */
+    if (sscanf(buff, "%llu:%llx", &pid, &addr) == 2 && pid == getpid_() &&
+        addr && addr % 4096 == 0 &&
+        isregistry((const registry_t *)(uintptr_t)addr)) {
+        return reg = (registry_t *)(uintptr_t)addr;
+    }
+    /* new registry (zero-filled pages) */
+#ifdef WIN32
+    if (!(r = (registry_t *)VirtualAlloc(NULL, sizeof(registry_t),
+                                         MEM_COMMIT | MEM_RESERVE,
+                                         PAGE_READWRITE))) {
+        mexErrMsgTxt("registry: memory allocation error");
+    }
+#else
+    if ((r = (registry_t *)mmap(NULL, sizeof(registry_t),
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) ==
+        MAP_FAILED) {
+        mexErrMsgTxt("registry: memory allocation error");
+    }
+#endif
+    r->signature = REG_SIGNATURE;
+    r->version = REG_VERSION;
+    r->pid = getpid_();
+    r->self = r;
+    r->size = sizeof(registry_t);
+    sprintf(buff, "%llu:%llx", (unsigned long long)r->pid,
+            (unsigned long long)(uintptr_t)r);
+#ifdef WIN32
+    SetEnvironmentVariableA(REG_VAR, buff);
+#else
+    setenv(REG_VAR, buff, 1);
+#endif
+    return reg = r;
+}
+/* entry of id (NULL: invalid or freed) -------------------------------*/
+static regent_t *regent(const int kind, const uint64_t id) {
+    registry_t *r = getreg();
+    uint64_t slot = id & 0xFFFF;
+
+    if (!id || (int)(id >> 56) != kind || slot >= MAXREG) return NULL;
+    return r->ent[slot].id == id ? r->ent + slot : NULL;
+}
+
+/* register object (0: registry full) ---------------------------------*/
+/* kind : kind of object (REG_???)                                       */
+/* owner: module freeing object at exit (NULL: freed by caller)          */
+extern uint64_t regadd(const int kind, void *ptr, const void *owner) {
+    registry_t *r = getreg();
+    int i;
+
+    for (i = 0; i < MAXREG; i++) {
+        if (!r->ent[i].id) break;
+    }
+    if (i >= MAXREG) return 0;
+    r->gen = (r->gen + 1) & 0xFFFFFFFFFFULL;
+    r->ent[i].id = ((uint64_t)kind << 56) | (r->gen << 16) | (uint64_t)i;
+    r->ent[i].ptr = ptr;
+    r->ent[i].owner = owner;
+    return r->ent[i].id;
+}
+/* object of id (NULL: invalid or freed) ------------------------------*/
+extern void *regget(const int kind, const uint64_t id) {
+    regent_t *e = regent(kind, id);
+
+    return e ? e->ptr : NULL;
+}
+/* unregister object (NULL: invalid or freed) -------------------------*/
+extern void *regdel(const int kind, const uint64_t id) {
+    regent_t *e = regent(kind, id);
+    void *ptr;
+
+    if (!e) return NULL;
+    ptr = e->ptr;
+    memset(e, 0, sizeof(regent_t));
+    return ptr;
+}
+/* set owner of object ------------------------------------------------*/
+extern void regsetowner(const int kind, const uint64_t id, const void *owner) {
+    regent_t *e = regent(kind, id);
+
+    if (e) e->owner = owner;
+}
+/* first id of objects owned by owner (0: none) -----------------------*/
+extern uint64_t regfirst(const int kind, const void *owner) {
+    registry_t *r = getreg();
+    int i;
+
+    for (i = 0; i < MAXREG; i++) {
+        if (r->ent[i].id && (int)(r->ent[i].id >> 56) == kind &&
+            r->ent[i].owner == owner) {
+            return r->ent[i].id;
+        }
+    }
+    return 0;
+}
+/* number of objects owned by owner -----------------------------------*/
+extern int regnum(const int kind, const void *owner) {
+    registry_t *r = getreg();
+    int i, n = 0;
+
+    for (i = 0; i < MAXREG; i++) {
+        n += r->ent[i].id && (int)(r->ent[i].id >> 56) == kind &&
+             r->ent[i].owner == owner;
+    }
+    return n;
+}
+/* process-wide object (NULL: not set) --------------------------------*/
+extern void *regobj(const int obj) {
+    return obj >= 0 && obj < REGOBJ_MAX ? getreg()->obj[obj] : NULL;
+}
+/* set process-wide object --------------------------------------------*/
+extern void regsetobj(const int obj, void *ptr) {
+    if (obj >= 0 && obj < REGOBJ_MAX) getreg()->obj[obj] = ptr;
+}
@@ -2,6 +2,9 @@
  * @file rtk2rtk.c
  * @brief Convert mxArray mxrtk to rtk_t rtk, and vice versa
  * @author Taro Suzuki
+ * @note Compact rtk struct has states with non-zero state or covariance only
+ * (active states): indexes (ix/ia), states (x/xa) and lower triangle of
+ * covariance packed by column (P/Pa)
  */
 
 #include "mex_utility.h"
@@ -57,8 +60,140 @@ extern mxArray *rtk2mxrtk(const rtk_t *rtks, const int n) {
 
     return mxrtk;
 }
+/* active states (non-zero state or covariance row) -------------------*/
+static int activestates(const double *x, const double *P, const int n, int *ix) {
+    int i, j, m = 0;
+
+    for (i = 0; i < n; i++) {
+        if (x[i] == 0.0) {
+            for (j = 0; j < n && P[i + j * n] == 0.0; j++);
+            if (j >= n) continue;
+        }
+        ix[m++] = i;
+    }
+    return m;
+}
+/* set compact states to mxrtk ----------------------------------------*/
+static void setcompact(mxArray *mxrtk, const int i, const char **f,
+                       const double *x, const double *P, const int n) {
+    mxArray *mxi, *mxx, *mxP;
+    double *pi, *px, *pP;
+    int j, k, m, *ix;
+
+    if (!(ix = (int *)malloc(sizeof(int) * (n + 1)))) {
+        mexErrMsgTxt("rtk2mxrtkc: memory allocation error");
+    }
+    m = activestates(x, P, n, ix);
+    mxi = mxCreateDoubleMatrix(1, m, mxREAL);
+    mxx = mxCreateDoubleMatrix(1, m, mxREAL);
+    mxP = mxCreateDoubleMatrix(1, (mwSize)m * (m + 1) / 2, mxREAL);
+    pi = mxGetPr(mxi);
+    px = mxGetPr(mxx);
+    pP = mxGetPr(mxP);
+    for (j = 0; j < m; j++) {
+        pi[j] = ix[j] + 1;
+        px[j] = x[ix[j]];
+    }
+    for (k = 0; k < m; k++) {
+        for (j = k; j < m; j++) *pP++ = P[ix[j] + ix[k] * n];
+    }
+    mxSetField(mxrtk, i, f[0], mxi);
+    mxSetField(mxrtk, i, f[1], mxx);
+    mxSetField(mxrtk, i, f[2], mxP);
+    free(ix);
+}
+/* get compact states from mxrtk --------------------------------------*/
+static void getcompact(const mxArray *mxrtk, const char **f, double *x,
+                       double *P, const int n) {
+    const mxArray *mxi = mxGetField(mxrtk, 0, f[0]);
+    const mxArray *mxx = mxGetField(mxrtk, 0, f[1]);
+    const mxArray *mxP = mxGetField(mxrtk, 0, f[2]);
+    const double *pi, *px, *pP;
+    int j, k, m, *ix;
+
+    m = mxi ? (int)mxGetNumberOfElements(mxi) : 0;
+    if (!mxx || !mxP || (int)mxGetNumberOfElements(mxx) != m ||
+        (int)mxGetNumberOfElements(mxP) != m * (m + 1) / 2) {
+        mexErrMsgTxt("mxrtk2rtk: invalid size of compact states");
+    }
+    if (!(ix = (int *)malloc(sizeof(int) * (m + 1)))) {
+        mexErrMsgTxt("mxrtk2rtk: memory allocation error");
+    }
+    pi = mxGetPr(mxi);
+    px = mxGetPr(mxx);
+    pP = mxGetPr(mxP);
+    for (j = 0; j < m; j++) {
+        ix[j] = (int)pi[j] - 1;
+        if (ix[j] < 0 || ix[j] >= n) {
+            free(ix);
+            mexErrMsgTxt("mxrtk2rtk: invalid index of compact states");
+        }
+    }
+    for (j = 0; j < n; j++) x[j] = 0.0;
+    for (j = 0; j < n * n; j++) P[j] = 0.0;
+    for (j = 0; j < m; j++) x[ix[j]] = px[j];
+    for (k = 0; k < m; k++) {
+        for (j = k; j < m; j++, pP++) {
+            P[ix[j] + ix[k] * n] = P[ix[k] + ix[j] * n] = *pP;
+        }
+    }
+    free(ix);
+}
+/* rtk2mxrtkc ---------------------------------------------------------*/
+/* rtk_t to compact rtk struct (active states only)                      */
+extern mxArray *rtk2mxrtkc(const rtk_t *rtks, const int n) {
+    mxArray *mxrtk, *mxep, *mxrb;
+    double ep[6];
+    int i;
+
+    /* output struct */
+    const char *rtkf[] = {"ep", "rb", "nx", "na", "tt",   "ix",    "x",
+                          "P",  "ia", "xa", "Pa", "nfix", "errmsg"};
+    const char *xf[] = {"ix", "x", "P"}, *af[] = {"ia", "xa", "Pa"};
+    mxrtk = mxCreateStructMatrix(n, 1, 13, rtkf);
+
+    for (i = 0; i < n; i++) {
+        /* epoch time */
+        mxep = mxCreateDoubleMatrix(1, 6, mxREAL);
+        time2epoch(rtks[i].sol.time, ep);
+        memcpy(mxGetPr(mxep), ep, 6 * sizeof(double));
+        mxSetField(mxrtk, i, "ep", mxep);
+        /* rb */
+        mxrb = mxCreateDoubleMatrix(1, 6, mxREAL);
+        memcpy(mxGetPr(mxrb), rtks[i].rb, 6 * sizeof(double));
+        mxSetField(mxrtk, i, "rb", mxrb);
+        /* nx, na, tt */
+        mxSetField(mxrtk, i, "nx", mxCreateDoubleScalar(rtks[i].nx));
+        mxSetField(mxrtk, i, "na", mxCreateDoubleScalar(rtks[i].na));
+        mxSetField(mxrtk, i, "tt", mxCreateDoubleScalar(rtks[i].tt));
+        /* ix, x, P and ia, xa, Pa */
+        setcompact(mxrtk, i, xf, rtks[i].x, rtks[i].P, rtks[i].nx);
+        setcompact(mxrtk, i, af, rtks[i].xa, rtks[i].Pa, rtks[i].na);
+        /* nfix */
+        mxSetField(mxrtk, i, "nfix", mxCreateDoubleScalar(rtks[i].nfix));
+        /* errbuf */
+        mxSetField(mxrtk, i, "errmsg", mxCreateString(rtks[i].errbuf));
+    }
+    return mxrtk;
+}
+/* mxisrtkc -----------------------------------------------------------*/
+extern int mxisrtkc(const mxArray *mxrtk) {
+    return mxIsStruct(mxrtk) && mxGetFieldNumber(mxrtk, "ix") >= 0;
+}
+/* get format of rtk struct (1: compact, 0: full) ---------------------*/
+extern int getrtkfmt(const mxArray *mxfmt) {
+    char str[16] = "";
+
+    if (mxIsChar(mxfmt)) mxGetString(mxfmt, str, sizeof(str));
+    if (!strcmp(str, "full")) return 0;
+    if (!strcmp(str, "compact")) return 1;
+    mexErrMsgTxt("Format of rtk struct must be \"full\" or \"compact\"");
+    return 0;
+}
 /* mxrtk2rtk ----------------------------------------------------------*/
+/* rtk struct (full or compact) to rtk_t                                 */
 extern rtk_t mxrtk2rtk(const mxArray *mxrtk, const prcopt_t *popt, const sol_t *sol) {
+    const char *xf[] = {"ix", "x", "P"}, *af[] = {"ia", "xa", "Pa"};
     rtk_t rtk;
     double ep[6];
 
@@ -79,20 +214,87 @@ extern rtk_t mxrtk2rtk(const mxArray *mxrtk, const prcopt_t *popt, const sol_t *
     rtk.na = (int)mxGetScalar(mxGetField(mxrtk, 0, "na"));
     /* tt */
     rtk.tt = mxGetScalar(mxGetField(mxrtk, 0, "tt"));
-    /* x */
-    memcpy(rtk.x, (double *)mxGetPr(mxGetField(mxrtk, 0, "x")),
-           rtk.nx * sizeof(double));
-    /* P */
-    memcpy(rtk.P, (double *)mxGetPr(mxGetField(mxrtk, 0, "P")),
-           rtk.nx * rtk.nx * sizeof(double));
-    /* xa */
-    memcpy(rtk.xa, (double *)mxGetPr(mxGetField(mxrtk, 0, "xa")),
-           rtk.na * sizeof(double));
-    /* Pa */
-    memcpy(rtk.Pa, (double *)mxGetPr(mxGetField(mxrtk, 0, "Pa")),
-           rtk.na * rtk.na * sizeof(double));
+    if (mxisrtkc(mxrtk)) {
+        /* ix, x, P and ia, xa, Pa */
+        getcompact(mxrtk, xf, rtk.x, rtk.P, rtk.nx);
+        getcompact(mxrtk, af, rtk.xa, rtk.Pa, rtk.na);
+    } else {
+        /* x */
+        memcpy(rtk.x, (double *)mxGetPr(mxGetField(mxrtk, 0, "x")),
+               rtk.nx * sizeof(double));
+        /* P */
+        memcpy(rtk.P, (double *)mxGetPr(mxGetField(mxrtk, 0, "P")),
+               rtk.nx * rtk.nx * sizeof(double));
+        /* xa */
+        memcpy(rtk.xa, (double *)mxGetPr(mxGetField(mxrtk, 0, "xa")),
+               rtk.na * sizeof(double));
+        /* Pa */
+        memcpy(rtk.Pa, (double *)mxGetPr(mxGetField(mxrtk, 0, "Pa")),
+               rtk.na * rtk.na * sizeof(double));
+    }
     /* nfix */
     rtk.nfix = (int)mxGetScalar(mxGetField(mxrtk, 0, "nfix"));
 
     return rtk;
 }
+/* get output mode ----------------------------------------------------*/
+extern int getrtkout(const mxArray *mxmode) {
+    char str[16];
+    int n;
+
+    if (mxIsChar(mxmode)) {
+        mxGetString(mxmode, str, sizeof(str));
+        if (!strcmp(str, "final")) return RTKOUT_FINAL;
+        if (!strcmp(str, "pv")) return RTKOUT_PV;
+        if (!strcmp(str, "all")) return 1;
+    } else if (mxIsNumeric(mxmode) && mxGetNumberOfElements(mxmode) == 1) {
+        if ((n = (int)mxGetScalar(mxmode)) > 0) return n;
+    }
+    mexErrMsgTxt("Output mode of rtk struct must be \"final\", \"pv\", \"all\" "
+                 "or positive integer");
+    return RTKOUT_FINAL;
+}
+/* output rtk struct of i-th epoch or not -----------------------------*/
+extern int isrtkout(const int mode, const int i, const int n) {
+    if (i == n - 1) return 1;
+    if (mode == RTKOUT_PV) return 1;
+    return mode > 0 && (i + 1) % mode == 0;
+}
+/* copy rtk_t (leading nx float and na fixed states) ------------------*/
+extern int rtkcopy(rtk_t *dist, const rtk_t *src, const int nx, const int na) {
+    int i, j;
+
+    memcpy(&(dist->sol), &(src->sol), sizeof(src->sol));
+    memcpy(dist->rb, src->rb, sizeof(src->rb));
+    dist->nx = nx;
+    dist->na = na;
+    dist->tt = src->tt;
+    if (!(dist->x = (double *)malloc(sizeof(double) * (nx + 1))) ||
+        !(dist->P = (double *)malloc(sizeof(double) * (nx * nx + 1))) ||
+        !(dist->xa = (double *)malloc(sizeof(double) * (na + 1))) ||
+        !(dist->Pa = (double *)malloc(sizeof(double) * (na * na + 1)))) {
+        return 0;
+    }
+    memcpy(dist->x, src->x, sizeof(double) * nx);
+    memcpy(dist->xa, src->xa, sizeof(double) * na);
+    for (j = 0; j < nx; j++) {
+        for (i = 0; i < nx; i++) dist->P[i + j * nx] = src->P[i + j * src->nx];
+    }
+    for (j = 0; j < na; j++) {
+        for (i = 0; i < na; i++) dist->Pa[i + j * na] = src->Pa[i + j * src->na];
+    }
+    dist->nfix = src->nfix;
+    memcpy(dist->errbuf, src->errbuf, sizeof(src->errbuf));
+    return 1;
+}
+/* free rtk_t copied by rtkcopy ---------------------------------------*/
+extern void freertkcopy(rtk_t *rtks, const int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        free(rtks[i].x);
+        free(rtks[i].P);
+        free(rtks[i].xa);
+        free(rtks[i].Pa);
+    }
+    free(rtks);
+}
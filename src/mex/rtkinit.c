@@ -3,6 +3,7 @@
  * @brief Initialize RTK control struct
  * @author Taro Suzuki
  * @note Wrapper for "rtkinit" in rtkpos.c
+ * @note Output rtk struct can be compact struct (active states only)
  */
 
 #include "mex_utility.h"
@@ -17,13 +18,14 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     rtk_t rtk;
     prcopt_t popt = prcopt_default;
     solopt_t sopt = solopt_default;
-    int i;
+    int i, compact = 0;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
 
     /* input option struct */
     mxopt2opt(argin[0], &popt, &sopt);
+    if (nargin > 1) compact = getrtkfmt(argin[1]);
 
     /* call RTKLIB function */
     rtkinit(&rtk, &popt);
@@ -32,7 +34,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     for (i = 0; i < 3; i++) rtk.rb[i] = popt.rb[i];
 
     /* output */
-    argout[0] = rtk2mxrtk(&rtk, 1);
+    argout[0] = compact ? rtk2mxrtkc(&rtk, 1) : rtk2mxrtk(&rtk, 1);
 
     rtkfree(&rtk);
 }
\ No newline at end of file
@@ -4,6 +4,11 @@
  * @author Taro Suzuki
  * @note Wrapper for "rtkpos" in rtkpos.c
  * @note Due to a conflict, file name was changed from rtkpos.c to rtkpos_.c
+ * @note Output rtk struct is selected by output mode (default: final epoch),
+ * final epoch has full state in any mode
+ * @note Output rtk struct is compact struct if input rtk struct is compact
+ * @note Ephemerides are selected from ephemerides near epoch by per-satellite
+ * index (ephidx.c)
  */
 
 #include "mex_utility.h"
@@ -20,43 +25,38 @@
 #define NR(opt) (NP(opt) + NI(opt) + NT(opt) + NL(opt))
 #define NX(opt) (NR(opt) + NB(opt))
 
-/* copy rtk_t */
-void rtkcopy(rtk_t *dist, const rtk_t *src) {
-    memcpy(&(dist->sol), &(src->sol), sizeof(src->sol));
-    memcpy(dist->rb, src->rb, sizeof(src->rb));
-    dist->nx = src->nx;
-    dist->na = src->na;
-    dist->tt = src->tt;
-    memcpy(dist->x, src->x, sizeof(double)*src->nx);
-    memcpy(dist->P, src->P, sizeof(double)*src->nx*src->nx);
-    memcpy(dist->xa, src->xa, sizeof(double)*src->na);
-    memcpy(dist->Pa, src->Pa, sizeof(double)*src->na*src->na);
-    dist->nfix = src->nfix;
-    memcpy(dist->errbuf, src->errbuf, sizeof(src->errbuf));
-}
-
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     obsd_t obsrb[MAXOBS * 2], *obsr, *obsb;
-    nav_t nav = {0};
+    nav_t nav = {0}, *navp;
+    const nav_t *navv;
+    ephidx_t *eidx;
+    navview_t *view;
     prcopt_t popt = prcopt_default;
     solopt_t sopt = solopt_default;
     rtk_t rtk, *rtks;
-    ssat_t *ssats;
-    gtime_t *times;
+    const rtk_t *rtkp;
+    ssatbuf_t ssatbuf = {0};
+    gtime_t time;
     solbuf_t solbuf = {0};
-    int i, j, nx, nr, nb;
+    int i, j, nx, nr, nb, nxout, naout, nrtk = 0, base, outmode = RTKOUT_FINAL;
     int iobsr = 0, iobsb = 0, nobsrb = 0, nobsr = 0, nobsb = 0;
-    int *nobsrlist = NULL, *nobsblist = NULL;
+    int *nobsrlist = NULL, *nobsblist = NULL, sats[MAXOBS * 2];
     char tracefile[] = "rtkpos.trace";
+    perf_t perf;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
+    perfstart(&perf, "rtkpos");
 
     /* input opt struct */
     mxopt2opt(argin[3], &popt, &sopt);
 
+    /* base observation (can be empty) and output mode */
+    base = nargin > 4 && !mxIsEmpty(argin[4]);
+    if (nargin > 5) outmode = getrtkout(argin[5]);
+
     /* trace file */
     if (sopt.trace > 0) {
         mexPrintf("trace level=%d\n", sopt.trace);
@@ -78,7 +78,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
 
     /* input obs struct */
     obsr = mxobs2obs(argin[1], 1, &nr, &nobsrlist);
-    if (nargin == 5) {
+    if (base) {
         obsb = mxobs2obs(argin[4], 2, &nb, &nobsblist);
         if (nr != nb) {
             rtkfree(&rtk);
@@ -89,24 +89,28 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     }
 
     /* input nav struct */
-    nav = mxnav2nav(argin[2]);
+    navp = mxnav2navp(argin[2], &nav);
+    eidx = mxnav2ephidx(argin[2], navp);
+    view = newnavview(navp);
+    perfalloc(&perf, sizeof(double) * ((double)rtk.nx * (rtk.nx + 1) +
+                                       (double)rtk.na * (rtk.na + 1)));
+    perfalloc(&perf, perfobs(nobsrlist, nr) + perfnav(navp, &nav));
+    if (base) perfalloc(&perf, perfobs(nobsblist, nb));
 
     /* outputs */
-    /* ssats */
-    if (!(ssats = (ssat_t *)calloc(MAXSAT*nr, sizeof(ssat_t)))) {
-        mexErrMsgTxt("rtkpos: memory allocation error");
-    }
-    /* times */
-    if (!(times = (gtime_t *)calloc(nr, sizeof(gtime_t)))) {
-        mexErrMsgTxt("rtkpos: memory allocation error");
-    }
-    /* rtk */
-    if (!(rtks = (rtk_t *)calloc(nr, sizeof(rtk_t)))) {
+    /* rtk (selected epochs only, position/velocity block for "pv" mode, */
+    /* final epoch with full state in any mode to continue processing)    */
+    for (i = 0; i < nr; i++) nrtk += isrtkout(outmode, i, nr);
+    if (!(rtks = (rtk_t *)calloc(nrtk > 0 ? nrtk : 1, sizeof(rtk_t)))) {
         mexErrMsgTxt("rtkpos: memory allocation error");
     }
-    for (i=0; i<nr; i++) {
-        rtkinit(&rtks[i], &popt);
-    }
+    nxout = outmode == RTKOUT_PV ? NP(&popt) : rtk.nx;
+    naout = outmode == RTKOUT_PV ? NP(&popt) : rtk.na;
+    perfalloc(&perf, nrtk * (sizeof(rtk_t) +
+                             sizeof(double) * ((double)nxout * (nxout + 1) +
+                                               (double)naout * (naout + 1))));
+    nrtk = 0;
+    perflap(&perf, PERF_IN);
 
     /* rtk processing */
     for (i = 0; i < nr; i++) {
@@ -116,6 +120,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         memset(rtk.errbuf, 0, MAXERRMSG);
 
         /* exclude satellites */
+        time = nobsrlist[i] > 0 ? obsr[iobsr].time : rtk.sol.time;
         for (j = 0; j < nobsrlist[i]; j++) {
             if ((satsys(obsr[iobsr+j].sat, NULL) & popt.navsys) &&
                 popt.exsats[obsr[iobsr+j].sat - 1] != 1) {
@@ -125,39 +130,59 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         iobsr += nobsrlist[i];
 
         /* call rtkpos */
-        if (nargin == 5) {
+        if (base) {
             nobsb = nobsblist[i];
             memcpy(&obsrb[nobsr], &obsb[iobsb], nobsb * sizeof(obsd_t));
             iobsb += nobsb;
         }
-        if (!rtkpos(&rtk, obsrb, nobsr+nobsb, &nav)) {
+        /* ephemerides of satellites near epoch */
+        for (j = 0; j < nobsr + nobsb; j++) sats[j] = obsrb[j].sat;
+        navv = view && j > 0 ? navview(view, eidx, obsrb[0].time, sats, j)
+                             : navp;
+
+        if (!rtkpos(&rtk, obsrb, nobsr+nobsb, navv)) {
             mexPrintf("rtkpos: no solution %s", rtk.errbuf);
         }
         /* copy to output */
-        memcpy(&ssats[i*MAXSAT], rtk.ssat, sizeof(rtk.ssat));
-        rtkcopy(&rtks[i], &rtk); 
+        if (!addssat(&ssatbuf, time, rtk.ssat)) {
+            mexErrMsgTxt("rtkpos: memory allocation error");
+        }
+        if (isrtkout(outmode, i, nr) &&
+            !rtkcopy(&rtks[nrtk++], &rtk, i < nr - 1 ? nxout : rtk.nx,
+                     i < nr - 1 ? naout : rtk.na)) {
+            mexErrMsgTxt("rtkpos: memory allocation error");
+        }
         addsol(&solbuf, &rtk.sol);
     }
+    perfalloc(&perf, sizeof(sol_t) * (double)solbuf.nmax +
+                         sizeof(ssatc_t) * (double)ssatbuf.nsmax);
+    perflap(&perf, PERF_COMP);
 
     /* output */
-    argout[0] = rtk2mxrtk(rtks, nr);
+    /* input rtk struct is returned if there is no epoch */
+    rtkp = nrtk > 0 ? rtks : &rtk;
+    if (mxisrtkc(argin[0])) {
+        argout[0] = rtk2mxrtkc(rtkp, nrtk > 0 ? nrtk : 1);
+    } else {
+        argout[0] = rtk2mxrtk(rtkp, nrtk > 0 ? nrtk : 1);
+    }
     argout[1] = sol2mxsol(solbuf.data, solbuf.n);
-    argout[2] = ssat2mxssat(ssats, times, nr);
+    argout[2] = ssatbuf2mxssat(&ssatbuf);
 
     /* free memory */
     free(obsr); free(nobsrlist);
-    if (nargin == 5) {
+    if (base) {
         free(obsb); free(nobsblist);
     }
     rtkfree(&rtk);
-    free(rtks);
-    free(ssats); free(times);
+    freertkcopy(rtks, nrtk);
+    freessatbuf(&ssatbuf);
     freesolbuf(&solbuf);
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
+    freenavview(view);
+    freeephidxp(eidx, argin[2]);
+    freenavp(navp, &nav);
     
     /* trace file */
     if (sopt.trace > 0) traceclose();
+    perfend(&perf);
 }
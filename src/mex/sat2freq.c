@@ -13,7 +13,7 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
+    nav_t nav = {0}, *navp;
     int i, m, n;
     double *sat, *frq, *code;
 
@@ -26,7 +26,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     m = (int)mxGetM(argin[0]);
     n = (int)mxGetN(argin[0]);
     code = (double *)mxGetPr(argin[1]);
-    nav = mxnav2nav(argin[2]);
+    navp = mxnav2navp(argin[2], &nav);
 
     /* output */
     argout[0] = mxCreateDoubleMatrix(m, n, mxREAL);
@@ -34,11 +34,8 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
 
     /* call RTKLIB function */
     for (i = 0; i < m * n; i++) {
-        frq[i] = sat2freq((int)sat[i], (uint8_t)code[i], &nav);
+        frq[i] = sat2freq((int)sat[i], (uint8_t)code[i], navp);
     }
 
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
+    freenavp(navp, &nav);
 }
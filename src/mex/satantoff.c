@@ -13,7 +13,7 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
+    nav_t nav = {0}, *navp;
     gtime_t time;
     int i, j, m, nsat;
     double ep[6], rs[3], *eps, *sats, *rsxs, *rsys, *rszs;
@@ -36,7 +36,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     rszs = (double *)mxGetPr(argin[3]);
     sats = (double *)mxGetPr(argin[4]);
     nsat = (int)mxGetN(argin[4]);
-    nav = mxnav2nav(argin[5]);
+    navp = mxnav2navp(argin[5], &nav);
 
     /* outputs */
     argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
@@ -68,14 +68,11 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
             rs[2] = rszs[i + m * j];
 
             /* compute satellite antenna phase center offset */
-            satantoff(time, rs, (int)sats[j], &nav, dant);
+            satantoff(time, rs, (int)sats[j], navp, dant);
             dx[i + m * j] = dant[0];
             dy[i + m * j] = dant[1];
             dz[i + m * j] = dant[2];
         }
     }
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
+    freenavp(navp, &nav);
 }
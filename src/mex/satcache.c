@@ -0,0 +1,261 @@
+/**
+ * @file satcache.c
+ * @brief LRU cache of satellite position/clock states
+ * @author Taro Suzuki
+ * @note Cache is kept in one table per MATLAB process, which is shared by all
+ * mex files through the registry (registry.c), and is enabled by "satcache on"
+ * @note Table is owned by the mex file enabling cache (satcache or core), and
+ * is freed when the mex file is cleared (or by "free" of core)
+ * @note States are keyed by wrapper, navigation data handle, ephemeris
+ * option, satellite and time, only navigation data handle is cached since
+ * handle is not changed after loading
+ * @note Table is accessed only outside of parallel loops
+ */
+
+#include "mex_utility.h"
+
+/* cache entry */
+typedef struct {
+    satkey_t key;   /* key */
+    satstate_t s;   /* satellite state */
+    int prev, next; /* LRU list (head: most recently used) */
+    int hnext;      /* next entry in hash chain */
+} satcent_t;
+
+/* cache table */
+struct satcache_tag {
+    const void *owner;            /* owner module of table */
+    int enable;                   /* cache enabled */
+    double budget;                /* memory budget (bytes) */
+    int n, nmax;                  /* number/max number of entries */
+    int nhash;                    /* size of hash table (power of 2) */
+    int head, tail;               /* LRU list */
+    satcent_t *ent;               /* entries */
+    int *hash;                    /* hash table (-1: empty) */
+    double stat[SATC_NFUNC][3];   /* hit/miss/bypass of wrappers */
+    double nevict;                /* number of evicted entries */
+};
+
+static const char *funcs[SATC_NFUNC] = {"satpos", "satposs", "peph2pos"};
+static const int satcowner = 0; /* owner of table created by mex file */
+
+/* table of cache (NULL: not created) ---------------------------------*/
+static satcache_t *satctbl(void) {
+    return (satcache_t *)regobj(REGOBJ_SATC);
+}
+/* hash of key --------------------------------------------------------*/
+static uint32_t hashkey(const satkey_t *key) {
+    uint64_t h = key->nav, v[4];
+    int i;
+
+    v[0] = ((uint64_t)key->func << 48) ^ ((uint64_t)(key->opt & 0xFFFF) << 32) ^
+           (uint64_t)key->sat;
+    v[1] = (uint64_t)key->time.time;
+    memcpy(v + 2, &key->time.sec, 8);
+    memcpy(v + 3, &key->tag, 8);
+    for (i = 0; i < 4; i++) { /* splitmix64 */
+        h ^= v[i] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+        h ^= h >> 31;
+    }
+    return (uint32_t)h;
+}
+/* compare keys -------------------------------------------------------*/
+static int samekey(const satkey_t *k1, const satkey_t *k2) {
+    return k1->nav == k2->nav && k1->func == k2->func && k1->opt == k2->opt &&
+           k1->sat == k2->sat && k1->time.time == k2->time.time &&
+           k1->time.sec == k2->time.sec && k1->tag == k2->tag;
+}
+/* unlink entry from LRU list -----------------------------------------*/
+static void unlinklru(satcache_t *c, const int i) {
+    if (c->ent[i].prev >= 0) c->ent[c->ent[i].prev].next = c->ent[i].next;
+    else c->head = c->ent[i].next;
+    if (c->ent[i].next >= 0) c->ent[c->ent[i].next].prev = c->ent[i].prev;
+    else c->tail = c->ent[i].prev;
+}
+/* link entry to head of LRU list -------------------------------------*/
+static void linklru(satcache_t *c, const int i) {
+    c->ent[i].prev = -1;
+    c->ent[i].next = c->head;
+    if (c->head >= 0) c->ent[c->head].prev = i;
+    c->head = i;
+    if (c->tail < 0) c->tail = i;
+}
+/* find entry (-1: not found) -----------------------------------------*/
+static int findent(const satcache_t *c, const satkey_t *key, int **link) {
+    int *p = c->hash + (hashkey(key) & (uint32_t)(c->nhash - 1));
+
+    for (; *p >= 0; p = &c->ent[*p].hnext) {
+        if (samekey(&c->ent[*p].key, key)) break;
+    }
+    if (link) *link = p;
+    return *p;
+}
+/* free entries -------------------------------------------------------*/
+static void freeents(satcache_t *c) {
+    free(c->ent);
+    free(c->hash);
+    c->ent = NULL;
+    c->hash = NULL;
+    c->n = c->nmax = c->nhash = 0;
+    c->head = c->tail = -1;
+}
+/* allocate entries in memory budget ----------------------------------*/
+static int allocents(satcache_t *c) {
+    int i;
+
+    c->nmax = (int)(c->budget / (sizeof(satcent_t) + 2 * sizeof(int)));
+    if (c->nmax < 1) c->nmax = 1;
+    for (c->nhash = 16; c->nhash < 2 * c->nmax; c->nhash *= 2);
+    if (!(c->ent = (satcent_t *)malloc(sizeof(satcent_t) * c->nmax)) ||
+        !(c->hash = (int *)malloc(sizeof(int) * c->nhash))) {
+        freeents(c);
+        return 0;
+    }
+    for (i = 0; i < c->nhash; i++) c->hash[i] = -1;
+    c->n = 0;
+    c->head = c->tail = -1;
+    return 1;
+}
+
+/* open cache for wrapper call (NULL: cache disabled) -----------------*/
+/* nav: id of navigation data handle (0: nav struct, not cached)        */
+extern satcache_t *satcacheopen(const int func, const uint64_t nav) {
+    satcache_t *c = satctbl();
+
+    if (!c || !c->enable || func < 0 || func >= SATC_NFUNC) return NULL;
+    if (!nav) {
+        c->stat[func][2] += 1.0;
+        return NULL;
+    }
+    return c;
+}
+/* get satellite state from cache (0: miss) ---------------------------*/
+extern int satcacheget(satcache_t *c, const satkey_t *key, satstate_t *s) {
+    int i;
+
+    if ((i = findent(c, key, NULL)) < 0) {
+        c->stat[key->func][1] += 1.0;
+        return 0;
+    }
+    c->stat[key->func][0] += 1.0;
+    if (c->head != i) {
+        unlinklru(c, i);
+        linklru(c, i);
+    }
+    *s = c->ent[i].s;
+    return 1;
+}
+/* put satellite state to cache (least recently used entry is evicted) -*/
+extern void satcacheput(satcache_t *c, const satkey_t *key,
+                        const satstate_t *s) {
+    int i, *p;
+
+    if ((i = findent(c, key, &p)) >= 0) {
+        c->ent[i].s = *s;
+        return;
+    }
+    if (c->n < c->nmax) {
+        i = c->n++;
+    } else { /* evict least recently used entry */
+        i = c->tail;
+        unlinklru(c, i);
+        findent(c, &c->ent[i].key, &p);
+        *p = c->ent[i].hnext;
+        c->nevict += 1.0;
+        findent(c, key, &p);
+    }
+    c->ent[i].key = *key;
+    c->ent[i].s = *s;
+    c->ent[i].hnext = -1;
+    *p = i;
+    linklru(c, i);
+}
+/* enable cache with memory budget (bytes) ----------------------------*/
+extern int satcacheon(const double budget) {
+    satcache_t *c = satctbl();
+
+    if (!c) {
+        if (!(c = (satcache_t *)calloc(1, sizeof(satcache_t)))) return 0;
+        c->owner = &satcowner;
+        c->head = c->tail = -1;
+        regsetobj(REGOBJ_SATC, c);
+    }
+    if (!c->ent || c->budget != budget) {
+        freeents(c);
+        c->budget = budget;
+        if (!allocents(c)) {
+            c->enable = 0;
+            return 0;
+        }
+    }
+    c->enable = 1;
+    return 1;
+}
+/* disable cache and free entries -------------------------------------*/
+extern void satcacheoff(void) {
+    satcache_t *c = satctbl();
+
+    if (!c) return;
+    freeents(c);
+    c->enable = 0;
+}
+/* free table if it is owned by mex file (at exit of mex file) --------*/
+extern void satcachefree(void) {
+    satcache_t *c = satctbl();
+
+    if (!c || c->owner != &satcowner) return;
+    freeents(c);
+    free(c);
+    regsetobj(REGOBJ_SATC, NULL);
+}
+/* clear entries and statistics ---------------------------------------*/
+extern void satcacheclear(void) {
+    satcache_t *c = satctbl();
+    int i;
+
+    if (!c) return;
+    for (i = 0; i < c->nhash; i++) c->hash[i] = -1;
+    c->n = 0;
+    c->head = c->tail = -1;
+    memset(c->stat, 0, sizeof(c->stat));
+    c->nevict = 0.0;
+}
+/* statistics to mx struct --------------------------------------------*/
+extern mxArray *satcache2mx(void) {
+    const char *f[] = {"enable", "budget", "n",       "nmax",  "bytes",
+                       "nhit",   "nmiss",  "nbypass", "nevict", "hitrate"};
+    const char *fs[] = {"nhit", "nmiss", "nbypass"};
+    satcache_t *c = satctbl();
+    mxArray *mx, *mxs;
+    double s[3] = {0};
+    int i, j;
+
+    mx = mxCreateStructMatrix(1, 1, 10, f);
+    for (i = 0; i < SATC_NFUNC; i++) {
+        mxs = mxCreateStructMatrix(1, 1, 3, fs);
+        for (j = 0; j < 3; j++) {
+            mxSetField(mxs, 0, fs[j], mxCreateDoubleScalar(c ? c->stat[i][j] : 0));
+            s[j] += c ? c->stat[i][j] : 0.0;
+        }
+        mxAddField(mx, funcs[i]);
+        mxSetField(mx, 0, funcs[i], mxs);
+    }
+    mxSetField(mx, 0, "enable", mxCreateDoubleScalar(c ? c->enable : 0));
+    mxSetField(mx, 0, "budget", mxCreateDoubleScalar(c ? c->budget : 0));
+    mxSetField(mx, 0, "n", mxCreateDoubleScalar(c ? c->n : 0));
+    mxSetField(mx, 0, "nmax", mxCreateDoubleScalar(c ? c->nmax : 0));
+    mxSetField(mx, 0, "bytes",
+               mxCreateDoubleScalar(c ? (double)c->nmax * sizeof(satcent_t) +
+                                            (double)c->nhash * sizeof(int)
+                                      : 0));
+    mxSetField(mx, 0, "nhit", mxCreateDoubleScalar(s[0]));
+    mxSetField(mx, 0, "nmiss", mxCreateDoubleScalar(s[1]));
+    mxSetField(mx, 0, "nbypass", mxCreateDoubleScalar(s[2]));
+    mxSetField(mx, 0, "nevict", mxCreateDoubleScalar(c ? c->nevict : 0));
+    mxSetField(mx, 0, "hitrate",
+               mxCreateDoubleScalar(s[0] + s[1] > 0 ? s[0] / (s[0] + s[1])
+                                                    : mxGetNaN()));
+    return mx;
+}
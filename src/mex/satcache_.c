@@ -0,0 +1,54 @@
+/**
+ * @file satcache_.c
+ * @brief Control satellite state cache and output statistics
+ * @author Taro Suzuki
+ * @note New development function
+ * @note Cache is shared by all mex files (see satcache.c), cache enabled by
+ * this mex file is freed when it is cleared
+ * @note Due to a conflict, file name was changed from satcache.c to
+ * satcache_.c
+ */
+
+#include "mex_utility.h"
+
+#define NIN 0
+#define BUDGET_DEFAULT 64.0 /* default memory budget (MB) */
+
+/* mex interface */
+extern void mexFunction(int nargout, mxArray *argout[], int nargin,
+                        const mxArray *argin[]) {
+    char cmd[16] = "stats";
+    double budget = BUDGET_DEFAULT;
+
+    /* check arguments */
+    mxCheckNumberOfArguments(nargin, NIN);
+    if (nargin > 0) {
+        mxCheckChar(argin[0]); /* command */
+        mxGetString(argin[0], cmd, sizeof(cmd));
+    }
+    if (nargin > 1) {
+        mxCheckScalar(argin[1]); /* memory budget (MB) */
+        budget = mxGetScalar(argin[1]);
+        if (!(budget > 0.0)) {
+            mexErrMsgTxt("satcache: memory budget must be positive");
+        }
+    }
+
+    /* output (statistics before command) */
+    if (nargout > 0 || nargin == 0) argout[0] = satcache2mx();
+
+    if (!strcmp(cmd, "on")) {
+        if (!satcacheon(budget * 1024.0 * 1024.0)) {
+            mexErrMsgTxt("satcache: memory allocation error");
+        }
+        /* free cache when mex file is cleared (core frees it by "free") */
+        if (!mexIsLocked()) mexAtExit(satcachefree);
+    } else if (!strcmp(cmd, "off")) {
+        satcacheoff();
+    } else if (!strcmp(cmd, "clear")) {
+        satcacheclear();
+    } else if (strcmp(cmd, "stats")) {
+        mexErrMsgTxt("satcache: command must be \"on\", \"off\", \"clear\" "
+                     "or \"stats\"");
+    }
+}
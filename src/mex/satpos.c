@@ -4,6 +4,11 @@
  * @author Taro Suzuki
  * @note Wrapper for "satpos" in ephemeris.c
  * @note Support vector inputs
+ * @note Epoch loop is parallelized by OpenMP except for precise and SSR
+ * ephemeris (satellite antenna offset is not thread-safe)
+ * @note Ephemeris is selected from ephemerides near epoch by per-satellite
+ * index (ephidx.c)
+ * @note States in satellite state cache are not computed (satcache.c)
  */
 
 #include "mex_utility.h"
@@ -13,11 +18,17 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
+    nav_t nav = {0}, *navp;
+    ephidx_t *eidx;
+    satcache_t *cache;
+    satkey_t key = {0};
+    satstate_t st = {0};
     gtime_t t;
     char satstr[32], errmsg[512];
-    int i, j, m, nsat, svh, ephopt;
-    double ep[6], *eps, *sats, rs[6], dts[2], var;
+    int i, j, k, m, nsat, ephopt, nthread;
+    uint8_t *nodata, *hit = NULL;
+    perf_t perf;
+    double ep[6], *eps, *sats;
     double *x, *y, *z, *vx, *vy, *vz, *dtss, *ddtss, *vars, *svhs;
 
     /* check arguments */
@@ -25,14 +36,19 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     mxCheckSizeOfColumns(argin[0], 6); /* epochs*/
     mxCheckSizeOfRows(argin[1], 1);    /* sats */
     mxCheckScalar(argin[3]);           /* ephopt */
+    perfstart(&perf, "satpos");
 
     /* inputs */
     eps = (double *)mxGetPr(argin[0]);
     m = (int)mxGetM(argin[0]);
     sats = (double *)mxGetPr(argin[1]);
     nsat = (int)mxGetN(argin[1]);
-    nav = mxnav2nav(argin[2]);
+    navp = mxnav2navp(argin[2], &nav);
     ephopt = (int)mxGetScalar(argin[3]);
+    nthread = ephNumThreads(ephopt, mxGetNumThreads(nargin, argin, 4));
+    eidx = mxnav2ephidx(argin[2], navp);
+    perfalloc(&perf, perfnav(navp, &nav) + (double)m * nsat);
+    perflap(&perf, PERF_IN);
 
     /* outputs */
     argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
@@ -66,39 +82,127 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     svhs = mxGetPr(argout[9]);
     mxSetNaN(svhs, m * nsat);
 
+    /* satellites without ephemeris (warned after parallel loop) */
+    if (!(nodata = (uint8_t *)calloc((size_t)m * nsat + 1, 1))) {
+        freeephidxp(eidx, argin[2]);
+        freenavp(navp, &nav);
+        mexErrMsgTxt("satpos: memory allocation error");
+    }
+    perflap(&perf, PERF_OUT);
+
+    /* satellite states in cache */
+    key.nav = mxnavhid(argin[2]);
+    key.func = SATC_SATPOS;
+    key.opt = ephopt;
+    if ((cache = satcacheopen(SATC_SATPOS, key.nav)) &&
+        (hit = (uint8_t *)calloc((size_t)m * nsat + 1, 1))) {
+        for (i = 0; i < m; i++) {
+            for (k = 0; k < 6; k++) ep[k] = eps[i + m * k];
+            key.time = epoch2time(ep);
+            for (j = 0; j < nsat; j++) {
+                key.sat = (int)sats[j];
+                if (!(hit[i + m * j] = satcacheget(cache, &key, &st))) continue;
+                if (!st.stat) {
+                    nodata[i + m * j] = 1;
+                    continue;
+                }
+                x[i + m * j] = st.rs[0];
+                y[i + m * j] = st.rs[1];
+                z[i + m * j] = st.rs[2];
+                vx[i + m * j] = st.rs[3];
+                vy[i + m * j] = st.rs[4];
+                vz[i + m * j] = st.rs[5];
+                dtss[i + m * j] = st.dts[0];
+                ddtss[i + m * j] = st.dts[1];
+                vars[i + m * j] = st.var;
+                svhs[i + m * j] = (double)st.svh;
+            }
+        }
+    }
+
     /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        ep[0] = eps[i + m * 0];
-        ep[1] = eps[i + m * 1];
-        ep[2] = eps[i + m * 2];
-        ep[3] = eps[i + m * 3];
-        ep[4] = eps[i + m * 4];
-        ep[5] = eps[i + m * 5];
-        t = epoch2time(ep);
+#pragma omp parallel num_threads(nthread) private(i, j)
+    {
+        navview_t *view = newnavview(navp);
 
-        for (j = 0; j < nsat; j++) {
-            /* satellite clock bias by broadcast ephemeris */
-            if (!satpos(t, t, (int)sats[j], ephopt, &nav, rs, dts, &var, &svh)) {
-                satno2id((int)sats[j], satstr);
-                sprintf(errmsg, "no ephemeris %s sat=%s", time_str(t, 3), satstr);
-                mexWarnMsgTxt(errmsg);
-                continue;
+#pragma omp for schedule(static)
+        for (i = 0; i < m; i++) {
+            const nav_t *navv;
+            gtime_t ti;
+            double epi[6], rs[6], dts[2], var;
+            int sat, svh;
+
+            epi[0] = eps[i + m * 0];
+            epi[1] = eps[i + m * 1];
+            epi[2] = eps[i + m * 2];
+            epi[3] = eps[i + m * 3];
+            epi[4] = eps[i + m * 4];
+            epi[5] = eps[i + m * 5];
+            ti = epoch2time(epi);
+
+            for (j = 0; j < nsat; j++) {
+                if (hit && hit[i + m * j]) continue;
+
+                /* ephemerides of satellite near epoch */
+                sat = (int)sats[j];
+                navv = view ? navview(view, eidx, ti, &sat, 1) : navp;
+
+                /* satellite clock bias by broadcast ephemeris */
+                if (!satpos(ti, ti, sat, ephopt, navv, rs, dts, &var, &svh)) {
+                    nodata[i + m * j] = 1;
+                    continue;
+                }
+                x[i + m * j] = rs[0];
+                y[i + m * j] = rs[1];
+                z[i + m * j] = rs[2];
+                vx[i + m * j] = rs[3];
+                vy[i + m * j] = rs[4];
+                vz[i + m * j] = rs[5];
+                dtss[i + m * j] = dts[0] * CLIGHT;
+                ddtss[i + m * j] = dts[1] * CLIGHT;
+                vars[i + m * j] = var;
+                svhs[i + m * j] = (double)svh;
             }
-            x[i + m * j] = rs[0];
-            y[i + m * j] = rs[1];
-            z[i + m * j] = rs[2];
-            vx[i + m * j] = rs[3];
-            vy[i + m * j] = rs[4];
-            vz[i + m * j] = rs[5];
-            dtss[i + m * j] = dts[0] * CLIGHT;
-            ddtss[i + m * j] = dts[1] * CLIGHT;
-            vars[i + m * j] = var;
-            svhs[i + m * j] = (double)svh;
+        }
+        freenavview(view);
+    }
+    /* computed satellite states to cache */
+    for (i = 0; hit && i < m; i++) {
+        for (k = 0; k < 6; k++) ep[k] = eps[i + m * k];
+        key.time = epoch2time(ep);
+        for (j = 0; j < nsat; j++) {
+            if (hit[i + m * j]) continue;
+            key.sat = (int)sats[j];
+            st.stat = !nodata[i + m * j];
+            st.rs[0] = x[i + m * j];
+            st.rs[1] = y[i + m * j];
+            st.rs[2] = z[i + m * j];
+            st.rs[3] = vx[i + m * j];
+            st.rs[4] = vy[i + m * j];
+            st.rs[5] = vz[i + m * j];
+            st.dts[0] = dtss[i + m * j];
+            st.dts[1] = ddtss[i + m * j];
+            st.var = vars[i + m * j];
+            st.svh = st.stat ? (int)svhs[i + m * j] : 0;
+            satcacheput(cache, &key, &st);
+        }
+    }
+    perflap(&perf, PERF_COMP);
+
+    /* warnings in order of serial loop */
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < nsat; j++) {
+            if (!nodata[i + m * j]) continue;
+            for (k = 0; k < 6; k++) ep[k] = eps[i + m * k];
+            t = epoch2time(ep);
+            satno2id((int)sats[j], satstr);
+            sprintf(errmsg, "no ephemeris %s sat=%s", time_str(t, 3), satstr);
+            mexWarnMsgTxt(errmsg);
         }
     }
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
-    if (nav.erp.n > 0) free(nav.erp.data);
+    free(nodata);
+    free(hit);
+    freeephidxp(eidx, argin[2]);
+    freenavp(navp, &nav);
+    perfend(&perf);
 }
@@ -4,29 +4,56 @@
  * @author Taro Suzuki
  * @note Wrapper for "satposs" in ephemeris.c
  * @note Support vector inputs
+ * @note Epoch loop is parallelized by OpenMP except for precise and SSR
+ * ephemeris (satellite antenna offset is not thread-safe)
+ * @note Ephemerides are selected from ephemerides near epoch by per-satellite
+ * index (ephidx.c)
+ * @note States in satellite state cache are not computed (satcache.c), key
+ * of state is signal reception time and pseudorange (signal transmission
+ * time)
  */
 
 #include "mex_utility.h"
 
 #define NIN 3
 
+/* pseudorange to compute signal transmission time (same as satposs) --*/
+static double obspr(const obsd_t *obs) {
+    int i;
+
+    for (i = 0; i < NFREQ; i++) {
+        if (obs->P[i] != 0.0) return obs->P[i];
+    }
+    return 0.0;
+}
+
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
-    obsd_t *obs, *obss;
-    int i, j, m, nsat, svh[MAXSAT], ephopt, sats[MAXSAT];
-    double rs[6 * MAXSAT], dts[2 * MAXSAT], var[MAXSAT];
+    nav_t nav = {0}, *navp;
+    ephidx_t *eidx;
+    satcache_t *cache;
+    satkey_t key = {0};
+    satstate_t st = {0};
+    obsd_t *obss;
+    int i, j, m, nsat, ephopt, sats[MAXSAT], nthread;
+    uint8_t *hit = NULL;
+    perf_t perf;
     double *x, *y, *z, *vx, *vy, *vz, *dtss, *ddtss, *vars, *svhs;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
     mxCheckScalar(argin[2]); /* ephopt */
+    perfstart(&perf, "satposs");
 
     /* inputs */
     obss = mxobs2obs_all(argin[0], 1, &m, &nsat, sats);
-    nav = mxnav2nav(argin[1]);
+    navp = mxnav2navp(argin[1], &nav);
     ephopt = (int)mxGetScalar(argin[2]);
+    nthread = ephNumThreads(ephopt, mxGetNumThreads(nargin, argin, 3));
+    eidx = mxnav2ephidx(argin[1], navp);
+    perfalloc(&perf, sizeof(obsd_t) * (double)m * nsat + perfnav(navp, &nav));
+    perflap(&perf, PERF_IN);
 
     /* outputs */
     argout[0] = mxCreateDoubleMatrix(m, nsat, mxREAL);
@@ -59,31 +86,109 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     argout[9] = mxCreateDoubleMatrix(m, nsat, mxREAL);
     svhs = mxGetPr(argout[9]);
     mxSetNaN(svhs, m * nsat);
+    perflap(&perf, PERF_OUT);
+
+    /* satellite states in cache (no pseudorange: no state) */
+    key.nav = mxnavhid(argin[1]);
+    key.func = SATC_SATPOSS;
+    key.opt = ephopt;
+    if ((cache = satcacheopen(SATC_SATPOSS, key.nav)) &&
+        (hit = (uint8_t *)calloc((size_t)m * nsat + 1, 1))) {
+        for (i = 0; i < m; i++) {
+            for (j = 0; j < nsat; j++) {
+                key.sat = sats[j];
+                key.time = obss[nsat * i].time;
+                if ((key.tag = obspr(&obss[j + nsat * i])) == 0.0) {
+                    hit[i + m * j] = 1;
+                    continue;
+                }
+                if (!(hit[i + m * j] = satcacheget(cache, &key, &st))) continue;
+                if (!st.stat) continue;
+                x[i + m * j] = st.rs[0];
+                y[i + m * j] = st.rs[1];
+                z[i + m * j] = st.rs[2];
+                vx[i + m * j] = st.rs[3];
+                vy[i + m * j] = st.rs[4];
+                vz[i + m * j] = st.rs[5];
+                dtss[i + m * j] = st.dts[0];
+                ddtss[i + m * j] = st.dts[1];
+                vars[i + m * j] = st.var;
+                svhs[i + m * j] = (double)st.svh;
+            }
+        }
+    }
 
     /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        obs = &obss[nsat * i];
-        satposs(obs->time, obs, nsat, &nav, ephopt, rs, dts, var, svh);
+#pragma omp parallel num_threads(nthread) private(i, j)
+    {
+        navview_t *view = newnavview(navp);
 
-        for (j = 0; j < nsat; j++) {
-            if (norm(&rs[j * 6], 3) > 0.0) {
-                x[i + m * j] = rs[0 + j * 6];
-                y[i + m * j] = rs[1 + j * 6];
-                z[i + m * j] = rs[2 + j * 6];
-                vx[i + m * j] = rs[3 + j * 6];
-                vy[i + m * j] = rs[4 + j * 6];
-                vz[i + m * j] = rs[5 + j * 6];
-                dtss[i + m * j] = dts[0 + j * 2] * CLIGHT;
-                ddtss[i + m * j] = dts[1 + j * 2] * CLIGHT;
-                vars[i + m * j] = var[j];
-                svhs[i + m * j] = (double)svh[j];
+#pragma omp for schedule(static)
+        for (i = 0; i < m; i++) {
+            const obsd_t *obs = &obss[nsat * i];
+            const nav_t *navv;
+            obsd_t obsj[MAXSAT];
+            double rs[6 * MAXSAT], dts[2 * MAXSAT], var[MAXSAT];
+            int k, n = 0, svh[MAXSAT], satj[MAXSAT], jj[MAXSAT];
+
+            /* satellites not in cache */
+            for (j = 0; j < nsat; j++) {
+                if (hit && hit[i + m * j]) continue;
+                obsj[n] = obs[j];
+                satj[n] = sats[j];
+                jj[n++] = j;
+            }
+            if (n <= 0) continue;
+
+            /* ephemerides of satellites near epoch */
+            navv = view ? navview(view, eidx, obs->time, satj, n) : navp;
+
+            satposs(obs->time, obsj, n, navv, ephopt, rs, dts, var, svh);
+
+            for (k = 0; k < n; k++) {
+                j = jj[k];
+                if (norm(&rs[k * 6], 3) > 0.0) {
+                    x[i + m * j] = rs[0 + k * 6];
+                    y[i + m * j] = rs[1 + k * 6];
+                    z[i + m * j] = rs[2 + k * 6];
+                    vx[i + m * j] = rs[3 + k * 6];
+                    vy[i + m * j] = rs[4 + k * 6];
+                    vz[i + m * j] = rs[5 + k * 6];
+                    dtss[i + m * j] = dts[0 + k * 2] * CLIGHT;
+                    ddtss[i + m * j] = dts[1 + k * 2] * CLIGHT;
+                    vars[i + m * j] = var[k];
+                    svhs[i + m * j] = (double)svh[k];
+                }
             }
         }
+        freenavview(view);
     }
+    /* computed satellite states to cache */
+    for (i = 0; hit && i < m; i++) {
+        for (j = 0; j < nsat; j++) {
+            if (hit[i + m * j]) continue;
+            key.sat = sats[j];
+            key.time = obss[nsat * i].time;
+            key.tag = obspr(&obss[j + nsat * i]);
+            st.stat = !mxIsNaN(x[i + m * j]);
+            st.rs[0] = x[i + m * j];
+            st.rs[1] = y[i + m * j];
+            st.rs[2] = z[i + m * j];
+            st.rs[3] = vx[i + m * j];
+            st.rs[4] = vy[i + m * j];
+            st.rs[5] = vz[i + m * j];
+            st.dts[0] = dtss[i + m * j];
+            st.dts[1] = ddtss[i + m * j];
+            st.var = vars[i + m * j];
+            st.svh = st.stat ? (int)svhs[i + m * j] : 0;
+            satcacheput(cache, &key, &st);
+        }
+    }
+    perflap(&perf, PERF_COMP);
+
     free(obss);
-    if (nav.n > 0) free(nav.eph);
-    if (nav.ng > 0) free(nav.geph);
-    if (nav.ne > 0) free(nav.peph);
-    if (nav.nc > 0) free(nav.pclk);
-    if (nav.erp.n > 0) free(nav.erp.data);
+    free(hit);
+    freeephidxp(eidx, argin[1]);
+    freenavp(navp, &nav);
+    perfend(&perf);
 }
@@ -3,6 +3,9 @@
  * @brief Search antenna parameter
  * @author Taro Suzuki
  * @note Wrapper for "searchpcv" in rtkcmn.c
+ * @note Support antenna parameter file path as input, the file is indexed
+ * once and kept between calls (pcvidx.c)
+ * @note Support vector inputs of satellite number
  */
 
 #include "mex_utility.h"
@@ -12,39 +15,63 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    pcv_t *pcvs_pcv, pcv0 = {0}, *pcv;
+    const pcvidx_t *idx = NULL;
+    const pcv_t *pcv;
+    pcv_t *pcvs_pcv = NULL, pcv0 = {0}, *out;
     pcvs_t pcvs = {0};
     gtime_t time;
-    int sat, n;
-    char type[MAXANT];
+    int i, n = 0, nsat;
+    double *sats;
+    char type[MAXANT], file[512], errmsg[600];
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
-    mxCheckScalar(argin[0]);               /* sat */
     mxCheckChar(argin[1]);                 /* antenna type */
     mxCheckSizeOfArgument(argin[2], 1, 6); /* epoch */
 
-    /* pcvs */
-    n = mxGetSize(argin[3]);
-    if (!(pcvs_pcv = (pcv_t *)malloc(n * sizeof(pcv_t)))) {
-        mexErrMsgTxt("searchpcv: memory allocation error");
-    }
-
     /* input */
-    sat = (int)mxGetScalar(argin[0]);
+    sats = (double *)mxGetPr(argin[0]);
+    nsat = (int)mxGetNumberOfElements(argin[0]);
     mxGetString(argin[1], type, sizeof(type));
     time = epoch2time(mxGetPr(argin[2]));
-    mxpcv2pcv(argin[3], n, pcvs_pcv);
-    
-    /* set pcvs_t */
-    pcvs.n = pcvs.nmax = n;
-    pcvs.pcv = pcvs_pcv;
+
+    /* pcvs (file path or pcvs struct) */
+    if (mxIsChar(argin[3])) {
+        mxGetString(argin[3], file, sizeof(file));
+        if (!(idx = pcvindex(file))) {
+            sprintf(errmsg, "searchpcv: Invalid PCV file: %s", file);
+            mexErrMsgTxt(errmsg);
+        }
+        if (!mexIsLocked()) mexAtExit(freepcvindex);
+    } else {
+        n = mxGetSize(argin[3]);
+        if (!(pcvs_pcv = (pcv_t *)malloc(n * sizeof(pcv_t)))) {
+            mexErrMsgTxt("searchpcv: memory allocation error");
+        }
+        mxpcv2pcv(argin[3], n, pcvs_pcv);
+
+        /* set pcvs_t */
+        pcvs.n = pcvs.nmax = n;
+        pcvs.pcv = pcvs_pcv;
+    }
+    if (!(out = (pcv_t *)malloc((nsat > 0 ? nsat : 1) * sizeof(pcv_t)))) {
+        free(pcvs_pcv);
+        mexErrMsgTxt("searchpcv: memory allocation error");
+    }
 
     /* call RTKLIB function */
-    pcv = searchpcv(sat, type, time, &pcvs);
+    for (i = 0; i < nsat; i++) {
+        if (idx) {
+            pcv = searchpcvidx(idx, (int)sats[i], type, time);
+        } else {
+            pcv = searchpcv((int)sats[i], type, time, &pcvs);
+        }
+        out[i] = pcv ? *pcv : pcv0;
+    }
 
     /* output */
-    argout[0] = pcv2mxpcv(pcv ? pcv : &pcv0, 1);
+    argout[0] = pcv2mxpcv(out, nsat);
 
+    free(out);
     free(pcvs_pcv);
 }
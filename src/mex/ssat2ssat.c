@@ -1,19 +1,154 @@
 /**
  * @file ssat2ssat.c
- * @brief Convert mxArray ssat_t to mxssat
+ * @brief Convert compact satellite status buffer to mxssat
  * @author Taro Suzuki
+ * @note Only satellites with non-zero status are stored in the buffer, the
+ * other satellites are output as zero (az,el) or NaN (frequency fields)
  */
 
 #include "mex_utility.h"
 
-/* ssat2mxssat ----------------------------------------------------------*/
-extern mxArray *ssat2mxssat(const ssat_t *ssat, const gtime_t *time, const int n) {
-    mxArray *mxssat, *mxL;
-    int i, j, k, isat, ifrq, idx1, idx2, frqs[MAXFREQ]={0},nsat = 0,nfrq = 0;
-    double *resp, *resc, *vsat, *snr, *fix, *slip, *half, *lock, *outc, *slipc,
-        *rejc, *eps, *azs, *els, ep[6], nan, sats[MAXSAT] = {0};
-    mxArray *mxaz, *mxel, *mxsat, *mxep, *mxresp, *mxresc, *mxvsat, *mxsnr, *mxfix, *mxslip, *mxhalf,
-        *mxlock, *mxoutc, *mxslipc, *mxrejc;
+#define NSTATF 11 /* number of fields of frequency struct */
+
+/* satellite status is non-zero or not --------------------------------*/
+static int isssat(const ssat_t *ssat) {
+    int k;
+
+    if (ssat->vs || ssat->azel[0] != 0.0 || ssat->azel[1] != 0.0) return 1;
+    for (k = 0; k < NFREQ; k++) {
+        if (ssat->resp[k] != 0.0 || ssat->resc[k] != 0.0 || ssat->vsat[k] ||
+            ssat->snr[k] || ssat->fix[k] || ssat->slip[k] || ssat->half[k] ||
+            ssat->lock[k] || ssat->outc[k] || ssat->slipc[k] ||
+            ssat->rejc[k]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+/* add satellite status of one epoch to buffer ------------------------*/
+extern int addssat(ssatbuf_t *buf, gtime_t time, const ssat_t *ssat) {
+    ssatc_t *data;
+    gtime_t *times;
+    int i, k, *index, nmax;
+
+    /* epoch */
+    if (buf->n >= buf->nmax) {
+        nmax = buf->nmax <= 0 ? 1024 : buf->nmax * 2;
+        if (!(times = (gtime_t *)realloc(buf->time, sizeof(gtime_t) * nmax)) ||
+            !(index = (int *)realloc(buf->index, sizeof(int) * (nmax + 1)))) {
+            if (times) buf->time = times;
+            return 0;
+        }
+        buf->time = times;
+        buf->index = index;
+        buf->nmax = nmax;
+    }
+    if (buf->n == 0) buf->index[0] = 0;
+    buf->time[buf->n] = time;
+
+    /* satellites with non-zero status */
+    for (i = 0; i < MAXSAT; i++) {
+        if (!isssat(ssat + i)) continue;
+
+        if (buf->ns >= buf->nsmax) {
+            nmax = buf->nsmax <= 0 ? 16384 : buf->nsmax * 2;
+            if (!(data = (ssatc_t *)realloc(buf->data, sizeof(ssatc_t) * nmax))) {
+                return 0;
+            }
+            buf->data = data;
+            buf->nsmax = nmax;
+        }
+        data = buf->data + buf->ns++;
+        data->sat = (uint16_t)(i + 1);
+        data->vs = ssat[i].vs;
+        data->azel[0] = ssat[i].azel[0];
+        data->azel[1] = ssat[i].azel[1];
+        for (k = 0; k < NFREQ; k++) {
+            data->resp[k] = ssat[i].resp[k];
+            data->resc[k] = ssat[i].resc[k];
+            data->vsat[k] = ssat[i].vsat[k];
+            data->snr[k] = ssat[i].snr[k];
+            data->fix[k] = ssat[i].fix[k];
+            data->slip[k] = ssat[i].slip[k];
+            data->half[k] = ssat[i].half[k];
+            data->lock[k] = ssat[i].lock[k];
+            data->outc[k] = ssat[i].outc[k];
+            data->slipc[k] = ssat[i].slipc[k];
+            data->rejc[k] = ssat[i].rejc[k];
+        }
+    }
+    buf->index[++buf->n] = buf->ns;
+    return 1;
+}
+/* append satellite status buffer to buffer --------------------------*/
+extern int catssatbuf(ssatbuf_t *buf, const ssatbuf_t *src) {
+    ssatc_t *data;
+    gtime_t *times;
+    int i, *index, nmax, i0, ns;
+
+    if (src->n <= 0) return 1;
+    i0 = src->index[0];
+    ns = src->index[src->n] - i0;
+    if (buf->n + src->n > buf->nmax) {
+        nmax = buf->n + src->n;
+        if (!(times = (gtime_t *)realloc(buf->time, sizeof(gtime_t) * nmax)) ||
+            !(index = (int *)realloc(buf->index, sizeof(int) * (nmax + 1)))) {
+            if (times) buf->time = times;
+            return 0;
+        }
+        buf->time = times;
+        buf->index = index;
+        buf->nmax = nmax;
+    }
+    if (buf->ns + ns > buf->nsmax) {
+        nmax = buf->ns + ns;
+        if (!(data = (ssatc_t *)realloc(buf->data, sizeof(ssatc_t) * nmax))) {
+            return 0;
+        }
+        buf->data = data;
+        buf->nsmax = nmax;
+    }
+    if (buf->n == 0) buf->index[0] = 0;
+    for (i = 0; i < src->n; i++) {
+        buf->time[buf->n + i] = src->time[i];
+        buf->index[buf->n + i + 1] = buf->ns + src->index[i + 1] - i0;
+    }
+    if (ns > 0) memcpy(buf->data + buf->ns, src->data + i0, sizeof(ssatc_t) * ns);
+    buf->n += src->n;
+    buf->ns += ns;
+    return 1;
+}
+/* add i-th epoch of satellite status buffer to buffer ----------------*/
+extern int addssatbuf(ssatbuf_t *buf, const ssatbuf_t *src, const int i) {
+    ssatbuf_t epoch = *src;
+
+    if (i < 0 || i >= src->n) return 0;
+    epoch.n = 1;
+    epoch.time = src->time + i;
+    epoch.index = src->index + i;
+    return catssatbuf(buf, &epoch);
+}
+/* free satellite status buffer ---------------------------------------*/
+extern void freessatbuf(ssatbuf_t *buf) {
+    free(buf->time);
+    free(buf->index);
+    free(buf->data);
+    buf->time = NULL;
+    buf->index = NULL;
+    buf->data = NULL;
+    buf->n = buf->nmax = buf->ns = buf->nsmax = 0;
+}
+/* set status value (zero is NaN) -------------------------------------*/
+static void setstat(double **p, const int k, const int idx, const double val) {
+    p[k][idx] = val == 0.0 ? mxGetNaN() : val;
+}
+
+/* ssatbuf2mxssat -----------------------------------------------------*/
+extern mxArray *ssatbuf2mxssat(const ssatbuf_t *buf) {
+    mxArray *mxssat, *mxL, *mx;
+    const ssatc_t *s;
+    int i, j, k, m, n = buf->n, nsat = 0, idx, col[MAXSAT], frq[NFREQ] = {0};
+    double *eps, *azs, *els, *sats, ep[6], *stat[NFREQ][NSTATF] = {{0}};
 
     /* output struct */
     const char *freqstr[] = {"L1", "L2", "L5", "L6", "L7", "L8", "L9"};
@@ -21,163 +156,79 @@ extern mxArray *ssat2mxssat(const ssat_t *ssat, const gtime_t *time, const int n
                            "L2", "L5",   "L6",  "L7", "L8", "L9"};
     const char *freqf[] = {"resp", "resc", "vsat", "snr",   "fix", "slip",
                            "half", "lock", "outc", "slipc", "rejc"};
-    
-    /* count valid satellites */
-    for (i = 0; i < MAXSAT; i++) {
-        for (k = 0; k < n; k++) {
-            if (ssat[i + MAXSAT * k].vs) {
-                sats[nsat++] = i+1;
-                break;
-            }
-        }
-        /* count frequencies */
+
+    /* valid satellites and frequencies */
+    for (i = 0; i < MAXSAT; i++) col[i] = 0;
+    for (i = 0; i < buf->ns; i++) {
+        s = buf->data + i;
+        if (s->vs) col[s->sat - 1] = 1;
         for (k = 0; k < NFREQ; k++) {
-            if (ssat[i].resp[k] != 0.0 && frqs[k]==0) {
-                frqs[nfrq++] = k+1;
-            }
+            if (s->resp[k] != 0.0) frq[k] = 1;
         }
     }
-    //mexPrintf("ssat2mxssat: n=%d nsat=%d nfrq=%d\n",n, nsat,nfrq);
-
-    if (!(resp = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(resc = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(vsat = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(snr = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(fix = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(slip = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(half = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(lock = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(outc = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(slipc = (double *)malloc(nfrq * nsat * n * sizeof(double))) ||
-        !(rejc = (double *)malloc(nfrq * nsat * n * sizeof(double)))) {
-        mexErrMsgTxt("ssat2mxssat: memory allocation error");
+    for (i = 0; i < MAXSAT; i++) {
+        col[i] = col[i] ? nsat++ : -1; /* column index of satellite */
     }
-    mxSetNaN(resp, nfrq * n * nsat);
-    mxSetNaN(resc, nfrq * n * nsat);
-    mxSetNaN(vsat, nfrq * n * nsat);
-    mxSetNaN(snr, nfrq * n * nsat);
-    mxSetNaN(fix, nfrq * n * nsat);
-    mxSetNaN(slip, nfrq * n * nsat);
-    mxSetNaN(half, nfrq * n * nsat);
-    mxSetNaN(lock, nfrq * n * nsat);
-    mxSetNaN(outc, nfrq * n * nsat);
-    mxSetNaN(slipc, nfrq * n * nsat);
-    mxSetNaN(rejc, nfrq * n * nsat);
-
     mxssat = mxCreateStructMatrix(1, 1, 13, statf);
     mxSetField(mxssat, 0, "n", mxCreateDoubleScalar(n));
     mxSetField(mxssat, 0, "nsat", mxCreateDoubleScalar(nsat));
-    mxsat = mxCreateDoubleMatrix(1, nsat, mxREAL);
-    memcpy(mxGetPr(mxsat), sats, nsat * sizeof(double));
-    mxSetField(mxssat, 0, "sat", mxsat);
-
-    mxep = mxCreateDoubleMatrix(n, 6, mxREAL);
-    eps = mxGetPr(mxep);
-    mxaz = mxCreateDoubleMatrix(n, nsat, mxREAL);
-    azs = mxGetPr(mxaz);
-    mxSetNaN(azs, n * nsat);
-    mxel = mxCreateDoubleMatrix(n, nsat, mxREAL);
-    els = mxGetPr(mxel);
-    mxSetNaN(els, n * nsat);
-
-    nan = mxGetNaN();
-    for (i=0; i<n; i++) {
-        /* ep */
-        time2epoch(time[i], ep);
-        eps[i + n * 0] = ep[0];
-        eps[i + n * 1] = ep[1];
-        eps[i + n * 2] = ep[2];
-        eps[i + n * 3] = ep[3];
-        eps[i + n * 4] = ep[4];
-        eps[i + n * 5] = ep[5];
-        for (j = 0; j < nsat; j++) {
-            isat = (int)sats[j] - 1;
-            azs[i + n * j] = ssat[isat + i * MAXSAT].azel[0]*R2D;
-            els[i + n * j] = ssat[isat + i * MAXSAT].azel[1]*R2D;
-            for (k=0; k<nfrq; k++) {
-                ifrq = frqs[k] - 1;
-                idx1 = i + j*n + k* n * nsat;
-                idx2 = isat + i * MAXSAT;
-                resp[idx1] = (ssat[idx2].resp[ifrq]) == 0 ? nan : ssat[idx2].resp[ifrq];
-                resc[idx1] = (ssat[idx2].resc[ifrq]) == 0 ? nan : ssat[idx2].resc[ifrq];
-                vsat[idx1] = (ssat[idx2].vsat[ifrq]) == 0 ? nan : (double) ssat[idx2].vsat[ifrq];
-                slip[idx1] = (ssat[idx2].slip[ifrq]) == 0 ? nan : (double) ssat[idx2].slip[ifrq];
-                fix[idx1] = (ssat[idx2].fix[ifrq]) == 0 ? nan : (double) ssat[idx2].fix[ifrq];
-                snr[idx1] = (ssat[idx2].snr[ifrq]) == 0 ? nan : (double) ssat[idx2].snr[ifrq] * SNR_UNIT;
-                half[idx1] = (ssat[idx2].half[ifrq]) == 0 ? nan : (double) ssat[idx2].half[ifrq];
-                lock[idx1] = (ssat[idx2].lock[ifrq]) == 0 ? nan : (double) ssat[idx2].lock[ifrq];
-                outc[idx1] = (ssat[idx2].outc[ifrq]) == 0 ? nan : (double) ssat[idx2].outc[ifrq];
-                slipc[idx1] = (ssat[idx2].slipc[ifrq]) == 0 ? nan : (double) ssat[idx2].slipc[ifrq];
-                rejc[idx1] = (ssat[idx2].rejc[ifrq]) == 0 ? nan : (double) ssat[idx2].rejc[ifrq];
-            }
+    mx = mxCreateDoubleMatrix(1, nsat, mxREAL);
+    sats = mxGetPr(mx);
+    for (i = 0; i < MAXSAT; i++) {
+        if (col[i] >= 0) sats[col[i]] = i + 1;
+    }
+    mxSetField(mxssat, 0, "sat", mx);
+
+    mx = mxCreateDoubleMatrix(n, 6, mxREAL);
+    eps = mxGetPr(mx);
+    mxSetField(mxssat, 0, "ep", mx);
+    mx = mxCreateDoubleMatrix(n, nsat, mxREAL);
+    azs = mxGetPr(mx);
+    mxSetField(mxssat, 0, "az", mx);
+    mx = mxCreateDoubleMatrix(n, nsat, mxREAL);
+    els = mxGetPr(mx);
+    mxSetField(mxssat, 0, "el", mx);
+
+    /* frequency structs */
+    for (k = 0; k < NFREQ; k++) {
+        if (!frq[k]) continue;
+        mxL = mxCreateStructMatrix(1, 1, NSTATF, freqf);
+        for (m = 0; m < NSTATF; m++) {
+            mx = mxCreateUninitNumericMatrix(n, nsat, mxDOUBLE_CLASS, mxREAL);
+            stat[k][m] = mxGetPr(mx);
+            mxSetNaN(stat[k][m], n * nsat);
+            mxSetField(mxL, 0, freqf[m], mx);
         }
+        mxSetField(mxssat, 0, freqstr[k], mxL);
     }
-    
-    mxSetField(mxssat, 0, "ep", mxep);
-    mxSetField(mxssat, 0, "az", mxaz);
-    mxSetField(mxssat, 0, "el", mxel);
-
-    for (i = 0; i < nfrq; i++) {
-        ifrq = frqs[i] - 1;
-        mxL = mxCreateStructMatrix(1, 1, 11, freqf);
-
-        mxresp = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxresp), &resp[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "resp", mxresp);
-
-        mxresc = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxresc), &resc[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "resc", mxresc);
-        
-        mxvsat = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxvsat), &vsat[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "vsat", mxvsat);
-        
-        mxslip = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxslip), &slip[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "slip", mxslip);
-        
-        mxfix = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxfix), &fix[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "fix", mxfix);
-        
-        mxsnr = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxsnr), &snr[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "snr", mxsnr);
-        
-        mxhalf = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxhalf), &half[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "half", mxhalf);
-
-        mxlock = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxlock), &lock[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "lock", mxlock);
-        
-        mxoutc = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxoutc), &outc[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "outc", mxoutc);
-        
-        mxslipc = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxslipc), &slipc[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "slipc", mxslipc);
-        
-        mxrejc = mxCreateDoubleMatrix(n, nsat, mxREAL);
-        memcpy(mxGetPr(mxrejc), &rejc[ifrq * n * nsat], n * nsat * sizeof(double));
-        mxSetField(mxL, 0, "rejc", mxrejc);
-
-        mxSetField(mxssat, 0, freqstr[ifrq], mxL);
+
+    /* scatter status of stored satellites */
+    for (i = 0; i < n; i++) {
+        time2epoch(buf->time[i], ep);
+        for (k = 0; k < 6; k++) eps[i + n * k] = ep[k];
+
+        for (j = buf->index[i]; j < buf->index[i + 1]; j++) {
+            s = buf->data + j;
+            if (col[s->sat - 1] < 0) continue;
+            idx = i + n * col[s->sat - 1];
+            azs[idx] = s->azel[0] * R2D;
+            els[idx] = s->azel[1] * R2D;
+
+            for (k = 0; k < NFREQ; k++) {
+                if (!frq[k]) continue;
+                setstat(stat[k], 0, idx, s->resp[k]);
+                setstat(stat[k], 1, idx, s->resc[k]);
+                setstat(stat[k], 2, idx, (double)s->vsat[k]);
+                setstat(stat[k], 3, idx, (double)s->snr[k] * SNR_UNIT);
+                setstat(stat[k], 4, idx, (double)s->fix[k]);
+                setstat(stat[k], 5, idx, (double)s->slip[k]);
+                setstat(stat[k], 6, idx, (double)s->half[k]);
+                setstat(stat[k], 7, idx, (double)s->lock[k]);
+                setstat(stat[k], 8, idx, (double)s->outc[k]);
+                setstat(stat[k], 9, idx, (double)s->slipc[k]);
+                setstat(stat[k], 10, idx, (double)s->rejc[k]);
+            }
+        }
     }
-    
-    free(resp);
-    free(resc);
-    free(vsat);
-    free(snr);
-    free(fix);
-    free(slip);
-    free(half);
-    free(lock);
-    free(outc);
-    free(slipc);
-    free(rejc);
     return mxssat;
-}
\ No newline at end of file
+}
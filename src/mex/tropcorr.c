@@ -15,7 +15,7 @@
 /* mex interface */
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
-    nav_t nav = {0};
+    nav_t nav = {0}, *navp;
     gtime_t time;
     int i, j, m, nsat, nllhs, tropopt;
     double ep[6], llh[3], azel[2];
@@ -32,7 +32,7 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     /* inputs */
     eps = (double *)mxGetPr(argin[0]);
     m = (int)mxGetM(argin[0]);
-    nav = mxnav2nav(argin[1]);
+    navp = mxnav2navp(argin[1], &nav);
     llhs = (double *)mxGetPr(argin[2]);
     nllhs = (int)mxGetM(argin[2]);
     azs = (double *)mxGetPr(argin[3]);
@@ -71,8 +71,9 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
         for (j = 0; j < nsat; j++) {
             azel[0] = azs[i + m * j] * D2R;
             azel[1] = els[i + m * j] * D2R;
-            tropcorr(time, &nav, llh, azel, tropopt, &trps[i + m * j],
+            tropcorr(time, navp, llh, azel, tropopt, &trps[i + m * j],
                      &vars[i + m * j]);
         }
     }
+    freenavp(navp, &nav);
 }
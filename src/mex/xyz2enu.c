@@ -3,7 +3,7 @@
  * @brief Transform ECEF coordinate to local tangential coordinate
  * @author Taro Suzuki
  * @note Output transformation matrix
- * @note Support vector inputs
+ * @note Support vector inputs (batch transformation in coord.c)
  */
 
 #include "mex_utility.h"
@@ -14,8 +14,8 @@
 extern void mexFunction(int nargout, mxArray *argout[], int nargin,
                         const mxArray *argin[]) {
     const mwSize dims[3] = {3, 3, 0};
-    int i, m;
-    double x[3], e[3], o[3], Et[9], oxyz[3], *orgllh, *xyz, *enu, *E;
+    int m;
+    double o[3], Et[9], oxyz[3], *orgllh, *xyz, *enu, *E;
 
     /* check arguments */
     mxCheckNumberOfArguments(nargin, NIN);
@@ -41,17 +41,6 @@ extern void mexFunction(int nargout, mxArray *argout[], int nargin,
     xyz2enu(o, Et);
     transpose_mw(Et, dims, E); /* transpose, ecef -> enu */
 
-    /* call RTKLIB function */
-    for (i = 0; i < m; i++) {
-        x[0] = xyz[i + m * 0];
-        x[1] = xyz[i + m * 1];
-        x[2] = xyz[i + m * 2];
-        x[0] -= oxyz[0];
-        x[1] -= oxyz[1];
-        x[2] -= oxyz[2];
-        ecef2enu(o, x, e);
-        enu[i + m * 0] = e[0];
-        enu[i + m * 1] = e[1];
-        enu[i + m * 2] = e[2];
-    }
+    /* call RTKLIB function (batch) */
+    ecef2enuv(Et, oxyz, xyz, m, enu);
 }